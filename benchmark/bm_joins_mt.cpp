@@ -2,11 +2,27 @@
 // Benjamin Wagner 2018
 //
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstdio>
 #include <iostream>
+#include <limits>
+#include <thread>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 #include "benchmark/benchmark.h"
 #include "algorithms/nop_join_mt.h"
 #include "algorithms/mt_radix/radix_join_mt.h"
+#include "algorithms/band_join_mt.h"
+#include "algorithms/symmetric_join.h"
+#include "algorithms/hash_index.h"
+#include "algorithms/join_optimizer.h"
+#include "algorithms/page_allocator.h"
+#include "algorithms/relation_file.h"
+#include "algorithms/async_reader.h"
+#include "algorithms/spill_file.h"
 #include "generators/uniform_generator.h"
 #include "generators/incremental_generator.h"
 #include "generators/zipf_generator.h"
@@ -16,6 +32,43 @@
 
 namespace {
 
+    /// Counts data TLB misses of the calling thread and of all threads it creates afterwards
+    class tlb_counter {
+    public:
+        tlb_counter() {
+            perf_event_attr attr{};
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            attr.inherit = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+
+        ~tlb_counter() {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+
+        /// False if the kernel or the hardware does not provide the counter
+        bool available() const { return fd >= 0; }
+
+        /// Misses counted so far, including the ones of inheriting threads
+        uint64_t read() const {
+            uint64_t value = 0;
+            if (fd < 0 || ::read(fd, &value, sizeof(value)) != sizeof(value)) {
+                return 0;
+            }
+            return value;
+        }
+
+    private:
+        int fd;
+    };
+
     /**
      * Benchmark the NOP join, the input arguments are the following:
      * First:  Size of left Join Side
@@ -70,6 +123,74 @@ namespace {
         state.SetItemsProcessed((data_size_r + data_size_l) * state.iterations());
     }
 
+    /**
+     * Benchmark the morsel driven NOP join on a private executor, while background threads burn CPU time.
+     * Run with repetitions, the max statistic shows the tail latency. The input arguments are the following:
+     * First:  Size of left Join Side
+     * Second: Size of right Join Side
+     * Third:  Number of Threads
+     * Fourth: Morsel size, 0 for one static range per thread
+     * Fifth:  Zipf offset (alpha=offset*0.25), 0 for uniform
+     * Sixth:  Number of spinning background threads
+     */
+    void BenchmarkNOPMorsel(benchmark::State &state) {
+        // Get dataset size
+        auto data_size_l = static_cast<uint64_t >(state.range(0));
+        auto data_size_r = static_cast<uint64_t >(state.range(1));
+        // Get thread count and morsel size
+        auto threads = static_cast<uint8_t>(state.range(2));
+        auto morsel = static_cast<uint64_t>(state.range(3));
+
+        std::vector<std::tuple<uint64_t, uint64_t>> build;
+        std::vector<std::tuple<uint64_t, uint64_t>> probe;
+        // After this block we can forget the generators again
+        {
+            generators::incremental_generator gen0(1, data_size_l);
+            gen0.build();
+            build = gen0.get_vec_copy();
+            if (state.range(4) == 0) {
+                generators::uniform_generator gen1(1, data_size_l, data_size_r, SEED);
+                gen1.build();
+                probe = gen1.get_vec_copy();
+            } else {
+                generators::zipf_generator gen1(10000, state.range(4) * 0.25, data_size_r, SEED);
+                gen1.build();
+                probe = gen1.get_vec_copy();
+            }
+        }
+        // Background noise competing with the workers for the cores
+        std::atomic<bool> stop(false);
+        std::vector<std::thread> noise;
+        for (int64_t k = 0; k < state.range(5); ++k) {
+            noise.emplace_back([&stop]{
+                volatile uint64_t sink = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    sink = sink + 1;
+                }
+            });
+        }
+        helpers::executor exec(threads);
+
+        for (auto _ : state) {
+            state.PauseTiming();
+            // Create copies of the generated arrays for the current task
+            std::vector<std::tuple<uint64_t, uint64_t>> build_temp = build;
+            std::vector<std::tuple<uint64_t, uint64_t>> probe_temp = probe;
+            algorithms::nop_join_mt join(build_temp.data(), probe_temp.data(), data_size_l, data_size_r, 1.0,
+                                         threads, helpers::join_type::inner, morsel);
+            join.set_executor(exec);
+            state.ResumeTiming();
+            // Execute the actual join
+            join.execute();
+        }
+
+        stop = true;
+        for (auto& t : noise) {
+            t.join();
+        }
+        state.SetItemsProcessed((data_size_r + data_size_l) * state.iterations());
+    }
+
     /**
      * Benchmark the Radix join, the input arguments are the following:
      * First:  Size of left Join Side
@@ -129,6 +250,387 @@ namespace {
         state.SetItemsProcessed((data_size_r + data_size_l) * state.iterations());
     }
 
+    /**
+     * Benchmark the skew handling of the Radix join on Zipf inputs, the input arguments are the following:
+     * First:  Size of left Join Side
+     * Second: Size of right Join Side
+     * Third:  Number of Threads
+     * Fourth: Number of Radix Passes
+     * Fifth:  Number of Radix Bits per pass
+     * Sixth:  Zipf offset (alpha=offset*0.25)
+     * Seventh: 1 if oversized partitions get split, 0 otherwise
+     */
+    void BenchmarkRPJSkew(benchmark::State &state) {
+        // Get dataset size
+        auto data_size_l = static_cast<uint64_t >(state.range(0));
+        auto data_size_r = static_cast<uint64_t >(state.range(1));
+        // Get thread count
+        auto threads = static_cast<uint8_t>(state.range(2));
+        // Get Radix Partition info
+        auto runs = static_cast<uint8_t>(state.range(3));
+        auto bits = static_cast<uint8_t>(state.range(4));
+
+        std::vector<std::tuple<uint64_t, uint64_t>> build;
+        std::vector<std::tuple<uint64_t, uint64_t>> probe;
+        // After this block we can forget the generators again
+        {
+            generators::incremental_generator gen0(1, data_size_l);
+            gen0.build();
+            build = gen0.get_vec_copy();
+            generators::zipf_generator gen1(10000, state.range(5) * 0.25, data_size_r, SEED);
+            gen1.build();
+            probe = gen1.get_vec_copy();
+        }
+        helpers::executor exec(threads);
+
+        for (auto _ : state) {
+            state.PauseTiming();
+            // Create copies of the generated arrays for the current task
+            std::vector<std::tuple<uint64_t, uint64_t>> build_temp = build;
+            std::vector<std::tuple<uint64_t, uint64_t>> probe_temp = probe;
+            algorithms::radix_join_mt join(build_temp.data(), probe_temp.data(), data_size_l, data_size_r, 1.0,
+                                           threads, bits, runs);
+            join.set_executor(exec);
+            join.set_skew_threshold(state.range(6) ? 0 : std::numeric_limits<uint64_t>::max());
+            state.ResumeTiming();
+            // Execute the actual join
+            join.execute();
+        }
+
+        state.SetItemsProcessed((data_size_r + data_size_l) * state.iterations());
+    }
+
+    /**
+     * Benchmark the Band join, the input arguments are the following:
+     * First:  Size of left Join Side
+     * Second: Size of right Join Side
+     * Third:  Number of Threads
+     * Fourth: Band width
+     * Fifth:  Number of range partitions
+     */
+    void BenchmarkBand(benchmark::State &state) {
+        // Get dataset size
+        auto data_size_l = static_cast<uint64_t >(state.range(0));
+        auto data_size_r = static_cast<uint64_t >(state.range(1));
+        // Get thread count
+        auto threads = static_cast<uint8_t>(state.range(2));
+        auto band = static_cast<uint64_t>(state.range(3));
+        auto partitions = static_cast<uint32_t>(state.range(4));
+
+        std::vector<std::tuple<uint64_t, uint64_t>> build;
+        std::vector<std::tuple<uint64_t, uint64_t>> probe;
+        // After this block we can forget the generators again
+        {
+            generators::incremental_generator gen0(1, data_size_l);
+            gen0.build();
+            build = gen0.get_vec_copy();
+            generators::uniform_generator gen1(1, data_size_l, data_size_r, SEED);
+            gen1.build();
+            probe = gen1.get_vec_copy();
+        }
+
+        for (auto _ : state) {
+            state.PauseTiming();
+            // Create Band Join, the inputs are never modified
+            algorithms::band_join_mt join(build.data(), probe.data(), data_size_l, data_size_r, band, threads,
+                                          partitions);
+            state.ResumeTiming();
+            // Execute the actual join
+            join.execute();
+        }
+
+        state.SetItemsProcessed((data_size_r + data_size_l) * state.iterations());
+    }
+
+    /**
+     * Benchmark the join optimizer, which picks the algorithm and its parameters itself. The chosen
+     * configuration is attached as label. The input arguments are the following:
+     * First:  Size of left Join Side
+     * Second: Size of right Join Side
+     * Third:  Number of Threads
+     * Fourth: Zipf offset (alpha=offset*0.25), 0 for uniform
+     */
+    void BenchmarkOptimizer(benchmark::State &state) {
+        // Get dataset size
+        auto data_size_l = static_cast<uint64_t >(state.range(0));
+        auto data_size_r = static_cast<uint64_t >(state.range(1));
+        // Get thread count
+        auto threads = static_cast<uint8_t>(state.range(2));
+
+        std::vector<std::tuple<uint64_t, uint64_t>> build;
+        std::vector<std::tuple<uint64_t, uint64_t>> probe;
+        // After this block we can forget the generators again
+        {
+            generators::incremental_generator gen0(1, data_size_l);
+            gen0.build();
+            build = gen0.get_vec_copy();
+            if (state.range(3) == 0) {
+                generators::uniform_generator gen1(1, data_size_l, data_size_r, SEED);
+                gen1.build();
+                probe = gen1.get_vec_copy();
+            } else {
+                generators::zipf_generator gen1(10000, state.range(3) * 0.25, data_size_r, SEED);
+                gen1.build();
+                probe = gen1.get_vec_copy();
+            }
+        }
+
+        for (auto _ : state) {
+            state.PauseTiming();
+            // Create copies of the generated arrays for the current task
+            std::vector<std::tuple<uint64_t, uint64_t>> build_temp = build;
+            std::vector<std::tuple<uint64_t, uint64_t>> probe_temp = probe;
+            algorithms::join_optimizer join(build_temp.data(), probe_temp.data(), data_size_l, data_size_r,
+                                            threads, helpers::join_type::inner);
+            state.ResumeTiming();
+            // Sampling is part of the measured time
+            join.execute();
+            state.PauseTiming();
+            state.SetLabel(join.report());
+            state.ResumeTiming();
+        }
+
+        state.SetItemsProcessed((data_size_r + data_size_l) * state.iterations());
+    }
+
+    /**
+     * Benchmark the page size of hash tables and scatter buffers. Data TLB load misses are reported
+     * as counter if the machine exposes them. The input arguments are the following:
+     * First:  Size of left Join Side
+     * Second: Size of right Join Side
+     * Third:  Number of Threads
+     * Fourth: 0 for the NOP Join, otherwise the Radix Bits of a single pass Radix join
+     * Fifth:  Page mode, 0 small, 1 transparent, 2 explicit huge pages
+     */
+    void BenchmarkPages(benchmark::State &state) {
+        // Get dataset size
+        auto data_size_l = static_cast<uint64_t >(state.range(0));
+        auto data_size_r = static_cast<uint64_t >(state.range(1));
+        // Get thread count
+        auto threads = static_cast<uint8_t>(state.range(2));
+        auto bits = static_cast<uint8_t>(state.range(3));
+        helpers::page_mode modes[] = {helpers::page_mode::small, helpers::page_mode::transparent,
+                                      helpers::page_mode::huge};
+        helpers::page_mode mode = modes[state.range(4)];
+
+        std::vector<std::tuple<uint64_t, uint64_t>> build;
+        std::vector<std::tuple<uint64_t, uint64_t>> probe;
+        // After this block we can forget the generators again
+        {
+            generators::incremental_generator gen0(1, data_size_l);
+            gen0.build();
+            build = gen0.get_vec_copy();
+            generators::uniform_generator gen1(1, data_size_l, data_size_r, SEED);
+            gen1.build();
+            probe = gen1.get_vec_copy();
+        }
+
+        helpers::page_mode previous = helpers::default_pages();
+        helpers::set_default_pages(mode);
+        // The counter has to be opened before the workers get started to follow them
+        tlb_counter counter;
+        helpers::executor exec(threads);
+        uint64_t misses = 0;
+        for (auto _ : state) {
+            uint64_t before = counter.read();
+            // A single radix pass and the NOP join leave their inputs untouched, no copies needed
+            if (bits == 0) {
+                algorithms::nop_join_mt join(build.data(), probe.data(), data_size_l, data_size_r, 1.5, threads);
+                join.set_executor(exec);
+                join.execute();
+            } else {
+                algorithms::radix_join_mt join(build.data(), probe.data(), data_size_l, data_size_r, 1.5,
+                                               threads, bits, 1);
+                join.set_executor(exec);
+                join.execute();
+            }
+            misses += counter.read() - before;
+        }
+        helpers::set_default_pages(previous);
+
+        state.SetLabel(helpers::page_name(mode) + (counter.available() ? "" : ", no TLB counter"));
+        state.counters["dtlb_misses"] = benchmark::Counter(static_cast<double>(misses),
+                                                           benchmark::Counter::kAvgIterations);
+        state.SetItemsProcessed((data_size_r + data_size_l) * state.iterations());
+    }
+
+    /**
+     * Benchmark joining relations stored in relation files. The files are written to TMPDIR once, the
+     * sequential variant reads them completely before joining, the pipelined one lets the radix join
+     * overlap the reads with its first pass. The input arguments are the following:
+     * First:  Size of left Join Side
+     * Second: Size of right Join Side
+     * Third:  Number of Threads
+     * Fourth: Number of Radix Bits per pass of the two pass Radix join
+     * Fifth:  0 for sequential load and join, 1 for the pipelined join
+     */
+    void BenchmarkFileInput(benchmark::State &state) {
+        // Get dataset size
+        auto data_size_l = static_cast<uint64_t >(state.range(0));
+        auto data_size_r = static_cast<uint64_t >(state.range(1));
+        // Get thread count
+        auto threads = static_cast<uint8_t>(state.range(2));
+        auto bits = static_cast<uint8_t>(state.range(3));
+        bool pipelined = state.range(4) != 0;
+
+        std::string prefix = helpers::default_spill_directory() + "/hashjoins_bm_" + std::to_string(getpid());
+        std::string path_l = prefix + "_left";
+        std::string path_r = prefix + "_right";
+        // After this block we can forget the generators again
+        {
+            generators::incremental_generator gen0(1, data_size_l);
+            gen0.build();
+            gen0.write(path_l);
+            generators::uniform_generator gen1(1, data_size_l, data_size_r, SEED);
+            gen1.build();
+            gen1.write(path_r);
+        }
+
+        for (auto _ : state) {
+            if (pipelined) {
+                algorithms::radix_join_mt join(path_l, path_r, 1.5, threads, bits, 2, helpers::join_type::inner);
+                join.execute();
+            } else {
+                // Same reads and buffers as the pipelined join, but the join only starts once they are done
+                helpers::page_buffer build(data_size_l * sizeof(std::tuple<uint64_t, uint64_t>));
+                helpers::page_buffer probe(data_size_r * sizeof(std::tuple<uint64_t, uint64_t>));
+                {
+                    helpers::async_reader read_l(path_l, helpers::read_relation_header(path_l).offset, build.size(),
+                                                 build.data(), 1 << 22, 4);
+                    helpers::async_reader read_r(path_r, helpers::read_relation_header(path_r).offset, probe.size(),
+                                                 probe.data(), 1 << 22, 4);
+                    read_l.wait_all();
+                    read_r.wait_all();
+                }
+                algorithms::radix_join_mt join(build.as<std::tuple<uint64_t, uint64_t>>(),
+                                               probe.as<std::tuple<uint64_t, uint64_t>>(), data_size_l,
+                                               data_size_r, 1.5, threads, bits, 2);
+                join.execute();
+            }
+        }
+        std::remove(path_l.c_str());
+        std::remove(path_r.c_str());
+
+        state.SetLabel(pipelined ? "pipelined" : "sequential");
+        state.SetItemsProcessed((data_size_r + data_size_l) * state.iterations());
+    }
+
+    /**
+     * Benchmark the streaming symmetric join. Both relations arrive in alternating batches, the average
+     * and maximum time until a batch's matches were emitted are reported as counters. The input arguments
+     * are the following:
+     * First:  Size of left Join Side
+     * Second: Size of right Join Side
+     * Third:  Number of Threads
+     * Fourth: Tuples per batch
+     * Fifth:  Window in tuples per side, 0 for an unbounded join
+     */
+    void BenchmarkStream(benchmark::State &state) {
+        // Get dataset size
+        auto data_size_l = static_cast<uint64_t >(state.range(0));
+        auto data_size_r = static_cast<uint64_t >(state.range(1));
+        // Get thread count
+        auto threads = static_cast<uint8_t>(state.range(2));
+        auto batch = static_cast<uint64_t>(state.range(3));
+        auto window = static_cast<uint64_t>(state.range(4));
+
+        std::vector<std::tuple<uint64_t, uint64_t>> build;
+        std::vector<std::tuple<uint64_t, uint64_t>> probe;
+        // After this block we can forget the generators again
+        {
+            generators::incremental_generator gen0(1, data_size_l);
+            gen0.build();
+            build = gen0.get_vec_copy();
+            generators::uniform_generator gen1(1, data_size_l, data_size_r, SEED);
+            gen1.build();
+            probe = gen1.get_vec_copy();
+        }
+
+        helpers::executor exec(threads);
+        double total_latency = 0;
+        double max_latency = 0;
+        uint64_t batches = 0;
+        for (auto _ : state) {
+            algorithms::symmetric_join join(window, 4, 1.5, threads);
+            join.set_executor(exec);
+            std::vector<std::tuple<uint64_t, uint64_t, uint64_t>> out;
+            for (uint64_t start = 0; start < std::max(data_size_l, data_size_r); start += batch) {
+                for (int side = 0; side < 2; ++side) {
+                    uint64_t size = side == 0 ? data_size_l : data_size_r;
+                    if (start >= size) {
+                        continue;
+                    }
+                    auto begin = std::chrono::steady_clock::now();
+                    if (side == 0) {
+                        join.push_left(build.data() + start, std::min(batch, size - start), out);
+                    } else {
+                        join.push_right(probe.data() + start, std::min(batch, size - start), out);
+                    }
+                    std::chrono::duration<double, std::micro> took = std::chrono::steady_clock::now() - begin;
+                    total_latency += took.count();
+                    max_latency = std::max(max_latency, took.count());
+                    ++batches;
+                    // Results are handed downstream after every batch
+                    out.clear();
+                }
+            }
+        }
+
+        state.counters["batch_latency_us"] = benchmark::Counter(batches > 0 ? total_latency / batches : 0);
+        state.counters["max_latency_us"] = benchmark::Counter(max_latency);
+        state.SetItemsProcessed((data_size_r + data_size_l) * state.iterations());
+    }
+
+    /**
+     * Benchmark repeated probes of one dimension table. Either a hash index is built once and probed by
+     * every batch, or the table gets rebuilt for every batch like a join does. The input arguments are
+     * the following:
+     * First:  Size of the dimension table
+     * Second: Size of every probe batch
+     * Third:  Number of Threads
+     * Fourth: Number of probe batches
+     * Fifth:  Whether the index is reused (1) or rebuilt per batch (0)
+     */
+    void BenchmarkIndex(benchmark::State &state) {
+        // Get dataset size
+        auto data_size_l = static_cast<uint64_t >(state.range(0));
+        auto data_size_r = static_cast<uint64_t >(state.range(1));
+        // Get thread count
+        auto threads = static_cast<uint8_t>(state.range(2));
+        auto batches = static_cast<uint64_t>(state.range(3));
+        bool reuse = state.range(4) != 0;
+
+        std::vector<std::tuple<uint64_t, uint64_t>> build;
+        std::vector<std::tuple<uint64_t, uint64_t>> probe;
+        // After this block we can forget the generators again
+        {
+            generators::incremental_generator gen0(1, data_size_l);
+            gen0.build();
+            build = gen0.get_vec_copy();
+            generators::uniform_generator gen1(1, data_size_l, data_size_r, SEED);
+            gen1.build();
+            probe = gen1.get_vec_copy();
+        }
+
+        helpers::executor exec(threads);
+        algorithms::hash_index index(build.data(), data_size_l, 1.5, threads, exec);
+        for (auto _ : state) {
+            for (uint64_t k = 0; k < batches; ++k) {
+                std::vector<std::vector<std::tuple<uint64_t, uint64_t, uint64_t>>> out;
+                if (reuse) {
+                    index.probe(probe.data(), data_size_r, helpers::join_type::inner, threads, out);
+                } else {
+                    algorithms::hash_index fresh(build.data(), data_size_l, 1.5, threads, exec);
+                    fresh.probe(probe.data(), data_size_r, helpers::join_type::inner, threads, out);
+                }
+                benchmark::DoNotOptimize(out.data());
+            }
+        }
+
+        state.counters["index_bytes"] = benchmark::Counter(static_cast<double>(index.memory_bytes()));
+        state.SetLabel(reuse ? "reused" : "rebuilt");
+        state.SetItemsProcessed(data_size_r * batches * state.iterations());
+    }
 
     // Static member containing the threads the uniform benchmarks should be run on
     static std::vector<int64_t> threads{1, 2, 3, 4, 5, 7, 10, 12, 14, 15, 17, 20}; // NOLINT
@@ -227,6 +729,106 @@ namespace {
         }
     }
 
+    // Applying Thread, Zipf and Skew Handling Arguments onto Radix, scaling up to alpha 2.0
+    void RPJArgsSkew(benchmark::internal::Benchmark *b) {
+        int64_t same_size_count = static_cast<uint64_t>(1) << static_cast<uint64_t>(24);
+        for (int64_t k : {1, 2, 4, 8, 16, 20}) {
+            for (int64_t zipf = 4; zipf <= 8; zipf += 2) {
+                for (int64_t split = 0; split <= 1; ++split) {
+                    b->Args({same_size_count, same_size_count, k, 2, 6, zipf, split});
+                }
+            }
+        }
+    }
+
+    // Applying Morsel, Skew and Noise Arguments onto the morsel driven NOP Join
+    void NOPMorselArgs(benchmark::internal::Benchmark *b) {
+        int64_t left_count = static_cast<uint64_t>(1) << static_cast<uint64_t>(16);
+        int64_t right_count = static_cast<uint64_t>(1) << static_cast<uint64_t>(24);
+        int64_t k = 8;
+        for (int64_t morsel : {0, 1 << 12, 1 << 14, 1 << 16}) {
+            for (int64_t zipf : {0, 2, 4, 6}) {
+                for (int64_t noise : {0, 2}) {
+                    b->Args({left_count, right_count, k, morsel, zipf, noise});
+                }
+            }
+        }
+    }
+
+    // Largest of the repetitions, i.e. the tail latency
+    double RepetitionMax(const std::vector<double>& v) {
+        return *std::max_element(v.begin(), v.end());
+    }
+
+    // Applying Thread, Band and Partition Arguments onto the Band Join
+    void BandArgs(benchmark::internal::Benchmark *b) {
+        int64_t same_size_count = static_cast<uint64_t>(1) << static_cast<uint64_t>(22);
+        for (int64_t k: threads) {
+            for (int64_t band = 0; band <= 4; band += 2) {
+                b->Args({same_size_count, same_size_count, k, band, 4096});
+            }
+        }
+    }
+
+    // Applying Algorithm and Page Mode Arguments, sized like the large sweeps where the TLB matters
+    void PagesArgs(benchmark::internal::Benchmark *b) {
+        int64_t k = 20;
+        for (int64_t size_shift : {24, 25}) {
+            int64_t count = static_cast<int64_t>(1) << size_shift;
+            for (int64_t bits : {0, 10, 14}) {
+                for (int64_t mode = 0; mode <= 2; ++mode) {
+                    b->Args({count, count, k, bits, mode});
+                }
+            }
+        }
+    }
+
+    // Applying Size and Zipf Arguments onto the Optimizer, covering the sizes of the hand tuned sweeps
+    void OptimizerArgs(benchmark::internal::Benchmark *b) {
+        int64_t k = 20;
+        for (int64_t left_shift : {16, 20, 24}) {
+            int64_t left_count = static_cast<int64_t>(1) << left_shift;
+            int64_t right_count = static_cast<int64_t>(1) << 24;
+            for (int64_t zipf : {0, 4, 6}) {
+                b->Args({left_count, right_count, k, zipf});
+            }
+        }
+    }
+
+
+    // Applying Size and Pipelining Arguments, large enough for the reads to take a while
+    void FileInputArgs(benchmark::internal::Benchmark *b) {
+        int64_t k = 4;
+        for (int64_t size_shift : {24, 26}) {
+            int64_t count = static_cast<int64_t>(1) << size_shift;
+            for (int64_t pipelined : {0, 1}) {
+                b->Args({count, count, k, 7, pipelined});
+            }
+        }
+    }
+
+
+    // Applying Batch and Window Arguments, from latency oriented small batches to throughput oriented large ones
+    void StreamArgs(benchmark::internal::Benchmark *b) {
+        int64_t k = 4;
+        int64_t count = static_cast<int64_t>(1) << 22;
+        for (int64_t batch : {64, 4096, 65536}) {
+            for (int64_t window : {0, 1 << 20}) {
+                b->Args({count, count, k, batch, window});
+            }
+        }
+    }
+
+
+    // Applying Batch and Reuse Arguments, a dimension table probed by fact batches of a tenth of its size
+    void IndexArgs(benchmark::internal::Benchmark *b) {
+        int64_t k = 4;
+        int64_t count = static_cast<int64_t>(1) << 22;
+        for (int64_t reuse : {0, 1}) {
+            b->Args({count, count / 10, k, 16, reuse});
+        }
+    }
+
 } // namespace
 
 // Using real time since we are in a multithreaded setting
@@ -234,6 +836,15 @@ BENCHMARK(BenchmarkNOP)->Apply(NOPArgsUniform)->UseRealTime()->Unit(benchmark::k
 BENCHMARK(BenchmarkRPJ)->Apply(RPJArgsUniform)->UseRealTime()->Unit(benchmark::kMillisecond);
 BENCHMARK(BenchmarkNOP)->Apply(NOPArgsZipf)->UseRealTime()->Unit(benchmark::kMillisecond);
 BENCHMARK(BenchmarkRPJ)->Apply(RPJArgsZipf)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BenchmarkNOPMorsel)->Apply(NOPMorselArgs)->UseRealTime()->Unit(benchmark::kMillisecond)
+        ->Repetitions(10)->ComputeStatistics("max", RepetitionMax);
+BENCHMARK(BenchmarkRPJSkew)->Apply(RPJArgsSkew)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BenchmarkBand)->Apply(BandArgs)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BenchmarkOptimizer)->Apply(OptimizerArgs)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BenchmarkPages)->Apply(PagesArgs)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BenchmarkFileInput)->Apply(FileInputArgs)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BenchmarkStream)->Apply(StreamArgs)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BenchmarkIndex)->Apply(IndexArgs)->UseRealTime()->Unit(benchmark::kMillisecond);
 
 BENCHMARK_MAIN();
 
@@ -0,0 +1,59 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "benchmark/benchmark.h"
+#include "algorithms/radix_partitioner.h"
+#include "generators/uniform_generator.h"
+
+/// The fixed seed used for benchmarking purposes
+#define SEED 0
+
+namespace {
+
+    /**
+     * Benchmark the standalone radix partitioner, the input arguments are the following:
+     * First:  Size of the relation
+     * Second: Number of Threads
+     * Third:  Number of Radix Bits
+     */
+    void BenchmarkPartition(benchmark::State &state) {
+        auto data_size = static_cast<uint64_t>(state.range(0));
+        auto threads = static_cast<uint8_t>(state.range(1));
+        auto bits = static_cast<uint8_t>(state.range(2));
+
+        generators::uniform_generator gen(1, data_size, data_size, SEED);
+        gen.build();
+        auto data = gen.get_vec_copy();
+        // The target buffer is reused, the partitioner never modifies its input
+        std::vector<std::tuple<uint64_t, uint64_t>> target(data_size);
+
+        for (auto _ : state) {
+            algorithms::radix_partitioner part(data.data(), data_size, 0, bits, threads, target.data());
+            part.execute();
+            benchmark::DoNotOptimize(part.get());
+        }
+
+        state.SetItemsProcessed(data_size * state.iterations());
+        state.SetBytesProcessed(data_size * sizeof(std::tuple<uint64_t, uint64_t>) * state.iterations());
+    }
+
+    // The threads the partitioning benchmarks should be run on
+    static std::vector<int64_t> threads{1, 2, 4, 8, 10, 20}; // NOLINT
+
+    // Applying Thread, Size and Fan-out Arguments onto the partitioner
+    void PartitionArgs(benchmark::internal::Benchmark *b) {
+        int64_t count = static_cast<uint64_t>(1) << static_cast<uint64_t>(24);
+        for (int64_t k: threads) {
+            for (int64_t n = 2; n <= 14; n += 2) {
+                b->Args({count, k, n});
+            }
+        }
+    }
+
+} // namespace
+
+// Using real time since we are in a multithreaded setting
+BENCHMARK(BenchmarkPartition)->Apply(PartitionArgs)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,32 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "algorithms/calibration.h"
+
+/*
+ * Calibrates the radix join on this machine and writes the tuned parameters to the file given as first
+ * argument, defaulting to algorithms::calibration::default_path. Optional second argument: thread count.
+ */
+int main(int argc, char** argv) {
+    std::string path = argc > 1 ? argv[1] : algorithms::calibration::default_path;
+    auto threads = static_cast<uint8_t>(argc > 2 ? std::stoul(argv[2]) : std::thread::hardware_concurrency());
+    // Brackets from cache resident up to memory bound build sides
+    std::vector<uint64_t> brackets;
+    for(uint64_t shift = 12; shift <= 24; shift += 2){
+        brackets.push_back(static_cast<uint64_t>(1) << shift);
+    }
+    algorithms::calibration tuned = algorithms::calibration::measure(brackets, threads, 3);
+    std::cout << "max_build bits_per_pass passes table_size" << std::endl;
+    for(auto& entry: tuned.entries()){
+        std::cout << entry.max_build << " " << static_cast<uint32_t>(entry.bits_per_pass) << " "
+                  << static_cast<uint32_t>(entry.passes) << " " << entry.table_size << std::endl;
+    }
+    tuned.save(path);
+    std::cout << "Written to " << path << std::endl;
+    return 0;
+}
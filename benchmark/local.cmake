@@ -4,6 +4,7 @@
 
 set(BENCHMARK_CC
     "${CMAKE_SOURCE_DIR}/benchmark/bm_joins_mt.cpp"
+    "${CMAKE_SOURCE_DIR}/benchmark/bm_partition.cpp"
     )
 
 # ---------------------------------------------------------------------------
@@ -22,6 +23,28 @@ target_link_libraries(bm_joins
     )
 list(APPEND benchmark_targets bm_joins)
 
+add_executable(bm_partition
+    "${CMAKE_SOURCE_DIR}/benchmark/bm_partition.cpp"
+    )
+target_compile_options(bm_partition PUBLIC -Werror -O3)
+target_link_libraries(bm_partition
+    joins
+    benchmark
+    gtest
+    Threads::Threads
+    )
+list(APPEND benchmark_targets bm_partition)
+
+add_executable(calibrate
+    "${CMAKE_SOURCE_DIR}/benchmark/calibrate.cpp"
+    )
+target_compile_options(calibrate PUBLIC -Werror -O3)
+target_link_libraries(calibrate
+    joins
+    Threads::Threads
+    )
+list(APPEND benchmark_targets calibrate)
+
 add_custom_target(benchmarks)
 add_dependencies(benchmarks
     ${benchmark_targets})
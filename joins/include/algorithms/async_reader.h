@@ -0,0 +1,71 @@
+//
+// Benjamin Wagner 2018
+//
+
+#ifndef HASHJOINS_ASYNC_READER_H
+#define HASHJOINS_ASYNC_READER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace helpers {
+
+    /**
+     * Reads a byte range of a file into memory in the background. The range is split into chunks which
+     * are claimed by 'depth' I/O threads, so that many requests are in flight at once. Consumers block in
+     * wait() only until the part they need arrived. The I/O threads never run on the executor, blocking
+     * reads do not take workers away from the joins.
+     */
+    class async_reader {
+    public:
+        /**
+         * Starts reading right away
+         * @param path         file to read from
+         * @param offset       byte offset of the range within the file
+         * @param bytes        length of the range
+         * @param target       memory receiving the range, has to stay valid until the reader is destroyed
+         * @param chunk_bytes  bytes per read request
+         * @param depth        number of requests in flight
+         */
+        async_reader(const std::string& path, uint64_t offset, uint64_t bytes, void* target, uint64_t chunk_bytes,
+                     uint32_t depth);
+        /// Waits for the outstanding requests, errors are dropped
+        ~async_reader();
+        async_reader(const async_reader&) = delete;
+        async_reader& operator=(const async_reader&) = delete;
+
+        /// Blocks until the bytes [start, end) of the range arrived, throws std::runtime_error on read errors
+        void wait(uint64_t start, uint64_t end);
+        /// Blocks until the whole range arrived
+        void wait_all();
+
+    private:
+        /// Loop of a single I/O thread
+        void run();
+
+        int fd;
+        uint64_t offset;
+        uint64_t bytes;
+        char* target;
+        uint64_t chunk_bytes;
+        uint64_t chunks;
+        /// Next chunk to be claimed by an I/O thread
+        std::atomic<uint64_t> next;
+        /// Completion flags of the chunks and the prefix of completed chunks, guarded by the mutex
+        std::mutex lock;
+        std::condition_variable arrived;
+        std::vector<bool> done;
+        uint64_t prefix;
+        /// First error hit by any I/O thread, stops the others
+        std::string error;
+        std::vector<std::thread> workers;
+    };
+
+}  // namespace helpers
+
+#endif  // HASHJOINS_ASYNC_READER_H
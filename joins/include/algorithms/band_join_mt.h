@@ -0,0 +1,74 @@
+//
+// Benjamin Wagner 2018
+//
+
+#ifndef HASHJOINS_BAND_JOIN_MT_H
+#define HASHJOINS_BAND_JOIN_MT_H
+
+#include <memory>
+#include <vector>
+#include <tuple>
+#include "algorithms/executor.h"
+
+namespace algorithms {
+
+    /**
+     * Multi threaded band join, matches all pairs with |left_val - right_val| <= band.
+     * The left relation is range partitioned on splitters drawn from a sample of its keys,
+     * right tuples are replicated into every partition their band overlaps. Every partition
+     * is then joined by sorting its left side and scanning the band of each right tuple.
+     */
+    class band_join_mt {
+    public:
+        /// First element is the value on which should be joined, second one the rid
+        typedef std::tuple<uint64_t, uint64_t> tuple;
+        /// Join result, containing (left_val, rid_left, rid_right)
+        typedef std::tuple<uint64_t, uint64_t, uint64_t> triple;
+
+        /// Basic constructor
+        band_join_mt(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r, uint64_t band);
+        /// Join constructor with additional parameters
+        band_join_mt(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r, uint64_t band,
+                     uint8_t threads, uint32_t partitions);
+
+        /// Performs the actual join and writes result
+        void execute();
+
+        /// Returns a reference to the result vectors, one per range partition
+        std::vector<std::vector<triple>>& get();
+
+        /// Pass a result vector to the join, will be moved and may not be used further by the caller
+        void set(std::vector<std::vector<triple>>& res_vec);
+
+        /// Runs the parallel phases on the given executor instead of the process wide one
+        void set_executor(helpers::executor& exec);
+
+    private:
+        /// Left join partner
+        tuple* left;
+        /// Right join partner
+        tuple* right;
+        /// Size of the left array
+        uint64_t size_l;
+        /// Size of the right array
+        uint64_t size_r;
+        /// Maximum distance of two matching values
+        uint64_t band;
+        /// number of threads on which the algorithm should be run
+        uint8_t threads;
+        /// Number of range partitions being created
+        uint32_t partitions;
+        /// Boolean flag indicating whether build was already called
+        bool built;
+        /// Executor running the parallel phases, defaults to helpers::executor::global()
+        helpers::executor* exec;
+        /// Result vectors, one per range partition
+        std::vector<std::vector<triple>> result;
+
+        /// Draws the partitions - 1 splitters from an evenly spaced sample of the left keys
+        std::vector<uint64_t> splitters();
+    };
+
+}  // namespace algorithms
+
+#endif  // HASHJOINS_BAND_JOIN_MT_H
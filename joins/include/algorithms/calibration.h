@@ -0,0 +1,72 @@
+//
+// Benjamin Wagner 2018
+//
+
+#ifndef HASHJOINS_CALIBRATION_H
+#define HASHJOINS_CALIBRATION_H
+
+#include <string>
+#include <vector>
+#include <tuple>
+
+namespace algorithms {
+
+    /// Tuned radix join parameters for build sides up to a given size
+    struct calibration_entry {
+        /// Largest build side size this entry applies to
+        uint64_t max_build;
+        /// Radix bits per pass and number of passes which performed best
+        uint8_t bits_per_pass;
+        uint8_t passes;
+        /// table_size*|partition| is the size of the hash tables being built
+        double table_size;
+    };
+
+    /// Radix join parameters measured on the host machine, bracketed by build side size
+    class calibration {
+    public:
+        /// First element is the value on which should be joined, second one the rid
+        typedef std::tuple<uint64_t, uint64_t> tuple;
+
+        /// File read by host() if the environment variable below is not set
+        static constexpr const char* default_path = "hashjoins.calibration";
+        /// Environment variable overriding the calibration file location
+        static constexpr const char* path_variable = "HASHJOINS_CALIBRATION";
+
+        /// Empty calibration, lookups never find an entry
+        calibration() = default;
+        /// Calibration from given entries, they get sorted by bracket
+        explicit calibration(std::vector<calibration_entry> entries);
+
+        /**
+         * Times radix joins on synthetic inputs for every bracket. All fanouts up to an average partition
+         * size of 64 tuples with one and two passes are tried, then the table size at the fastest fanout.
+         * @param brackets     build side sizes to calibrate, the probe side has the same size
+         * @param threads      number of threads the joins run on
+         * @param repetitions  runs per configuration, the fastest one counts
+         */
+        static calibration measure(const std::vector<uint64_t>& brackets, uint8_t threads, uint32_t repetitions);
+
+        /// Reads a calibration file, a missing file yields an empty calibration, malformed ones throw
+        static calibration load(const std::string& path);
+
+        /// Writes the calibration file, throws if the file cannot be written
+        void save(const std::string& path) const;
+
+        /// Calibration of the host, loaded once from $HASHJOINS_CALIBRATION or default_path
+        static const calibration& host();
+
+        /// Entry of the smallest bracket covering 'size_l', the largest one beyond, nullptr if empty
+        const calibration_entry* lookup(uint64_t size_l) const;
+
+        /// All entries ordered by bracket
+        const std::vector<calibration_entry>& entries() const;
+
+    private:
+        /// Entries ordered by max_build
+        std::vector<calibration_entry> brackets;
+    };
+
+}  // namespace algorithms
+
+#endif  // HASHJOINS_CALIBRATION_H
@@ -0,0 +1,74 @@
+//
+// Benjamin Wagner 2018
+//
+
+#ifndef HASHJOINS_COMPOSITE_JOIN_MT_H
+#define HASHJOINS_COMPOSITE_JOIN_MT_H
+
+#include <memory>
+#include <vector>
+#include <tuple>
+#include "algorithms/executor.h"
+
+namespace algorithms {
+
+    /**
+     * Multi threaded join on composite keys spanning several columns.
+     * Both relations are given column major, one array per key column, and the rid of a tuple
+     * is its row index. Every row is reduced to a (combined hash, row) tuple which is joined by either
+     * the radix or the no partitioning join. The 64 bit hash acts as fingerprint, only rows with
+     * equal fingerprints get their full keys compared.
+     */
+    class composite_join_mt {
+    public:
+        /// Join result, containing (row_left, row_right)
+        typedef std::tuple<uint64_t, uint64_t> pair;
+
+        /// Basic constructor, uses the no partitioning join
+        composite_join_mt(std::vector<const uint64_t*> left, std::vector<const uint64_t*> right,
+                          uint64_t size_l, uint64_t size_r);
+        /// Join constructor with additional parameters, zero passes select the no partitioning join
+        composite_join_mt(std::vector<const uint64_t*> left, std::vector<const uint64_t*> right,
+                          uint64_t size_l, uint64_t size_r, double table_size, uint8_t threads,
+                          uint8_t bits_per_pass, uint8_t passes);
+
+        /// Performs the actual join and writes result
+        void execute();
+
+        /// Returns a reference to the result vectors
+        std::vector<std::vector<pair>>& get();
+
+        /// Pass a result vector to the join, will be moved and may not be used further by the caller
+        void set(std::vector<std::vector<pair>>& res_vec);
+
+        /// Runs the parallel phases on the given executor instead of the process wide one
+        void set_executor(helpers::executor& exec);
+
+    private:
+        /// Key columns of the left join partner
+        std::vector<const uint64_t*> left;
+        /// Key columns of the right join partner
+        std::vector<const uint64_t*> right;
+        /// Size of the left relation
+        uint64_t size_l;
+        /// Size of the right relation
+        uint64_t size_r;
+        /// table_size*|left| is the size of the hash table being built
+        double table_size;
+        /// number of threads on which the algorithm should be run
+        uint8_t threads;
+        /// Number of radix bits on which data should be partitioned every pass
+        uint8_t bits_per_pass;
+        /// Number of partitioning passes that should be performed, 0 for the no partitioning join
+        uint8_t passes;
+        /// Boolean flag indicating whether build was already called
+        bool built;
+        /// Executor running the parallel phases, defaults to helpers::executor::global()
+        helpers::executor* exec;
+        /// Result vectors, one per thread
+        std::vector<std::vector<pair>> result;
+    };
+
+}  // namespace algorithms
+
+#endif  // HASHJOINS_COMPOSITE_JOIN_MT_H
@@ -0,0 +1,166 @@
+//
+// Benjamin Wagner 2018
+//
+
+#ifndef HASHJOINS_DYNAMIC_HASH_TABLE_H
+#define HASHJOINS_DYNAMIC_HASH_TABLE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+#include "algorithms/hash_helpers.h"
+
+namespace algorithms {
+
+    /**
+     * Growable hash table taking inserts and deletes between or during probe batches. Tuples live in a
+     * linear probing table, deletes shift the following tuples back instead of leaving tombstones.
+     *
+     * Growing never stops the world: the table of twice the size is allocated before the update which
+     * fills the current one to half, once it is opened new tuples go there and every update moves a few
+     * slots of the old table over. Until all slots are
+     * moved, probes visit both tables and skip the slots of the old one which were moved already; deletes
+     * of tuples still in the old table only mark them, the old table is dropped as a whole afterwards.
+     *
+     * Updates are serialized by a mutex, probes run concurrently with them and with each other. Every
+     * update bumps a sequence number, probes read optimistically and repeat a key if an update ran in
+     * between. Probes register with an epoch, which moves on whenever an old table is dropped; the table
+     * is freed once the probes of its epoch have left, as later ones cannot reach it anymore.
+     */
+    class dynamic_hash_table {
+    public:
+        /// First element is the value on which should be joined, second one the rid
+        typedef std::tuple<uint64_t, uint64_t> tuple;
+        /// Join result, containing (join_val, rid_table, rid_probe)
+        typedef std::tuple<uint64_t, uint64_t, uint64_t> triple;
+
+        /// Empty table with the minimum capacity
+        dynamic_hash_table();
+        /// Empty table with room for at least 'capacity' tuples before it grows
+        explicit dynamic_hash_table(uint64_t capacity);
+        /// Table initially holding the given tuples
+        dynamic_hash_table(const tuple* data, uint64_t size);
+
+        /// Slots of the smallest table
+        static constexpr uint64_t min_slots = 64;
+        /// Slots of the old table moved over by every update while growing
+        static constexpr uint64_t migrate_step = 64;
+        /// Largest rid which can be stored, the ones above mark empty and deleted slots
+        static constexpr uint64_t max_rid = helpers::null_rid - 2;
+
+        /// Inserts a tuple, throws std::invalid_argument if its rid is larger than max_rid
+        void insert(const tuple& curr);
+        /// Inserts a batch, probes may see a part of it while it is running
+        void insert(const tuple* data, uint64_t count);
+        /// Deletes one tuple with the same key and rid, returns false if there was none
+        bool erase(const tuple& curr);
+        /// Deletes a batch, returns the number of tuples actually deleted
+        uint64_t erase(const tuple* data, uint64_t count);
+
+        /// Emits all partners of a probe tuple, returns true if there was one. May be called concurrently.
+        bool probe(const tuple& curr, std::vector<triple>& out) const;
+        /**
+         * Probes a batch, may be called concurrently with updates and other probes
+         * @param type  inner or right_outer, the latter emits probe tuples without partner. Joins preserving
+         *              the table side throw std::invalid_argument, like for algorithms::hash_index.
+         */
+        void probe(const tuple* data, uint64_t count, helpers::join_type type, std::vector<triple>& out) const;
+
+        /// Number of stored tuples
+        uint64_t size() const;
+        /// Slots of the table new tuples go to
+        uint64_t capacity() const;
+        /// Whether slots of an old table still have to be moved over
+        bool resizing() const;
+        /// Bytes of all tables held, including old ones which still wait for running probes
+        uint64_t memory_bytes() const;
+        /// Number of times probes repeated or delayed a key because an update was running
+        uint64_t probe_retries() const;
+
+    private:
+        /// A key and rid, each an atomic so probes can read them while they change
+        struct slot {
+            std::atomic<uint64_t> key;
+            std::atomic<uint64_t> rid;
+        };
+
+        /// Registers a probe with the current epoch for as long as it lives
+        class reader {
+        public:
+            explicit reader(const dynamic_hash_table& owner);
+            ~reader();
+
+        private:
+            /// Counter of running probes the probe was added to
+            std::atomic<uint64_t>* active;
+        };
+
+        /// Linear probing table with a power of two slots
+        struct table {
+            explicit table(uint64_t slots);
+
+            uint64_t mask;
+            std::unique_ptr<slot[]> slots;
+            /// Occupied slots, including deleted ones in an old table
+            uint64_t used;
+        };
+
+        /// Places a tuple in the first free slot after its home
+        static void place(table& target, uint64_t key, uint64_t rid);
+        /// Removes a tuple from the current table and shifts the following ones back
+        static bool remove(table& target, uint64_t key, uint64_t rid);
+        /// Emits the partners of a probe tuple, repeats the lookup if an update ran meanwhile
+        bool find(const tuple& curr, std::vector<triple>& out) const;
+        /// Emits the partners from one table, slots of the old table below 'moved' are skipped
+        static void lookup(const table& source, uint64_t moved, const tuple& curr, std::vector<triple>& out);
+
+        /// Moves the next slots of the old table over, drops it once all are moved
+        void migrate();
+        /// Allocates the table of twice the size if the next update fills the current one to half, frees the
+        /// last retired table first, so at most one of them is ever held
+        void reserve();
+        /// Opens the reserved table once the current one is half full
+        void grow();
+        /// Frees the retired tables once the probes of their epoch have left, waits for that if 'wait' is set
+        void reclaim(bool wait);
+
+        /// Starts an update, probes running now will repeat their key
+        void begin_update();
+        /// Ends an update
+        void end_update();
+
+        /// Serializes updates
+        mutable std::mutex update_lock;
+        /// Odd while an update is running, probes compare it before and after reading
+        std::atomic<uint64_t> sequence;
+        /// Bumped whenever a table gets retired
+        std::atomic<uint64_t> epoch;
+        /// Running probes per parity of the epoch they registered with
+        mutable std::atomic<uint64_t> active[2];
+        /// Table new tuples go to
+        std::unique_ptr<table> current;
+        /// Table being moved over, nullptr if the table does not grow right now
+        std::unique_ptr<table> previous;
+        /// Table allocated by reserve(), opened by the next grow()
+        std::unique_ptr<table> spare;
+        /// Tables which were moved completely but might still be read by a probe
+        std::vector<std::unique_ptr<table>> retired;
+        /// Epoch in which the retired tables were dropped
+        uint64_t retired_epoch;
+        /// The tables as seen by probes
+        std::atomic<table*> current_view;
+        std::atomic<table*> previous_view;
+        /// Slots of the old table which were moved over already
+        std::atomic<uint64_t> moved;
+        /// Number of stored tuples
+        std::atomic<uint64_t> stored;
+        /// Keys probes had to repeat or wait for
+        mutable std::atomic<uint64_t> retries;
+    };
+
+}  // namespace algorithms
+
+#endif  // HASHJOINS_DYNAMIC_HASH_TABLE_H
@@ -0,0 +1,161 @@
+//
+// Benjamin Wagner 2018
+//
+
+#ifndef HASHJOINS_EXECUTOR_H
+#define HASHJOINS_EXECUTOR_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "ThreadPool.h"
+#include "algorithms/numa.h"
+
+namespace helpers {
+
+    /**
+     * Persistent set of worker threads shared by all joins of the process.
+     * Joins get admitted with at most the degree of parallelism they ask for. Admission happens in
+     * arrival order, the first in line gets as many of the free workers as it asked for, but at least
+     * one. Concurrent queries thus run side by side without the admitted degrees ever exceeding the
+     * worker count, every join sizes its fan-out from what it was granted. Workers are spread over the NUMA nodes of the
+     * executor's topology and can optionally be pinned to their CPUs.
+     */
+    class executor {
+    public:
+        /// Admission of a single join, the reserved parallelism is handed back on destruction
+        class ticket {
+        public:
+            ticket(executor& exec, uint32_t parallelism);
+            ~ticket();
+            ticket(const ticket&) = delete;
+            ticket& operator=(const ticket&) = delete;
+
+            /// Degree of parallelism actually granted, at least 1 and at most the requested one and the number of
+            /// workers. Joins post no more tasks per phase than this.
+            uint32_t granted() const;
+
+        private:
+            executor& exec;
+            uint32_t reserved;
+        };
+
+        /**
+         * Set of tasks posted on behalf of one join. Tasks may post further tasks into the same group,
+         * wait() blocks until every one of them has finished. Must not be waited on from a worker.
+         */
+        class task_group {
+        public:
+            explicit task_group(executor& exec);
+            ~task_group();
+            task_group(const task_group&) = delete;
+            task_group& operator=(const task_group&) = delete;
+
+            /// Runs f(args...) on the executor, the task counts towards this group until it returns
+            template<class F, class... Args>
+            void post(F&& f, Args&&... args);
+            /// Like post(), but prefers the workers of the given NUMA node
+            template<class F, class... Args>
+            void post_on(uint32_t node, F&& f, Args&&... args);
+            /// Blocks until all posted tasks have finished
+            void wait();
+            /// The pool the tasks are running on
+            ThreadPool& pool();
+
+        private:
+            void finish_one();
+
+            executor& exec;
+            /// Round robin position among the workers of every node
+            std::vector<uint64_t> next_worker;
+            std::mutex lock;
+            std::condition_variable done;
+            uint64_t outstanding;
+        };
+
+        /// Creates a private executor, mostly useful for tests and isolated workloads
+        explicit executor(uint32_t workers);
+        /**
+         * Creates a private executor on an explicit, possibly simulated, topology
+         * @param workers   number of worker threads
+         * @param topology  NUMA nodes the workers are spread over
+         * @param pin       pins every worker to its CPU within the topology
+         */
+        executor(uint32_t workers, numa_topology topology, bool pin);
+        ~executor();
+        executor(const executor&) = delete;
+        executor& operator=(const executor&) = delete;
+
+        /// Process wide executor with one worker per hardware thread, created on first use.
+        /// Its workers get pinned if the environment variable HASHJOINS_PIN is set to a non zero value.
+        static executor& global();
+
+        /// Number of worker threads
+        uint32_t size() const;
+        /// The underlying work stealing pool
+        ThreadPool& pool();
+        /// NUMA nodes the workers are spread over
+        const numa_topology& topology() const;
+        /// True if the workers are pinned to their CPUs
+        bool pinned() const;
+        /// Indices of the workers placed on the given node
+        const std::vector<size_t>& workers_on(uint32_t node) const;
+
+    private:
+        /// Blocks until the caller is first in line and a worker is unreserved, returns the granted workers
+        uint32_t admit(uint32_t parallelism);
+        void leave(uint32_t parallelism);
+
+        uint32_t workers;
+        numa_topology nodes;
+        bool pin;
+        /// Workers of every node
+        std::vector<std::vector<size_t>> node_workers;
+        ThreadPool threads;
+        /// Admission state, tickets are served strictly in arrival order
+        std::mutex admission_lock;
+        std::condition_variable admission;
+        uint64_t next_ticket;
+        uint64_t serving;
+        uint32_t reserved;
+    };
+
+    template<class F, class... Args>
+    void executor::task_group::post(F&& f, Args&&... args) {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            ++outstanding;
+        }
+        exec.pool().post([this, f = std::forward<F>(f), args = std::make_tuple(std::forward<Args>(args)...)]()
+                mutable {
+            std::apply(f, args);
+            finish_one();
+        });
+    }
+
+    template<class F, class... Args>
+    void executor::task_group::post_on(uint32_t node, F&& f, Args&&... args) {
+        auto& candidates = exec.workers_on(node % exec.topology().nodes());
+        if(candidates.empty()){
+            post(std::forward<F>(f), std::forward<Args>(args)...);
+            return;
+        }
+        size_t worker;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            ++outstanding;
+            worker = candidates[next_worker[node % next_worker.size()]++ % candidates.size()];
+        }
+        exec.pool().post_to(worker, [this, f = std::forward<F>(f),
+                args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+            std::apply(f, args);
+            finish_one();
+        });
+    }
+
+}  // namespace helpers
+
+#endif  // HASHJOINS_EXECUTOR_H
@@ -0,0 +1,95 @@
+//
+// Benjamin Wagner 2018
+//
+
+#ifndef HASHJOINS_FINGERPRINT_JOIN_H
+#define HASHJOINS_FINGERPRINT_JOIN_H
+
+#include <atomic>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "algorithms/executor.h"
+#include "algorithms/hash_helpers.h"
+#include "algorithms/nop_join_mt.h"
+#include "algorithms/mt_radix/radix_join_mt.h"
+
+/**
+ * Building blocks for joins on keys which do not fit into the 64 bit key of the regular tuples.
+ * Every row is represented by a (fingerprint, row) tuple, so partitioning and hash tables work
+ * on the regular 16 byte tuples. Only rows with equal fingerprints are compared on their full keys.
+ */
+namespace algorithms {
+namespace fingerprint {
+
+    /// Join result, containing (row_left, row_right)
+    typedef std::tuple<uint64_t, uint64_t> pair;
+
+    /**
+     * Fills 'out' with the (fingerprint, row) tuples of all rows in parallel
+     * @param out      destination holding 'size' tuples
+     * @param size     number of rows
+     * @param threads  number of tasks to be used
+     * @param exec     executor running the tasks
+     * @param hash     functor returning the fingerprint of a row
+     */
+    template<class Hash>
+    void rows(helpers::tuple* out, uint64_t size, uint8_t threads, helpers::executor& exec, Hash hash) {
+        uint64_t range = size / threads;
+        helpers::executor::task_group tasks(exec);
+        for(uint8_t curr_t = 0; curr_t < threads; ++curr_t){
+            uint64_t end = (curr_t == threads - 1) ? size : (curr_t + 1) * range;
+            tasks.post([out, &hash](uint64_t start, uint64_t end){
+                for(uint64_t k = start; k < end; ++k){
+                    out[k] = helpers::tuple(hash(k), k);
+                }
+            }, curr_t * range, end);
+        }
+        tasks.wait();
+    }
+
+    /**
+     * Joins the fingerprint tuples and keeps the candidates whose full keys are equal
+     * @param passes   number of radix passes, zero selects the no partitioning join
+     * @param exec     executor running the fingerprint join and the verification tasks
+     * @param equal    functor comparing the full keys of (row_left, row_right)
+     * @param result   one output vector per thread, filled by the verification task of that thread
+     */
+    template<class Equal>
+    void join(helpers::tuple* left, helpers::tuple* right, uint64_t size_l, uint64_t size_r, double table_size,
+              uint8_t threads, uint8_t bits_per_pass, uint8_t passes, helpers::executor& exec, Equal equal,
+              std::vector<std::vector<pair>>& result) {
+        // Join on the fingerprints
+        std::vector<std::vector<radix_join_mt::triple>> candidates;
+        if(passes == 0){
+            nop_join_mt join(left, right, size_l, size_r, table_size, threads);
+            join.set_executor(exec);
+            join.execute();
+            candidates = std::move(join.get());
+        } else {
+            radix_join_mt join(left, right, size_l, size_r, table_size, threads, bits_per_pass, passes);
+            join.set_executor(exec);
+            join.execute();
+            candidates = std::move(join.get());
+        }
+        // Compare the full keys of all candidates, the join may produce more candidate vectors than threads
+        helpers::executor::task_group tasks(exec);
+        std::atomic<uint64_t> next(0);
+        for(uint8_t curr_t = 0; curr_t < threads; ++curr_t){
+            tasks.post([&equal, &candidates, &next](std::vector<pair>* out){
+                for(uint64_t c = next++; c < candidates.size(); c = next++){
+                    for(auto& t: candidates[c]){
+                        if(equal(std::get<1>(t), std::get<2>(t))){
+                            out->emplace_back(std::get<1>(t), std::get<2>(t));
+                        }
+                    }
+                }
+            }, &result[curr_t]);
+        }
+        tasks.wait();
+    }
+
+}  // namespace fingerprint
+}  // namespace algorithms
+
+#endif  // HASHJOINS_FINGERPRINT_JOIN_H
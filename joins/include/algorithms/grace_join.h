@@ -0,0 +1,141 @@
+//
+// Benjamin Wagner 2018
+//
+
+#ifndef HASHJOINS_GRACE_JOIN_H
+#define HASHJOINS_GRACE_JOIN_H
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "algorithms/hash_helpers.h"
+#include "algorithms/executor.h"
+#include "algorithms/spill_file.h"
+
+namespace algorithms {
+
+    /**
+     * Hybrid grace hash join for build sides exceeding the available memory. Both relations are streamed
+     * in chunks, which get radix partitioned. Partitions whose build side fits into the memory budget stay
+     * resident and get probed while the probe side streams by. The others are spilled to temporary files
+     * and joined afterwards, several at once as far as the budget allows. Whenever the budget is exceeded,
+     * the largest resident partition gets spilled.
+     */
+    class grace_join {
+    public:
+        /// First element is the value on which should be joined, second one the rid
+        typedef std::tuple<uint64_t, uint64_t> tuple;
+        /// Join result, containing (join_val, rid_left, rid_right)
+        typedef std::tuple<uint64_t, uint64_t, uint64_t> triple;
+
+        /// Basic constructor using 1 GiB of memory, 1 MiB I/O buffers and 4 threads
+        grace_join(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r);
+        /**
+         * Join constructor offering maximum flexibility
+         * @param table_size     table_size*|partition| is the size of every partition's hash table
+         * @param threads        number of threads partitioning and joining the streamed chunks
+         * @param memory_budget  bytes for chunks, I/O buffers and resident partitions, the result is not counted.
+         *                       Spill buffers of at least 64 KiB share half of it, which caps the number of
+         *                       partitions. Build sides too large for that fanout give partitions exceeding
+         *                       half of the budget, such a partition is joined alone once spilled.
+         * @param io_buffer      bytes collected per spill file before they get written out, at least 64 KiB
+         * @param type           inner or outer join semantics
+         */
+        grace_join(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r, double table_size,
+                   uint8_t threads, uint64_t memory_budget, uint64_t io_buffer, helpers::join_type type);
+
+        /// Performs the actual join and writes result
+        void execute();
+
+        /// Returns a reference to the result vectors, one per partition
+        std::vector<std::vector<triple>>& get();
+
+        /// Pass a result vector to the join, will be moved and may not be used further by the caller
+        void set(std::vector<std::vector<triple>>& res_vec);
+
+        /// Runs the parallel phases on the given executor instead of the process wide one
+        void set_executor(helpers::executor& exec);
+
+        /// Directory the spill files get created in, helpers::default_spill_directory() by default
+        void set_spill_directory(const std::string& directory);
+
+        /// Number of partitions created by the last execute()
+        uint64_t partitions() const;
+
+        /// Number of partitions the last execute() had to spill to disk
+        uint64_t spilled_partitions() const;
+
+    private:
+        /// State of a single partition
+        struct partition {
+            /// Build tuples of a resident partition, until its table gets built
+            std::vector<tuple> build;
+            /// Table of a resident partition, created once the build side was streamed
+            std::unique_ptr<helpers::latched_hash_table> table;
+            /// Spill file of a spilled partition, holding its build tuples followed by its probe tuples
+            std::unique_ptr<helpers::spill_file> file;
+            /// Number of build tuples at the start of the spill file
+            uint64_t spilled_build = 0;
+        };
+
+        /// Partitions a relation chunk by chunk, every partition of a chunk is handed to consume()
+        void stream(tuple* data, uint64_t size, bool build_side);
+        /// Handles the tuples of one partition of a chunk, partitions are never consumed concurrently
+        void consume(uint64_t part, const tuple* data, uint64_t count, bool build_side);
+        /// Spills resident partitions until the budget is met again
+        void evict();
+        /// Joins a spilled partition after both sides were written out
+        void join_spilled(uint64_t part);
+        /// Joins the pending spilled partitions on the granted workers, as many at once as their tables and
+        /// probe blocks fit into the available memory
+        void join_spilled(helpers::executor::task_group& tasks, const std::vector<uint64_t>& pending);
+        /// Bytes of memory a resident build tuple occupies including its share of the table
+        uint64_t tuple_bytes() const;
+
+        /// Left join partner
+        tuple* left;
+        /// Right join partner
+        tuple* right;
+        /// Size of the left array
+        uint64_t size_l;
+        /// Size of the right array
+        uint64_t size_r;
+        /// table_size*|partition| is the size of the hash tables being built
+        double table_size;
+        /// number of threads on which the algorithm should be run
+        uint8_t threads;
+        /// Upper bound of the memory in bytes
+        uint64_t memory_budget;
+        /// Requested bytes per spill buffer
+        uint64_t io_buffer;
+        /// Inner or outer join semantics
+        helpers::join_type type;
+        /// Boolean flag indicating whether build was already called
+        bool built;
+        /// Executor running the parallel phases, defaults to helpers::executor::global()
+        helpers::executor* exec;
+        /// Directory of the spill files
+        std::string directory;
+        /// Result vectors, one per partition
+        std::vector<std::vector<triple>> result;
+
+        /// Workers granted to the running execute(), at most 'threads'
+        uint8_t workers;
+        /// Partitioning derived from the budget by execute()
+        uint8_t bits;
+        uint64_t chunk;
+        /// Bytes per spill buffer actually used
+        uint64_t buffer_bytes;
+        /// Memory left for resident partitions and spill buffers
+        uint64_t available;
+        std::vector<partition> parts;
+        /// Build tuples held by resident partitions
+        std::atomic<uint64_t> resident;
+        uint64_t spilled;
+    };
+
+}  // namespace algorithms
+
+#endif  // HASHJOINS_GRACE_JOIN_H
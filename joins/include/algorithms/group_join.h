@@ -0,0 +1,65 @@
+//
+// Benjamin Wagner 2018
+//
+
+#ifndef HASHJOINS_GROUP_JOIN_H
+#define HASHJOINS_GROUP_JOIN_H
+
+#include <memory>
+#include <vector>
+#include <tuple>
+#include "algorithms/hash_helpers.h"
+
+namespace algorithms {
+
+    /**
+     * Single threaded group join, fuses the join with a subsequent GROUP BY on the join key.
+     * The aggregates over the right payloads are kept within the build side hash table and get
+     * updated in place by the probe tuples, no join triples are ever materialized.
+     * The result equals grouping the inner join result by the join value, keys without
+     * join partners do not show up in the output.
+     */
+    class group_join {
+    public:
+        /// First element is the value on which should be joined, second one the rid
+        typedef std::tuple<uint64_t, uint64_t> tuple;
+        /// Aggregated result, containing (join_val, count, sum, min, max) over the right rids
+        typedef helpers::group group;
+
+        /// Basic constructor
+        group_join(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r);
+        /// Join constructor with additional parameter
+        group_join(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r, double table_size);
+        /// Join constructor  offering maximum flexibility, 'result' is moved into the join object
+        group_join(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r, double table_size,
+                   std::vector<group>& result);
+
+        /// Performs the actual group join and writes result
+        void execute();
+
+        /// Returns a reference to the result vector
+        std::vector<group>& get();
+
+        /// Pass a result vector to the join, will be moved and may not be used further by the caller
+        void set(std::vector<group>& res_vec);
+
+    private:
+        /// Left join partner
+        tuple* left;
+        /// Right join partner
+        tuple* right;
+        /// Size of the left array
+        uint64_t size_l;
+        /// Size of the right array
+        uint64_t size_r;
+        /// table_size*|left| is the size of the hash table being built
+        double table_size;
+        /// Boolean flag indicating whether build was already called
+        bool built;
+        /// Result vector
+        std::vector<group> result;
+    };
+
+}  // namespace algorithms
+
+#endif  // HASHJOINS_GROUP_JOIN_H
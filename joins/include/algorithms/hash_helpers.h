@@ -5,9 +5,14 @@
 #ifndef HASHJOINS_HASH_HELPERS_H
 #define HASHJOINS_HASH_HELPERS_H
 
+#include <algorithm>
+#include <atomic>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <tuple>
+#include <vector>
+#include "algorithms/page_allocator.h"
 
 namespace helpers {
 
@@ -23,15 +28,135 @@ namespace helpers {
         return val;
     }
 
+    /// Combined hash over 'count' key columns of a column major relation, used for composite keys
+    inline uint64_t composite_hash(const uint64_t* const* columns, uint64_t count, uint64_t row) {
+        uint64_t hash = 0;
+        for(uint64_t c = 0; c < count; ++c){
+            hash ^= murmur3(columns[c][row]) + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+        }
+        return hash;
+    }
+
     /// First element is the value on which should be joined, second one the rid
     typedef std::tuple<uint64_t, uint64_t> tuple;
 
+    /// Partition of a hash within a radix pass looking at the bits [shift, shift + log2(mask + 1))
+    inline uint64_t radix(uint64_t hash, uint8_t shift, uint64_t mask) {
+        return (hash >> shift) & mask;
+    }
+
+    /**
+     * Partitioning kernel, histogram part. Adds the number of tuples falling into each partition onto hist.
+     * @param data    tuples to be partitioned
+     * @param count   number of tuples
+     * @param shift   lowest hash bit looked at
+     * @param bits    number of hash bits looked at, hist needs 2^bits entries
+     * @param hist    histogram being incremented
+     */
+    inline void radix_histogram(const tuple* data, uint64_t count, uint8_t shift, uint8_t bits, uint64_t* hist) {
+        uint64_t mask = (static_cast<uint64_t>(1) << bits) - 1;
+        for(uint64_t k = 0; k < count; ++k){
+            ++hist[radix(murmur3(std::get<0>(data[k])), shift, mask)];
+        }
+    }
+
+    /**
+     * Partitioning kernel, scatter part. Copies every tuple to the next free slot of its partition.
+     * @param data    tuples to be partitioned
+     * @param count   number of tuples
+     * @param shift   lowest hash bit looked at
+     * @param bits    number of hash bits looked at, offsets needs 2^bits entries
+     * @param offsets next write position per partition, gets advanced by the scatter
+     * @param target  destination array
+     */
+    inline void radix_scatter(const tuple* data, uint64_t count, uint8_t shift, uint8_t bits,
+                              uint64_t* offsets, tuple* target) {
+        uint64_t mask = (static_cast<uint64_t>(1) << bits) - 1;
+        for(uint64_t k = 0; k < count; ++k){
+            target[offsets[radix(murmur3(std::get<0>(data[k])), shift, mask)]++] = data[k];
+        }
+    }
+
+    /**
+     * Partitioning kernel, in place part. Moves every tuple into its partition by following swap cycles,
+     * partition p is the range [heads[p], ends[p]) derived from the histogram beforehand.
+     * @param data    tuples to be partitioned
+     * @param shift   lowest hash bit looked at
+     * @param bits    number of hash bits looked at, heads and ends need 2^bits entries
+     * @param heads   first position per partition not holding one of its tuples yet, gets advanced
+     * @param ends    end of every partition
+     */
+    inline void radix_permute(tuple* data, uint8_t shift, uint8_t bits, uint64_t* heads, const uint64_t* ends) {
+        uint64_t mask = (static_cast<uint64_t>(1) << bits) - 1;
+        for(uint64_t p = 0; p <= mask; ++p){
+            while(heads[p] < ends[p]){
+                tuple curr = data[heads[p]];
+                uint64_t target = radix(murmur3(std::get<0>(curr)), shift, mask);
+                // Follow the cycle, every swap puts one tuple into its final partition
+                while(target != p){
+                    std::swap(curr, data[heads[target]++]);
+                    target = radix(murmur3(std::get<0>(curr)), shift, mask);
+                }
+                data[heads[p]++] = curr;
+            }
+        }
+    }
+
+    /**
+     * Partitioning kernel, bounded in place part. Like radix_permute(), but a tuple whose partition has no
+     * free position left within [heads, ends) is put back where the cycle started. Workers running it on
+     * disjoint stripes of every partition leave a few misplaced tuples behind, which need to be repaired.
+     * @param data    tuples to be partitioned
+     * @param shift   lowest hash bit looked at
+     * @param bits    number of hash bits looked at, heads and ends need 2^bits entries
+     * @param heads   first position per partition stripe not visited yet, gets advanced
+     * @param ends    end of every partition stripe
+     */
+    inline void radix_permute_bounded(tuple* data, uint8_t shift, uint8_t bits, uint64_t* heads,
+                                      const uint64_t* ends) {
+        uint64_t mask = (static_cast<uint64_t>(1) << bits) - 1;
+        for(uint64_t p = 0; p <= mask; ++p){
+            while(heads[p] < ends[p]){
+                tuple curr = data[heads[p]];
+                uint64_t target = radix(murmur3(std::get<0>(curr)), shift, mask);
+                while(target != p && heads[target] < ends[target]){
+                    std::swap(curr, data[heads[target]++]);
+                    target = radix(murmur3(std::get<0>(curr)), shift, mask);
+                }
+                data[heads[p]++] = curr;
+            }
+        }
+    }
+
+    /// Rid written into the output triple for the missing join partner of an outer join
+    constexpr uint64_t null_rid = std::numeric_limits<uint64_t>::max();
+
+    /// Join semantics, the left relation is always the build side and the right one the probe side
+    enum class join_type {
+        inner,
+        left_outer,
+        right_outer,
+        full_outer
+    };
+
+    /// True if unmatched tuples of the left (build) relation have to be emitted
+    inline bool preserves_left(join_type type) {
+        return type == join_type::left_outer || type == join_type::full_outer;
+    }
+
+    /// True if unmatched tuples of the right (probe) relation have to be emitted
+    inline bool preserves_right(join_type type) {
+        return type == join_type::right_outer || type == join_type::full_outer;
+    }
+
     /// Overflow bucket used for chaining
     struct overflow {
         tuple t;
+        /// Set once a probe tuple found this build tuple, needed for outer joins
+        std::atomic<bool> matched;
         std::unique_ptr<overflow> next;
 
-        explicit overflow(tuple t): t(t){}
+        explicit overflow(tuple t): t(t), matched(false){}
     };
 
     /// Chained Hash Table used for ST No Partitioning Join, every bucket is protected with a latch
@@ -40,19 +165,126 @@ namespace helpers {
         struct bucket{
             std::mutex lock;
             uint32_t count;
+            /// Match flags of t1 (first bit) and t2 (second bit), set lock-free during the probe phase
+            std::atomic<uint8_t> matched;
             tuple t1;
             tuple t2;
             std::unique_ptr<overflow> next;
 
             /// Default constructor
-            bucket(): count(0), next(nullptr) {}
+            bucket(): count(0), matched(0), next(nullptr) {}
         };
 
-        std::unique_ptr<bucket[]> arr;
+        page_array<bucket> arr;
         uint64_t size;
 
-        explicit latched_hash_table(uint64_t size): size(size){
-                arr = std::make_unique<bucket[]>(size);
+        explicit latched_hash_table(uint64_t size): arr(size), size(size) {}
+
+        /// Join result, containing (join_val, rid_left, rid_right)
+        typedef std::tuple<uint64_t, uint64_t, uint64_t> triple;
+
+        /// Inserts a build tuple, may be called concurrently
+        void insert(const tuple& curr) {
+            insert_at(murmur3(std::get<0>(curr)) % size, curr);
+        }
+
+        /// Inserts a build tuple into the given bucket, for callers which already hashed the key
+        void insert_at(uint64_t index, const tuple& curr) {
+            bucket& b = arr[index];
+            // Critical Section
+            std::lock_guard<std::mutex> guard(b.lock);
+            // Follow overflow buckets
+            switch (b.count) {
+                case 0:
+                    b.t1 = curr;
+                    break;
+                case 1:
+                    b.t2 = curr;
+                    break;
+                case 2:
+                    b.next = std::make_unique<overflow>(curr);
+                    break;
+                default:
+                    overflow *ptr = b.next.get();
+                    // Follow pointer indirection
+                    for (uint64_t i = 0; i < static_cast<uint64_t>(b.count - 3); i++) {
+                        ptr = ptr->next.get();
+                    }
+                    // Create new bucket containing tuple
+                    ptr->next = std::make_unique<overflow>(curr);
+            }
+            ++b.count;
+        }
+
+        /**
+         * Emits all join partners of a probe tuple, may be called concurrently once the build is done
+         * @param curr  the probe tuple
+         * @param mark  set the match flags of the partners, needed if unmatched build tuples get emitted later
+         * @param out   output vector
+         * @return      true if at least one partner was found
+         */
+        bool probe(const tuple& curr, bool mark, std::vector<triple>& out) {
+            return probe_at(murmur3(std::get<0>(curr)) % size, curr, mark, out);
+        }
+
+        /// Probes the given bucket, for callers which already hashed the key
+        bool probe_at(uint64_t index, const tuple& curr, bool mark, std::vector<triple>& out) {
+            bucket& b = arr[index];
+            bool found = false;
+            // Follow overflow buckets
+            if(b.count > 2){
+                overflow* curr_over = b.next.get();
+                for(uint64_t i = 0; i < static_cast<uint64_t>(b.count - 2); ++i){
+                    if(std::get<0>(curr_over->t) == std::get<0>(curr)){
+                        out.emplace_back(std::get<0>(curr_over->t), std::get<1>(curr_over->t), std::get<1>(curr));
+                        found = true;
+                        // Only write the flag once to keep the cache line shared between probing threads
+                        if(mark && !curr_over->matched.load(std::memory_order_relaxed)){
+                            curr_over->matched.store(true, std::memory_order_relaxed);
+                        }
+                    }
+                    curr_over = curr_over->next.get();
+                }
+            }
+            // Look at second tuple
+            if(b.count > 1 && std::get<0>(b.t2) == std::get<0>(curr)){
+                out.emplace_back(std::get<0>(b.t2), std::get<1>(b.t2), std::get<1>(curr));
+                found = true;
+                if(mark && !(b.matched.load(std::memory_order_relaxed) & 2)){
+                    b.matched.fetch_or(2, std::memory_order_relaxed);
+                }
+            }
+            // Look at first tuple
+            if(b.count > 0 && std::get<0>(b.t1) == std::get<0>(curr)){
+                out.emplace_back(std::get<0>(b.t1), std::get<1>(b.t1), std::get<1>(curr));
+                found = true;
+                if(mark && !(b.matched.load(std::memory_order_relaxed) & 1)){
+                    b.matched.fetch_or(1, std::memory_order_relaxed);
+                }
+            }
+            return found;
+        }
+
+        /// Emits the build tuples of the buckets [start, end) which were never marked by a probe
+        void scan(uint64_t start, uint64_t end, std::vector<triple>& out) {
+            for(uint64_t k = start; k < end; ++k){
+                bucket& b = arr[k];
+                uint8_t matched = b.matched.load(std::memory_order_relaxed);
+                if(b.count > 0 && !(matched & 1)){
+                    out.emplace_back(std::get<0>(b.t1), std::get<1>(b.t1), null_rid);
+                }
+                if(b.count > 1 && !(matched & 2)){
+                    out.emplace_back(std::get<0>(b.t2), std::get<1>(b.t2), null_rid);
+                }
+                // Follow overflow buckets
+                overflow* curr_over = b.next.get();
+                while(curr_over != nullptr){
+                    if(!curr_over->matched.load(std::memory_order_relaxed)){
+                        out.emplace_back(std::get<0>(curr_over->t), std::get<1>(curr_over->t), null_rid);
+                    }
+                    curr_over = curr_over->next.get();
+                }
+            }
         }
     };
 
@@ -61,21 +293,113 @@ namespace helpers {
         /// One of the hash table entries
         struct bucket{
             uint32_t count;
+            /// Match flags of t1 (first bit) and t2 (second bit), only needed for outer joins
+            uint8_t matched;
             tuple t1;
             tuple t2;
             std::unique_ptr<overflow> next;
 
             /// Default constructor
-            bucket(): count(0), next(nullptr) {}
+            bucket(): count(0), matched(0), next(nullptr) {}
         };
 
-        std::unique_ptr<bucket[]> arr;
+        page_array<bucket> arr;
         uint64_t size;
 
-        explicit hash_table(uint64_t size): size(size){
-            arr = std::make_unique<bucket[]>(size);
+        explicit hash_table(uint64_t size): arr(size), size(size) {}
+
+    };
+    /// Aggregated output, containing (key, count, sum, min, max)
+    typedef std::tuple<uint64_t, uint64_t, uint64_t, uint64_t, uint64_t> group;
+
+    /// Group of the aggregate table, aggregates the payloads of all tuples sharing the key
+    struct aggregate {
+        uint64_t key;
+        /// Number of build tuples carrying the key, every folded payload is counted this many times
+        uint64_t multiplicity;
+        uint64_t count;
+        uint64_t sum;
+        uint64_t min;
+        uint64_t max;
+        std::unique_ptr<aggregate> next;
+
+        explicit aggregate(uint64_t key): key(key), multiplicity(0), count(0), sum(0),
+                                          min(std::numeric_limits<uint64_t>::max()), max(0), next(nullptr){}
+
+        /// Fold a single payload into the aggregates
+        void update(uint64_t payload){
+            count += multiplicity;
+            sum += multiplicity * payload;
+            min = std::min(min, payload);
+            max = std::max(max, payload);
         }
+    };
 
+    /// Chained hash table holding one aggregate per distinct key, used for group joins and aggregation
+    struct aggregate_table{
+        /// One of the hash table entries
+        struct bucket{
+            uint32_t count;
+            aggregate first;
+
+            /// Default constructor
+            bucket(): count(0), first(0) {}
+        };
+
+        page_array<bucket> arr;
+        uint64_t size;
+
+        explicit aggregate_table(uint64_t size): arr(size), size(size) {}
+
+        /// Returns the group of the given key or nullptr if there is none
+        aggregate* find(uint64_t key){
+            bucket& b = arr[murmur3(key) % size];
+            if(b.count == 0){
+                return nullptr;
+            }
+            aggregate* curr = &b.first;
+            while(curr != nullptr && curr->key != key){
+                curr = curr->next.get();
+            }
+            return curr;
+        }
+
+        /// Returns the group of the given key, creates an empty one if there is none
+        aggregate& insert(uint64_t key){
+            bucket& b = arr[murmur3(key) % size];
+            if(b.count == 0){
+                b.first.key = key;
+                ++b.count;
+                return b.first;
+            }
+            aggregate* curr = &b.first;
+            while(curr != nullptr && curr->key != key){
+                curr = curr->next.get();
+            }
+            if(curr != nullptr){
+                return *curr;
+            }
+            // Chain the new group directly behind the inline one
+            auto created = std::make_unique<aggregate>(key);
+            created->next = std::move(b.first.next);
+            b.first.next = std::move(created);
+            ++b.count;
+            return *b.first.next;
+        }
+
+        /// Appends all groups which aggregated at least one payload to the output
+        void collect(std::vector<group>& out){
+            for(uint64_t k = 0; k < size; ++k){
+                if(arr[k].count == 0){
+                    continue;
+                }
+                for(aggregate* curr = &arr[k].first; curr != nullptr; curr = curr->next.get()){
+                    if(curr->count > 0){
+                        out.emplace_back(curr->key, curr->count, curr->sum, curr->min, curr->max);
+                    }
+                }
+            }
+        }
     };
 
 }  // namespace helpers
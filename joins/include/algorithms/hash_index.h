@@ -0,0 +1,96 @@
+//
+// Benjamin Wagner 2018
+//
+
+#ifndef HASHJOINS_HASH_INDEX_H
+#define HASHJOINS_HASH_INDEX_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "algorithms/hash_helpers.h"
+#include "algorithms/executor.h"
+#include "algorithms/page_allocator.h"
+
+namespace algorithms {
+
+    /**
+     * Immutable hash index built once and probed by any number of batches and threads afterwards. The
+     * tuples are stored grouped by bucket in one contiguous array, an offset array points at the start of
+     * every bucket, so a probe reads a single range without following pointers. Multi threaded builds
+     * radix partition the tuples into ranges of buckets first, every range is then finished by one task.
+     * The index can be saved to disk and loaded again without rebuilding it.
+     */
+    class hash_index {
+    public:
+        /// First element is the value on which should be joined, second one the rid
+        typedef std::tuple<uint64_t, uint64_t> tuple;
+        /// Join result, containing (join_val, rid_index, rid_probe)
+        typedef std::tuple<uint64_t, uint64_t, uint64_t> triple;
+
+        /// Builds the index on the calling thread with 1.5 buckets per tuple
+        hash_index(const tuple* data, uint64_t size);
+        /**
+         * Builds the index with several threads on the process wide executor
+         * @param table_size  table_size*size is the number of buckets
+         * @param threads     number of threads building the index
+         */
+        hash_index(const tuple* data, uint64_t size, double table_size, uint8_t threads);
+        /// Same as above on the given executor, which is also used for parallel probes
+        hash_index(const tuple* data, uint64_t size, double table_size, uint8_t threads, helpers::executor& exec);
+        /// Loads an index written by save(), throws std::runtime_error if the file cannot be read
+        explicit hash_index(const std::string& path);
+
+        /// Default number of probe tuples handed out per morsel
+        static constexpr uint64_t default_morsel = static_cast<uint64_t>(1) << 14;
+
+        /// Emits all index partners of a probe tuple, returns true if there was one. May be called concurrently.
+        bool probe(const tuple& curr, std::vector<triple>& out) const;
+        /**
+         * Probes a batch on the calling thread, may be called concurrently
+         * @param type  inner or right_outer, the latter emits probe tuples without partner. Joins preserving
+         *              the index side throw std::invalid_argument, the immutable index keeps no match flags.
+         */
+        void probe(const tuple* data, uint64_t count, helpers::join_type type, std::vector<triple>& out) const;
+        /// Probes a batch with several threads, one result vector per morsel gets appended to 'out'
+        void probe(const tuple* data, uint64_t count, helpers::join_type type, uint8_t threads,
+                   std::vector<std::vector<triple>>& out) const;
+
+        /// Writes the index to the given file, throws std::runtime_error on I/O errors
+        void save(const std::string& path) const;
+
+        /// Number of indexed tuples
+        uint64_t size() const;
+        /// Number of buckets
+        uint64_t buckets() const;
+        /// Bytes held by the index
+        uint64_t memory_bytes() const;
+        /// Bytes an index over 'size' tuples with the given table size will hold, for planning before the build
+        static uint64_t estimate_bytes(uint64_t size, double table_size);
+
+        /// Runs parallel probes on the given executor instead of the one used for the build
+        void set_executor(helpers::executor& exec);
+
+    private:
+        /// Sorts the tuples of the buckets [first, last) into place, their tuples start at 'target'
+        void build_range(const tuple* src, uint64_t count, uint64_t first, uint64_t last, uint64_t target);
+        /// Bucket of a key
+        uint64_t bucket_of(uint64_t key) const;
+
+        /// Number of indexed tuples
+        uint64_t count;
+        /// Number of buckets
+        uint64_t bucket_count;
+        /// Executor running parallel builds and probes
+        helpers::executor* exec;
+        /// Start of every bucket within the tuples, bucket_count + 1 entries
+        std::unique_ptr<helpers::page_buffer> offsets;
+        /// Tuples grouped by bucket
+        std::unique_ptr<helpers::page_buffer> tuples;
+    };
+
+}  // namespace algorithms
+
+#endif  // HASHJOINS_HASH_INDEX_H
@@ -0,0 +1,87 @@
+//
+// Benjamin Wagner 2018
+//
+
+#ifndef HASHJOINS_JOIN_OPTIMIZER_H
+#define HASHJOINS_JOIN_OPTIMIZER_H
+
+#include <string>
+#include <vector>
+#include <tuple>
+#include "algorithms/hash_helpers.h"
+#include "algorithms/executor.h"
+#include "algorithms/join_planner.h"
+
+namespace algorithms {
+
+    /// Join façade picking the algorithm and its parameters from the machine's caches and a sample of the inputs
+    class join_optimizer {
+    public:
+        /// First element is the value on which should be joined, second one the rid
+        typedef std::tuple<uint64_t, uint64_t> tuple;
+        /// Join result, containing (join_val, rid_left, rid_right)
+        typedef std::tuple<uint64_t, uint64_t, uint64_t> triple;
+
+        /// Basic constructor, plans for the caches of the current machine
+        join_optimizer(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r);
+        /// Join constructor with additional parameter
+        join_optimizer(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r, uint8_t threads,
+                       helpers::join_type type);
+        /// Join constructor planning for the given memory hierarchy instead of the detected one
+        join_optimizer(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r, uint8_t threads,
+                       helpers::join_type type, cache_info caches);
+
+        /// Cache and TLB sizes of the current machine, detected once on first use
+        static const cache_info& machine();
+
+        /// Reads the cache sizes from the operating system and the TLB size from cpuid, missing values keep defaults
+        static cache_info detect_caches();
+
+        /// Samples the inputs and decides on the algorithm, done implicitly by execute()
+        const join_plan& plan();
+
+        /// Runs the chosen join and writes result, multi pass radix joins use the inputs as scratch space
+        void execute();
+
+        /// Returns a reference to the result vectors of the chosen join
+        std::vector<std::vector<triple>>& get();
+
+        /// Pass a result vector to the join, will be moved and may not be used further by the caller
+        void set(std::vector<std::vector<triple>>& res_vec);
+
+        /// Runs the chosen join on the given executor instead of the process wide one
+        void set_executor(helpers::executor& exec);
+
+        /// Single line description of the decision and the statistics it was based on
+        std::string report();
+
+    private:
+        /// Left join partner
+        tuple* left;
+        /// Right join partner
+        tuple* right;
+        /// Size of the left array
+        uint64_t size_l;
+        /// Size of the right array
+        uint64_t size_r;
+        /// number of threads on which the chosen join should be run
+        uint8_t threads;
+        /// Inner or outer join semantics
+        helpers::join_type type;
+        /// Memory hierarchy the plan is derived for
+        cache_info caches;
+        /// Boolean flag indicating whether the inputs were already sampled
+        bool planned;
+        /// Boolean flag indicating whether build was already called
+        bool built;
+        /// Executor running the chosen join, defaults to helpers::executor::global()
+        helpers::executor* exec;
+        /// Decision of the planner
+        join_plan decision;
+        /// Result vectors taken over from the chosen join
+        std::vector<std::vector<triple>> result;
+    };
+
+}  // namespace algorithms
+
+#endif  // HASHJOINS_JOIN_OPTIMIZER_H
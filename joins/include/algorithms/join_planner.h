@@ -0,0 +1,95 @@
+//
+// Benjamin Wagner 2018
+//
+
+#ifndef HASHJOINS_JOIN_PLANNER_H
+#define HASHJOINS_JOIN_PLANNER_H
+
+#include <vector>
+#include <tuple>
+#include "algorithms/hash_helpers.h"
+
+namespace algorithms {
+
+    /// Memory hierarchy parameters the plan is derived from
+    struct cache_info {
+        /// Size of the private cache a partition's hash table should fit into
+        uint64_t l2_bytes = static_cast<uint64_t>(256) << 10;
+        /// Size of the shared last level cache
+        uint64_t llc_bytes = static_cast<uint64_t>(8) << 20;
+        /// Number of TLB entries, bounds the fanout of a single radix pass
+        uint64_t tlb_entries = 64;
+    };
+
+    /// Execution decisions derived from a sample of both join inputs
+    struct join_plan {
+        /// False if the no partitioning join should be used
+        bool partition = true;
+        /// Radix bits per pass and number of passes, only meaningful when partitioning
+        uint8_t bits_per_pass = 6;
+        uint8_t passes = 2;
+        /// Final partitions with more probe tuples get probed in parallel, 0 keeps the automatic threshold
+        uint64_t split_threshold = 0;
+        /// table_size*|left| is the size of the hash table being built, lowered for duplicate heavy build sides
+        double table_size = 1.5;
+        /// Tuples per morsel of the no partitioning join
+        uint64_t morsel_size = static_cast<uint64_t>(1) << 14;
+        /// Estimated number of distinct keys of both sides
+        uint64_t distinct_l = 0;
+        uint64_t distinct_r = 0;
+        /// Share of the most frequent key within the sample of both sides
+        double skew_l = 0;
+        double skew_r = 0;
+        /// Keys taking at least heavy_share of either sample, these need special handling
+        std::vector<uint64_t> heavy_hitters;
+    };
+
+    /// Samples both join inputs and derives a join_plan from the observed key distribution
+    class join_planner {
+    public:
+        /// First element is the value on which should be joined, second one the rid
+        typedef std::tuple<uint64_t, uint64_t> tuple;
+
+        /// Minimum share of a sample a key needs in order to count as heavy hitter
+        static constexpr double heavy_share = 0.01;
+
+        /// Basic constructor, samples up to 2^14 tuples per side with a fixed seed
+        join_planner(const tuple* left, const tuple* right, uint64_t size_l, uint64_t size_r);
+        /**
+         * Planner constructor offering maximum flexibility
+         * @param sample_size  maximum number of tuples sampled per side
+         * @param caches       memory hierarchy the plan gets tuned for
+         * @param seed         seed of the sample positions
+         */
+        join_planner(const tuple* left, const tuple* right, uint64_t size_l, uint64_t size_r,
+                     uint64_t sample_size, cache_info caches, uint64_t seed);
+
+        /// Samples both sides and returns the derived plan
+        join_plan plan();
+
+    private:
+        /// Statistics of a single side's sample
+        struct sample_stats {
+            uint64_t distinct;
+            /// Number of sampled tuples and distinct keys among them
+            uint64_t sampled;
+            uint64_t sampled_distinct;
+            double skew;
+            std::vector<uint64_t> heavy;
+        };
+
+        /// Draws a sample of 'data' and estimates its distinct count, skew and heavy hitters
+        sample_stats analyze(const tuple* data, uint64_t size, uint64_t seed);
+
+        const tuple* left;
+        const tuple* right;
+        uint64_t size_l;
+        uint64_t size_r;
+        uint64_t sample_size;
+        cache_info caches;
+        uint64_t seed;
+    };
+
+}  // namespace algorithms
+
+#endif  // HASHJOINS_JOIN_PLANNER_H
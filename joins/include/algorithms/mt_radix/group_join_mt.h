@@ -0,0 +1,74 @@
+//
+// Benjamin Wagner 2018
+//
+
+#ifndef HASHJOINS_GROUP_JOIN_MT_H
+#define HASHJOINS_GROUP_JOIN_MT_H
+
+#include <vector>
+#include <tuple>
+#include <memory>
+#include "algorithms/hash_helpers.h"
+#include "algorithms/executor.h"
+
+namespace algorithms{
+
+    /**
+     * Multi-threaded radix partitioned group join. Both relations are partitioned with the
+     * radix join's tasks, every final partition pair is then group joined by a single thread.
+     * Since partitioning happens on the join key every group lives in exactly one partition.
+     */
+    class group_join_mt {
+    public:
+        /// First element is the value on which should be joined, second one the rid
+        typedef std::tuple<uint64_t, uint64_t> tuple;
+        /// Aggregated result, containing (join_val, count, sum, min, max) over the right rids
+        typedef helpers::group group;
+
+        /// Basic constructor
+        group_join_mt(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r,
+                      uint8_t bits_per_pass, uint8_t passes);
+        /// Join constructor with additional parameter
+        group_join_mt(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r, double table_size,
+                      uint8_t threads, uint8_t bits_per_pass, uint8_t passes);
+
+        /// Performs the actual group join and writes result
+        void execute();
+
+        /// Returns a reference to the result vectors
+        std::vector<std::vector<group>>& get();
+
+        /// Pass a result vector to the join, will be moved and may not be used further by the caller
+        void set(std::vector<std::vector<group>>& res_vec);
+
+        /// Runs the parallel phases on the given executor instead of the process wide one
+        void set_executor(helpers::executor& exec);
+
+    private:
+        /// Left join partner
+        tuple* left;
+        /// Right join partner
+        tuple* right;
+        /// Size of the left array
+        uint64_t size_l;
+        /// Size of the right array
+        uint64_t size_r;
+        /// table_size*|left| is the size of the hash table being built
+        double table_size;
+        /// number of threads on which the algorithm should be run
+        uint8_t threads;
+        /// Boolean flag indicating whether build was already called
+        bool built;
+        /// Executor running the parallel phases, defaults to helpers::executor::global()
+        helpers::executor* exec;
+        /// Result vectors, one per thread
+        std::vector<std::vector<group>> result;
+        /// Number of radix bits on which data should be partitioned every pass
+        uint8_t bits_per_pass;
+        /// Number of partitioning passes that should be performed
+        uint8_t passes;
+    };
+
+}  // namespace algorithms
+
+#endif  // HASHJOINS_GROUP_JOIN_MT_H
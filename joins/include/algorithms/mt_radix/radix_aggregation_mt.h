@@ -0,0 +1,70 @@
+//
+// Benjamin Wagner 2018
+//
+
+#ifndef HASHJOINS_RADIX_AGGREGATION_MT_H
+#define HASHJOINS_RADIX_AGGREGATION_MT_H
+
+#include <vector>
+#include <tuple>
+#include <memory>
+#include "algorithms/hash_helpers.h"
+#include "algorithms/executor.h"
+
+namespace algorithms{
+
+    /**
+     * Multi-threaded radix partitioned hash aggregation (GROUP BY on the key).
+     * The input is partitioned with the radix join's partition and scatter tasks until
+     * partitions are cache sized, every partition is then aggregated with a local table.
+     * Since partitioning happens on the key every group lives in exactly one partition.
+     */
+    class radix_aggregation_mt {
+    public:
+        /// First element is the value on which should be grouped, second one the aggregated payload
+        typedef std::tuple<uint64_t, uint64_t> tuple;
+        /// Aggregated result, containing (key, count, sum, min, max) over the payloads
+        typedef helpers::group group;
+
+        /// Basic constructor
+        radix_aggregation_mt(tuple* data, uint64_t size, uint8_t bits_per_pass, uint8_t passes);
+        /// Aggregation constructor with additional parameter
+        radix_aggregation_mt(tuple* data, uint64_t size, double table_size, uint8_t threads,
+                             uint8_t bits_per_pass, uint8_t passes);
+
+        /// Performs the actual aggregation and writes result
+        void execute();
+
+        /// Returns a reference to the result vectors
+        std::vector<std::vector<group>>& get();
+
+        /// Pass a result vector to the aggregation, will be moved and may not be used further by the caller
+        void set(std::vector<std::vector<group>>& res_vec);
+
+        /// Runs the parallel phases on the given executor instead of the process wide one
+        void set_executor(helpers::executor& exec);
+
+    private:
+        /// Input relation, used as scratch space in multi pass mode
+        tuple* data;
+        /// Size of the input
+        uint64_t size;
+        /// table_size*|partition| is the size of the hash table built per partition
+        double table_size;
+        /// number of threads on which the algorithm should be run
+        uint8_t threads;
+        /// Boolean flag indicating whether execute was already called
+        bool built;
+        /// Executor running the parallel phases, defaults to helpers::executor::global()
+        helpers::executor* exec;
+        /// Result vectors, one per thread
+        std::vector<std::vector<group>> result;
+        /// Number of radix bits on which data should be partitioned every pass
+        uint8_t bits_per_pass;
+        /// Number of partitioning passes that should be performed
+        uint8_t passes;
+    };
+
+}  // namespace algorithms
+
+#endif  // HASHJOINS_RADIX_AGGREGATION_MT_H
@@ -8,6 +8,12 @@
 #include <vector>
 #include <tuple>
 #include <memory>
+#include <string>
+#include "algorithms/hash_helpers.h"
+#include "algorithms/executor.h"
+#include "algorithms/join_planner.h"
+#include "algorithms/calibration.h"
+#include "algorithms/page_allocator.h"
 
 namespace algorithms{
 
@@ -19,12 +25,38 @@ namespace algorithms{
         /// Join result, containing (join_val, rid_left, rid_right)
         typedef std::tuple<uint64_t, uint64_t, uint64_t> triple;
 
+        /// How the partitioning passes treat the input arrays
+        enum class partition_mode {
+            /// One target buffer per side, passes after the first one use the inputs as scratch space
+            scratch,
+            /// Never writes to the inputs, further passes alternate between two private buffers per side
+            copy,
+            /// Permutes the inputs within their own arrays without any buffers
+            in_place
+        };
+
+        /// Constructor taking the parameters from the host's calibration file, static defaults without one
+        radix_join_mt(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r);
+        /// Calibrated constructor with explicit thread count and join semantics
+        radix_join_mt(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r, uint8_t threads,
+                      helpers::join_type type);
         /// Basic constructor
         radix_join_mt(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r,
                       uint8_t bits_per_pass, uint8_t passes);
         /// Join constructor with additional parameter
         radix_join_mt(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r, double table_size,
                       uint8_t threads, uint8_t bits_per_pass, uint8_t passes);
+        /// Join constructor for outer joins
+        radix_join_mt(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r, double table_size,
+                      uint8_t threads, uint8_t bits_per_pass, uint8_t passes, helpers::join_type type);
+
+        /**
+         * Join constructor reading both relations from relation files, see helpers::relation_writer. The files
+         * are read asynchronously into buffers owned by the join while the first pass already builds its
+         * histograms. Throws std::runtime_error if a file cannot be read or holds no relation.
+         */
+        radix_join_mt(const std::string& path_l, const std::string& path_r, double table_size, uint8_t threads,
+                      uint8_t bits_per_pass, uint8_t passes, helpers::join_type type);
 
         /// Performs the actual join and writes result
         void execute();
@@ -35,6 +67,44 @@ namespace algorithms{
         /// Pass a result vector to the join, will be moved and may not be used further by the caller
         void set(std::vector<std::vector<triple>>& res_vec);
 
+        /// Runs the parallel phases on the given executor instead of the process wide one
+        void set_executor(helpers::executor& exec);
+
+        /// Takes over the partitioning, table size and skew parameters of a sampled plan
+        void set_plan(const join_plan& plan);
+
+        /// Takes over the bits, passes and table size of the bracket covering the build side, if there is one
+        void set_calibration(const calibration& tuned);
+
+        /// Places partition buffers and final tasks on the NUMA nodes of the executor's topology
+        void set_numa(bool enabled);
+
+        /// Probe side size above which a final partition gets probed by several tasks, 0 picks it automatically
+        void set_skew_threshold(uint64_t threshold);
+
+        /// Chooses how the inputs are treated by the partitioning, scratch by default
+        void set_partition_mode(partition_mode mode);
+
+        /**
+         * Limits the bytes allocated for partition buffers, unlimited by default. Multi pass scratch partitioning
+         * which does not fit falls back to in place partitioning, it reorders the inputs either way. Single pass
+         * scratch and copying partitioning never write to the inputs, if they do not fit execute() throws
+         * std::length_error. Hash tables of the leaves are not counted, they are cache sized.
+         */
+        void set_memory_budget(uint64_t bytes);
+
+        /// Mode the last execute() actually partitioned with
+        partition_mode used_partition_mode() const;
+
+        /// Buckets of all leaf hash tables built by the last execute()
+        uint64_t leaf_buckets() const;
+
+        /// Partition ranges the last execute() could not bind to their NUMA node
+        uint64_t unbound_ranges() const;
+
+        /// Bytes per read request and requests in flight for file inputs, 4 MiB and 4 by default
+        void set_io(uint64_t chunk_bytes, uint32_t depth);
+
     private:
         /// Left join partner
         tuple* left;
@@ -50,12 +120,43 @@ namespace algorithms{
         uint8_t threads;
         /// Boolean flag indicating whether build was already called
         bool built;
+        /// Executor running the parallel phases, defaults to helpers::executor::global()
+        helpers::executor* exec;
         /// Pointer to the result vectors created by different partitions
         std::vector<std::vector<triple>> result;
         /// Number of radix bits on which data should be partitioned every pass
         uint8_t bits_per_pass;
         /// Number of partitioning passes that should be performed
         uint8_t passes;
+        /// Inner or outer join semantics
+        helpers::join_type type;
+        /// Split threshold handed to the task context, UINT64_MAX disables the skew handling
+        uint64_t skew_threshold;
+        /// Whether partitions get distributed over the NUMA nodes
+        bool numa_aware;
+        /// Requested and last used partitioning mode
+        partition_mode mode;
+        partition_mode used_mode;
+        /// Leaf buckets of the last execute()
+        uint64_t used_buckets;
+        /// Unbound partition ranges of the last execute()
+        uint64_t used_unbound;
+        /// Upper bound for the partition buffers in bytes
+        uint64_t memory_budget;
+        /// Relation files and record offsets of file inputs, empty paths for inputs in memory
+        std::string path_l;
+        std::string path_r;
+        uint64_t offset_l;
+        uint64_t offset_r;
+        /// Buffers the file inputs are read into
+        std::unique_ptr<helpers::page_buffer> input_l;
+        std::unique_ptr<helpers::page_buffer> input_r;
+        /// Bytes per read request and requests in flight
+        uint64_t io_chunk;
+        uint32_t io_depth;
+
+        /// Bytes of partition buffers needed by the given mode
+        uint64_t buffer_bytes(partition_mode mode) const;
     };
 
 };  // namespace algorithms
@@ -10,10 +10,11 @@
 #include <condition_variable>
 #include <vector>
 #include <atomic>
+#include <functional>
 #include <tuple>
 #include <utility>
 #include "algorithms/hash_helpers.h"
-#include "ThreadPool.h"
+#include "algorithms/executor.h"
 
 /**
  * This file contains a variety of tasks used within the radix join which
@@ -21,6 +22,35 @@
  */
 namespace algorithms {
 
+    /**
+     * Per join storage for the fixed size radix histograms. Blocks are carved from large chunks and
+     * recycled through per worker free lists, so steady state partitioning does not hit the allocator.
+     * A free list is only touched by the thread owning it, index 'workers' belongs to the external
+     * thread driving the join.
+     */
+    class histogram_arena {
+    public:
+        /** @param part_count number of buckets per histogram
+         *  @param workers number of pool workers which may acquire or release histograms */
+        histogram_arena(uint64_t part_count, size_t workers);
+
+        /// Returns a zeroed histogram taken from the free list of the given owner
+        uint64_t* acquire(size_t owner);
+        /// Hands a histogram back to the free list of the given owner
+        void release(size_t owner, uint64_t* hist);
+
+    private:
+        /// Histograms carved out of a single chunk
+        static constexpr uint64_t chunk_blocks = 64;
+
+        uint64_t part_count;
+        std::vector<std::vector<uint64_t*>> free_lists;
+        /// Protects chunk creation, only taken once every chunk_blocks fresh histograms
+        std::mutex chunk_lock;
+        std::vector<std::unique_ptr<uint64_t[]>> chunks;
+        uint64_t chunk_used;
+    };
+
     /// Helper struct containing basic information about the executed radix join
     struct task_context {
         /// First element is the value on which should be joined, second one the rid
@@ -28,8 +58,19 @@ namespace algorithms {
         /// Join result, containing (join_val, rid_left, rid_right)
         typedef std::tuple<uint64_t, uint64_t, uint64_t> triple;
 
+        /// Operation run on every final partition pair, receives (context, data_l, data_r, size_l, size_r)
+        typedef std::function<void(task_context*, tuple*, tuple*, uint64_t, uint64_t)> leaf_op;
+
         task_context(uint8_t radix_bits, uint8_t radix_passes, uint8_t thread_count, double table_size,
-                     ThreadPool* pool, std::vector<std::vector<triple>>& results);
+                     helpers::join_type type, helpers::executor::task_group* tasks,
+                     std::vector<std::vector<triple>>& results);
+
+        /// Pops an output buffer index from the free stack, blocks while all buffers are in use
+        uint8_t acquire_output();
+        /// Pushes a previously acquired output buffer index back onto the free stack
+        void release_output(uint8_t index);
+        /// Free list owner of the calling thread within the histogram arena
+        size_t histogram_owner() const;
 
 
         /// The radix bits per pass
@@ -40,8 +81,14 @@ namespace algorithms {
         uint8_t thread_count;
         /// The table size being used
         double table_size;
-        /// The thread pool needed for spawning subtasks
+        /// Inner or outer join semantics, unmatched tuples are emitted per partition by the join tasks
+        helpers::join_type type;
+        /// The task group of the join, subtasks are spawned into it and it gets waited on by radix_run
+        helpers::executor::task_group* tasks;
+        /// The pool the task group runs on
         ThreadPool* pool;
+        /// Storage of all histograms and prefix sums handed between partition and scatter tasks
+        histogram_arena histograms;
         /**
          * We need some form of output coordination.
          * The results vector stores the actual targets being written to,
@@ -50,19 +97,26 @@ namespace algorithms {
          */
         std::vector<uint8_t> free_index;
         std::mutex output_mutex;
+        std::condition_variable output_free;
         std::vector<std::vector<triple>>& results;
+        /// Work performed on the final partitions, defaults to the no partitioning join in join_task
+        leaf_op leaf;
+        /// Leaves with a larger probe side get probed by several tasks, 0 picks a threshold from the input sizes
+        uint64_t split_threshold;
+        /// Probe tuples per task of a split leaf
+        uint64_t split_chunk;
+        /// Buckets of all hash tables built by the leaves so far
+        std::atomic<uint64_t> leaf_buckets;
         /**
-         * We require coordination between the radix_join_mt and the last level
-         * join tasks. This is done through a condition variable, where the radix join
-         * gets notified once all last level join tasks are completed.
+         * Nodes the first pass partitions get distributed over, nullptr disables NUMA placement. Every node
+         * owns a contiguous range of partitions, their target memory is bound to it and all further tasks
+         * of those partitions are posted to its workers.
          */
-        std::mutex join_wait;
-        std::condition_variable wait;
-        bool finished;
-        /// Number of last level join ops that has executed, needed for pool termination
-        std::atomic<uint64_t> join_count;
-        /// Expected number of last level join operations
-        uint64_t join_exp;
+        const helpers::numa_topology* numa;
+        /// Page size of the target buffers, ranges get bound in whole pages of it
+        size_t numa_page;
+        /// Partition ranges the kernel refused to bind to their node
+        std::atomic<uint64_t> unbound;
     };
 
     struct task {
@@ -74,25 +128,101 @@ namespace algorithms {
 
     /// Creates histograms of the hash values within the given partition
     struct partition_task: task {
-        /// Perform the actual operation, returns a histogram of left and right partition
-        static std::pair<std::shared_ptr<std::vector<uint64_t>>, std::shared_ptr<std::vector<uint64_t>>> execute(
+        /// Perform the actual operation, returns arena histograms of left and right partition if not spawning
+        static std::pair<uint64_t*, uint64_t*> execute(
                 task_context* context, bool spawn, uint8_t curr_depth, tuple* data_l, tuple* data_r,
                 uint64_t size_l, uint64_t size_r, tuple* target_l, tuple* target_r);
     };
 
     /// Scatters data from a given partition into destination based on histograms
     struct scatter_task: task {
-        /// Perform the actual operation, no return value needed
-        static bool execute(task_context* context, bool spawn, uint8_t curr_depth, std::shared_ptr<std::vector<uint64_t>> sum_l,
-                     std::shared_ptr<std::vector<uint64_t>> sum_r, tuple* data_l, tuple* data_r, uint64_t size_l,
-                     uint64_t size_r, tuple* target_l, tuple* target_r);
+        /// Perform the actual operation, takes ownership of the arena prefix sums and releases them
+        static bool execute(task_context* context, bool spawn, uint8_t curr_depth, uint64_t* sum_l, uint64_t* sum_r,
+                     tuple* data_l, tuple* data_r, uint64_t size_l, uint64_t size_r, tuple* target_l,
+                     tuple* target_r);
     };
 
-    /// Performs the actual join on given data
+    /// Runs the context's leaf operation on a final partition
+    struct leaf_task: task {
+        static void execute(task_context* context, tuple* data_l, tuple* data_r, uint64_t size_l, uint64_t size_r);
+    };
+
+    /// Performs the actual join on given data, default leaf operation
     struct join_task: task {
         static void execute(task_context* context, tuple* data_l, tuple* data_r, uint64_t size_l, uint64_t size_r);
     };
 
+    /**
+     * In place partitioning of a partition pair on the bits of one pass. Both sides are permuted within
+     * their own memory, then the next pass or the leaves get spawned for the resulting partitions.
+     */
+    struct in_place_task: task {
+        static void execute(task_context* context, uint8_t curr_depth, tuple* data_l, tuple* data_r,
+                            uint64_t size_l, uint64_t size_r);
+        /// Permutes a single relation into the partitions described by the histogram of the given depth
+        static void permute(task_context* context, uint8_t curr_depth, tuple* data, const uint64_t* hist);
+        /**
+         * Same as above with all threads of the context. The tasks permute disjoint stripes of every partition
+         * speculatively, misplaced tuples get repaired and permuted again until the rest is small enough for
+         * a single task. Blocks until done, so it must not run on a worker.
+         */
+        static void permute_parallel(task_context* context, uint8_t curr_depth, tuple* data, const uint64_t* hist);
+    };
+
+    /**
+     * Skew handling of the default leaf. The build side of an oversized partition is put into a latched
+     * table once, its probe side is then split into chunks probed in parallel. The task finishing the
+     * last chunk emits the unmatched build tuples of outer joins.
+     */
+    struct split_join_task: task {
+        /// Build table of a split partition shared by all of its probe tasks
+        struct shared_build {
+            shared_build(uint64_t table_size, tuple* data_r, uint64_t chunks);
+
+            helpers::latched_hash_table table;
+            tuple* data_r;
+            /// Probe chunks which have not finished yet
+            std::atomic<uint64_t> remaining;
+        };
+
+        /// Builds the table of the partition and spawns the probe tasks
+        static void execute(task_context* context, tuple* data_l, tuple* data_r, uint64_t size_l, uint64_t size_r);
+        /// Probes the chunk [start, end) of a split partition
+        static void probe(task_context* context, std::shared_ptr<shared_build> build, uint64_t start, uint64_t end);
+    };
+
+    /// Blocks until the tuples [start, end) of an input are available, used when inputs arrive during the first pass
+    typedef std::function<void(uint64_t start, uint64_t end)> input_wait;
+
+    /**
+     * Drives the complete partitioning of both relations. The first pass is coordinated by the
+     * calling thread, deeper passes spawn themselves. Blocks until all tasks of the context's
+     * task group have finished.
+     * In multi pass mode the input arrays are used as scratch space for the intermediate passes.
+     */
+    struct radix_run: task {
+        static void execute(task_context* context, tuple* left, tuple* right, uint64_t size_l, uint64_t size_r,
+                            tuple* target_l, tuple* target_r);
+        /// Same as above, but the intermediate passes alternate between the targets and the given scratch arrays
+        static void execute(task_context* context, tuple* left, tuple* right, uint64_t size_l, uint64_t size_r,
+                            tuple* target_l, tuple* target_r, tuple* scratch_l, tuple* scratch_r);
+        /**
+         * Same as above, but the inputs are still arriving. Both are split into ranges of 'chunk' tuples, the
+         * histogram of a range pair gets built as soon as wait_l and wait_r returned for it. The scatter starts
+         * once all ranges are in.
+         */
+        static void execute_streamed(task_context* context, tuple* left, tuple* right, uint64_t size_l,
+                                     uint64_t size_r, tuple* target_l, tuple* target_r, tuple* scratch_l,
+                                     tuple* scratch_r, uint64_t chunk, const input_wait& wait_l,
+                                     const input_wait& wait_r);
+        /**
+         * Partitions both relations within the input arrays, no further buffers are needed. The first pass
+         * permutes each side with all threads of the context, the following passes and leaves run in parallel.
+         */
+        static void execute_in_place(task_context* context, tuple* left, tuple* right, uint64_t size_l,
+                                     uint64_t size_r);
+    };
+
 }  // namespace algorithms
 
 #endif  // HASHJOINS_RADIX_TASKS_H
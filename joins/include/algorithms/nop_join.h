@@ -28,6 +28,9 @@ namespace algorithms {
         /// Join constructor  offering maximum flexibility, 'result' is moved into the join object
         nop_join(tuple* left, tuple* right,
                  uint64_t size_l, uint64_t size_r, double table_size, std::vector<triple>& result);
+        /// Join constructor for outer joins, 'result' is moved into the join object
+        nop_join(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r, double table_size,
+                 std::vector<triple>& result, helpers::join_type type);
 
         /// Performs the actual join and writes result
         void execute();
@@ -38,6 +41,8 @@ namespace algorithms {
         /// Pass a result vector to the join, will be moved and may not be used further by the caller
         void set(std::vector<triple>& res_vec);
 
+        /// Buckets of the hash table built by the last execute(), 0 if none was needed
+        uint64_t buckets() const;
 
     private:
         /// Left join partner
@@ -50,8 +55,12 @@ namespace algorithms {
         uint64_t size_r;
         /// table_size*|left| is the size of the hash table being built
         double table_size;
+        /// Inner or outer join semantics
+        helpers::join_type type;
         /// Boolean flag indicating whether build was already called
         bool built;
+        /// Buckets of the last hash table
+        uint64_t table_buckets;
         /// Result vector
         std::vector<triple> result;
     };
@@ -5,10 +5,14 @@
 #ifndef HASHJOINS_NOP_JOIN_MT_H
 #define HASHJOINS_NOP_JOIN_MT_H
 
+#include <atomic>
 #include <memory>
 #include <vector>
 #include <tuple>
 #include "algorithms/hash_helpers.h"
+#include "algorithms/executor.h"
+#include "algorithms/join_planner.h"
+#include "algorithms/numa_hash_table.h"
 
 namespace algorithms{
 
@@ -20,11 +24,31 @@ namespace algorithms{
         /// Join result, containing (join_val, rid_left, rid_right)
         typedef std::tuple<uint64_t, uint64_t, uint64_t> triple;
 
+        /// Placement of the hash table on the NUMA nodes of the executor's topology
+        enum class table_placement {
+            /// One table, pages land wherever they are touched first
+            single,
+            /// The bucket array is split into one chunk per node, every node inserts the tuples of its chunk
+            interleaved,
+            /// Interleaved build, afterwards every node gets a read-only copy it probes locally.
+            /// Joins preserving the build side fall back to interleaved, since match flags would be split.
+            replicated
+        };
+
         /// Basic constructor
         nop_join_mt(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r);
         /// Join constructor with additional parameter
         nop_join_mt(tuple* left, tuple* right,
                 uint64_t size_l, uint64_t size_r, double table_size, uint8_t threads);
+        /// Join constructor for outer joins
+        nop_join_mt(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r,
+                double table_size, uint8_t threads, helpers::join_type type);
+        /// Join constructor with explicit morsel size, zero splits every phase into one static range per thread
+        nop_join_mt(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r,
+                double table_size, uint8_t threads, helpers::join_type type, uint64_t morsel_size);
+
+        /// Default number of tuples (or buckets during the scan) handed out per morsel
+        static constexpr uint64_t default_morsel = static_cast<uint64_t>(1) << 14;
 
         /// Performs the actual join and writes result
         void execute();
@@ -32,12 +56,24 @@ namespace algorithms{
         /// Set the result vector into which data should be written
         void set_res(std::shared_ptr<std::vector<triple>> res);
 
-        /// Returns a reference to the result vectors
+        /// Returns a reference to the result vectors, one per probe morsel followed by one per scan morsel
         std::vector<std::vector<triple>>& get();
 
         /// Pass a result vector to the join, will be moved and may not be used further by the caller
         void set(std::vector<std::vector<triple>>& res_vec);
 
+        /// Runs the parallel phases on the given executor instead of the process wide one
+        void set_executor(helpers::executor& exec);
+
+        /// Takes over the table size and morsel size of a sampled plan
+        void set_plan(const join_plan& plan);
+
+        /// Places the hash table on the NUMA nodes of the executor, single by default
+        void set_placement(table_placement placement);
+
+        /// Table chunks and replicas of the last execute() whose pages could not be bound to their node
+        uint32_t unbound_chunks() const;
+
 
     private:
         /// Left join partner
@@ -52,26 +88,110 @@ namespace algorithms{
         double table_size;
         /// number of threads on which the algorithm should be run
         uint8_t threads;
+        /// Inner or outer join semantics
+        helpers::join_type type;
+        /// Tuples per morsel, zero for static ranges
+        uint64_t morsel_size;
+        /// NUMA placement of the hash table
+        table_placement placement;
+        /// Chunks the last execute() failed to bind
+        uint32_t unbound;
         /// Boolean flag indicating whether build was already called
         bool built;
+        /// Executor running the parallel phases, defaults to helpers::executor::global()
+        helpers::executor* exec;
         /// Result vector into which the final triples get written
         std::vector<std::vector<triple>> result;
 
+        /// Morsel size used for a phase over 'size' elements
+        uint64_t morsel_for(uint64_t size) const;
+
+        /// Chunks of the NUMA hash tables used for the given placement
+        uint32_t table_nodes() const;
+
         /**
-         * Builds a fraction of the left table, used in multi threaded setting
+         * Builds morsels of the left table until all of them are claimed, used in multi threaded setting
+         * @param cursor  shared position of the next unclaimed tuple
+         * @param morsel  number of tuples per morsel
+         * @param table   pointer to the hash table being built
+         */
+        void build(std::atomic<uint64_t>* cursor, uint64_t morsel, helpers::numa_hash_table* table);
+
+        /**
+         * Sorts morsels of the left table by the node owning their bucket, so the inserts can run node local
+         * @param cursor  shared position of the next unclaimed tuple
+         * @param morsel  number of tuples per morsel
+         * @param table   pointer to the hash table being built
+         * @param staged  one vector per morsel and node, morsel m's tuples of node n go to m * nodes + n
+         */
+        void stage(std::atomic<uint64_t>* cursor, uint64_t morsel, helpers::numa_hash_table* table,
+                   std::vector<std::vector<tuple>>* staged);
+
+        /**
+         * Inserts the staged tuples of one node until all morsels are claimed, runs on that node's workers
+         * @param cursor  shared index of the next unclaimed morsel of the node
+         * @param node    node whose tuples get inserted
+         * @param table   pointer to the hash table being built
+         * @param staged  output of the stage phase
+         */
+        void insert_staged(std::atomic<uint64_t>* cursor, uint32_t node, helpers::numa_hash_table* table,
+                           std::vector<std::vector<tuple>>* staged);
+
+        /**
+         * Copies bucket ranges of the built table into a node's replica until all of them are claimed
+         * @param cursor   shared position of the next unclaimed bucket
+         * @param morsel   number of buckets per morsel
+         * @param replica  the node local copy
+         * @param table    the built table
+         */
+        void replicate(std::atomic<uint64_t>* cursor, uint64_t morsel, helpers::numa_hash_table* replica,
+                       helpers::numa_hash_table* table);
+
+        /**
+         * Probes with morsels of the right table until all of them are claimed, used in multi threaded setting
+         * @param cursor    shared position of the next unclaimed tuple
+         * @param morsel    number of tuples per morsel, every morsel writes into its own output vector
+         * @param table     pointer to the hash table used for probing
+         * @param replicas  per node copies of the table, probed instead of it if not empty
+         */
+        void probe(std::atomic<uint64_t>* cursor, uint64_t morsel, helpers::numa_hash_table* table,
+                   std::vector<std::unique_ptr<helpers::numa_hash_table>>* replicas);
+
+        /**
+         * Emits all build tuples within morsels of buckets which were not matched during the probe phase,
+         * used for left and full outer joins
+         * @param cursor  shared position of the next unclaimed bucket
+         * @param morsel  number of buckets per morsel
+         * @param table   pointer to the probed hash table
+         * @param first   output vector of the first scan morsel
+         */
+        void scan(std::atomic<uint64_t>* cursor, uint64_t morsel, helpers::numa_hash_table* table,
+                  uint64_t first);
+
+        /**
+         * Builds a fraction of the left table
          * @param start   start index of the section of the left table that should be built (inclusive)
          * @param end     end index of the section of the left table that should be built (exclusive)
          */
-        void build(uint64_t start, uint64_t end, helpers::latched_hash_table* table);
+        void build_range(uint64_t start, uint64_t end, helpers::numa_hash_table* table);
 
         /**
-         * Probes with a fraction of the right table, used in multi threaded setting
+         * Probes with a fraction of the right table
          * @param start   start index of the section of the right table that should be probed with (inclusive)
          * @param end     end index of the section of the right table that should be probed with (exclusive)
          * @param table   pointer to the hash table used for probing
-         * @param t_num   thread index needed for output coordination
+         * @param vec     output vector of the morsel
+         */
+        void probe_range(uint64_t start, uint64_t end, helpers::numa_hash_table* table, std::vector<triple>& vec);
+
+        /**
+         * Emits the unmatched build tuples within a range of buckets
+         * @param start   first bucket of the range (inclusive)
+         * @param end     last bucket of the range (exclusive)
+         * @param table   pointer to the probed hash table
+         * @param vec     output vector of the morsel
          */
-        void probe(uint64_t start, uint64_t end, helpers::latched_hash_table* table, uint8_t t_num);
+        void scan_range(uint64_t start, uint64_t end, helpers::numa_hash_table* table, std::vector<triple>& vec);
     };
 
 };  // namespace algorithms
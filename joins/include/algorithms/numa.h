@@ -0,0 +1,65 @@
+//
+// Benjamin Wagner 2018
+//
+
+#ifndef HASHJOINS_NUMA_H
+#define HASHJOINS_NUMA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace helpers {
+
+    /**
+     * NUMA nodes of the machine and the CPUs belonging to them. Workers are spread round robin over the
+     * nodes, so small pools still use every socket. A simulated topology behaves the same way for
+     * scheduling, but never binds memory and maps its CPUs onto the ones which actually exist.
+     */
+    class numa_topology {
+    public:
+        /// Single node owning all hardware threads
+        numa_topology();
+
+        /// Reads the nodes from sysfs, falls back to a single node if they are not available
+        static numa_topology detect();
+        /// Simulated topology with 'nodes' nodes of 'cpus_per_node' CPUs each, for testing on any machine
+        static numa_topology fake(uint32_t nodes, uint32_t cpus_per_node);
+        /// Parses a sysfs CPU list like "0-3,8,10-11"
+        static std::vector<uint32_t> parse_cpulist(const std::string& list);
+
+        /// Number of nodes
+        uint32_t nodes() const;
+        /// True if the topology was not read from the machine
+        bool simulated() const;
+        /// Node the given pool worker is placed on
+        uint32_t node_of_worker(size_t worker) const;
+        /// CPU the given pool worker gets pinned to
+        uint32_t cpu_of_worker(size_t worker) const;
+
+        /// Pins the calling thread to the given CPU, returns false if the operating system refused
+        bool pin_current(uint32_t cpu) const;
+        /**
+         * Asks the kernel to place the pages fully inside [addr, addr + bytes) on the node. Without migration
+         * this has to happen before the memory is first written. Simulated or single node topologies only
+         * report success.
+         * @param addr     start of the range
+         * @param bytes    length of the range
+         * @param node     index of the node within this topology
+         * @param migrate  also moves pages which were already touched
+         */
+        bool bind(void* addr, size_t bytes, uint32_t node, bool migrate = false) const;
+        /// Same as above for memory backed by pages of 'page' bytes, mbind rejects ranges not aligned to them
+        bool bind(void* addr, size_t bytes, uint32_t node, size_t page, bool migrate) const;
+
+    private:
+        /// Operating system id and CPUs of every node
+        std::vector<uint32_t> ids;
+        std::vector<std::vector<uint32_t>> cpus;
+        bool fake_nodes;
+    };
+
+}  // namespace helpers
+
+#endif  // HASHJOINS_NUMA_H
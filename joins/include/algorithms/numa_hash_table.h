@@ -0,0 +1,72 @@
+//
+// Benjamin Wagner 2018
+//
+
+#ifndef HASHJOINS_NUMA_HASH_TABLE_H
+#define HASHJOINS_NUMA_HASH_TABLE_H
+
+#include <atomic>
+#include <memory>
+#include <tuple>
+#include <vector>
+#include "algorithms/hash_helpers.h"
+#include "algorithms/numa.h"
+
+namespace helpers {
+
+    /**
+     * Latched hash table whose bucket array is split into one contiguous chunk per NUMA node.
+     * A key's bucket is chosen over the whole table, the chunk containing it decides the owning node.
+     * With a single node it behaves like one latched_hash_table.
+     */
+    class numa_hash_table {
+    public:
+        /// First element is the value on which should be joined, second one the rid
+        typedef std::tuple<uint64_t, uint64_t> tuple;
+        /// Join result, containing (join_val, rid_left, rid_right)
+        typedef std::tuple<uint64_t, uint64_t, uint64_t> triple;
+
+        /// 'size' buckets split over 'nodes' chunks, which get created by allocate()
+        numa_hash_table(uint64_t size, uint32_t nodes);
+
+        /**
+         * Creates a chunk and binds its pages to a node, meant to run on a worker of that node
+         * @param chunk     index of the chunk
+         * @param node      node of the topology the chunk belongs to
+         * @param topology  topology used for binding
+         */
+        void allocate(uint32_t chunk, uint32_t node, const numa_topology& topology);
+        /// Chunks whose pages the kernel refused to place on their node
+        uint32_t unbound_chunks() const;
+
+        /// Number of chunks
+        uint32_t nodes() const;
+        /// Total number of buckets
+        uint64_t size() const;
+        /// Node owning the bucket of the key
+        uint32_t node_of(uint64_t key) const;
+
+        /// Inserts a build tuple, may be called concurrently
+        void insert(const tuple& curr);
+        /// Emits all join partners of a probe tuple, see latched_hash_table::probe
+        bool probe(const tuple& curr, bool mark, std::vector<triple>& out);
+        /// Emits the never matched build tuples of the buckets [start, end) of the whole table
+        void scan(uint64_t start, uint64_t end, std::vector<triple>& out);
+        /// Inserts all build tuples of the buckets [start, end) of 'other' into this table
+        void copy_from(numa_hash_table& other, uint64_t start, uint64_t end);
+
+    private:
+        /// Chunk and chunk local bucket of a key
+        std::pair<uint32_t, uint64_t> locate(uint64_t key) const;
+
+        uint64_t buckets;
+        /// First bucket of every chunk, followed by the total size
+        std::vector<uint64_t> starts;
+        std::vector<std::unique_ptr<latched_hash_table>> chunks;
+        /// Chunks whose binding failed, chunks get allocated concurrently
+        std::atomic<uint32_t> unbound;
+    };
+
+}  // namespace helpers
+
+#endif  // HASHJOINS_NUMA_HASH_TABLE_H
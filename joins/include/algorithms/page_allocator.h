@@ -0,0 +1,123 @@
+//
+// Benjamin Wagner 2018
+//
+
+#ifndef HASHJOINS_PAGE_ALLOCATOR_H
+#define HASHJOINS_PAGE_ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string>
+
+namespace helpers {
+
+    /// Pages backing a large allocation
+    enum class page_mode {
+        /// Default 4 KiB pages
+        small,
+        /// Transparent huge pages requested through madvise, the kernel decides whether it provides them
+        transparent,
+        /// Explicit 2 MiB pages taken from the reserved hugetlb pool
+        huge,
+        /// Explicit pages if some are reserved, transparent ones otherwise, small ones below one huge page
+        automatic
+    };
+
+    /// Size of a huge page, buffers backed by huge pages are aligned to it
+    constexpr size_t huge_page_bytes = static_cast<size_t>(1) << 21;
+
+    /// Page mode of all following allocations, read from HASHJOINS_PAGES on first use and automatic by default
+    page_mode default_pages();
+    /// Overrides the page mode of all following allocations, meant for benchmarks comparing the modes
+    void set_default_pages(page_mode mode);
+    /// Parses "small", "transparent", "huge" or "auto", throws std::invalid_argument otherwise
+    page_mode parse_pages(const std::string& name);
+    /// Name of the mode as accepted by parse_pages
+    std::string page_name(page_mode mode);
+    /// Bytes of the pages an allocation obtained, transparent huge pages count as small ones
+    size_t page_bytes(page_mode obtained);
+
+    /**
+     * Page aligned memory which is not touched on allocation, pages get placed on first write or by
+     * numa_topology::bind(). Pages which are not available fall back to the next smaller kind:
+     * explicit huge pages to transparent ones and those to small pages.
+     */
+    class page_buffer {
+    public:
+        /// Buffer using the default page mode
+        explicit page_buffer(size_t bytes);
+        page_buffer(size_t bytes, page_mode mode);
+        ~page_buffer();
+        page_buffer(const page_buffer&) = delete;
+        page_buffer& operator=(const page_buffer&) = delete;
+
+        /// Start of the buffer, nullptr for an empty one
+        void* data();
+        /// Typed start of the buffer
+        template<class T>
+        T* as() { return static_cast<T*>(data()); }
+        /// Size in bytes
+        size_t size() const;
+        /// Pages which were actually requested from the kernel, never automatic
+        page_mode pages() const;
+
+    private:
+        /// Tries to map the buffer with the given pages, returns false if the kernel refused
+        bool map(page_mode mode);
+
+        void* memory;
+        size_t bytes;
+        /// Mapped length, explicit huge pages round the buffer up to whole pages
+        size_t mapped;
+        page_mode obtained;
+    };
+
+    /**
+     * Array of default constructed elements for large tables. Arrays of at least one huge page live in a
+     * page_buffer, smaller ones stay on the heap, since a mapping per radix partition costs more than
+     * the few TLB entries it saves.
+     */
+    template<class T>
+    class page_array {
+    public:
+        explicit page_array(size_t count): first(nullptr), count(count) {
+            if(count * sizeof(T) < huge_page_bytes){
+                heap = std::make_unique<T[]>(count);
+                first = heap.get();
+                return;
+            }
+            buffer = std::make_unique<page_buffer>(count * sizeof(T));
+            first = buffer->as<T>();
+            for(size_t k = 0; k < count; ++k){
+                new(first + k) T();
+            }
+        }
+
+        ~page_array() {
+            for(size_t k = 0; buffer && k < count; ++k){
+                first[k].~T();
+            }
+        }
+
+        page_array(const page_array&) = delete;
+        page_array& operator=(const page_array&) = delete;
+
+        T& operator[](size_t index) { return first[index]; }
+        const T& operator[](size_t index) const { return first[index]; }
+        /// Start of the array
+        T* get() { return first; }
+        /// Pages backing the array, small for heap allocated ones
+        page_mode pages() const { return buffer ? buffer->pages() : page_mode::small; }
+
+    private:
+        std::unique_ptr<T[]> heap;
+        std::unique_ptr<page_buffer> buffer;
+        T* first;
+        size_t count;
+    };
+
+}  // namespace helpers
+
+#endif  // HASHJOINS_PAGE_ALLOCATOR_H
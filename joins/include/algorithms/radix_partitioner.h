@@ -0,0 +1,81 @@
+//
+// Benjamin Wagner 2018
+//
+
+#ifndef HASHJOINS_RADIX_PARTITIONER_H
+#define HASHJOINS_RADIX_PARTITIONER_H
+
+#include <memory>
+#include <vector>
+#include <tuple>
+#include "algorithms/executor.h"
+#include "algorithms/page_allocator.h"
+
+namespace algorithms {
+
+    /**
+     * Standalone parallel radix partitioner for a single relation.
+     * Partitions on the murmur3 hash bits [shift, shift + bits) of the key using the same
+     * histogram and scatter kernel as the radix joins. The result is the partitioned buffer
+     * together with the partition boundaries, which makes it usable as building block for
+     * joins, aggregation, sorting or spilling.
+     */
+    class radix_partitioner {
+    public:
+        /// First element is the value on which should be partitioned, second one the rid
+        typedef std::tuple<uint64_t, uint64_t> tuple;
+
+        /// Partitioner writing into an internally allocated buffer
+        radix_partitioner(tuple* data, uint64_t size, uint8_t shift, uint8_t bits, uint8_t threads);
+        /// Partitioner writing into the caller provided 'target' which has to hold at least 'size' tuples
+        radix_partitioner(tuple* data, uint64_t size, uint8_t shift, uint8_t bits, uint8_t threads, tuple* target);
+
+        /// Performs the actual partitioning, the input is left untouched
+        void execute();
+        /**
+         * Same as above, the histogram and scatter steps run as tasks of a group of an operator which
+         * already got admitted on its executor. Must not be called from a worker.
+         */
+        void execute(helpers::executor::task_group& tasks);
+
+        /// Runs standalone partitionings on the given executor instead of the process wide one
+        void set_executor(helpers::executor& exec);
+
+        /// Returns the partitioned buffer
+        tuple* get();
+
+        /// Returns the 2^bits + 1 partition boundaries, partition k spans [bounds[k], bounds[k + 1])
+        std::vector<uint64_t>& get_bounds();
+
+        /// Number of partitions being created
+        uint64_t part_count() const;
+
+    private:
+        /// Histogram and scatter steps on 'chunks' equally sized chunks, one task each
+        void partition(helpers::executor::task_group& tasks, uint8_t chunks);
+
+        /// Relation to be partitioned
+        tuple* data;
+        /// Size of the relation
+        uint64_t size;
+        /// Lowest hash bit the partitioning looks at
+        uint8_t shift;
+        /// Number of hash bits the partitioning looks at
+        uint8_t bits;
+        /// number of chunks partitioned in parallel, standalone runs use fewer if the executor grants fewer
+        uint8_t threads;
+        /// Boolean flag indicating whether execute was already called
+        bool built;
+        /// Executor of standalone partitionings, defaults to helpers::executor::global()
+        helpers::executor* exec;
+        /// Target buffer in case it is owned by the partitioner
+        std::unique_ptr<helpers::page_buffer> owned;
+        /// Buffer the partitions get scattered into
+        tuple* target;
+        /// Partition boundaries
+        std::vector<uint64_t> bounds;
+    };
+
+}  // namespace algorithms
+
+#endif  // HASHJOINS_RADIX_PARTITIONER_H
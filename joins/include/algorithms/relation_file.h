@@ -0,0 +1,112 @@
+//
+// Benjamin Wagner 2018
+//
+
+#ifndef HASHJOINS_RELATION_FILE_H
+#define HASHJOINS_RELATION_FILE_H
+
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace helpers {
+
+    /**
+     * Header at the start of every relation file. The records follow at 'offset', which is page aligned.
+     * They are stored in the in-memory layout of the join tuples of the writing machine, so a mapped file
+     * can be handed to the joins without any conversion.
+     */
+    struct relation_header {
+        /// "HJREL01" followed by a zero byte
+        char magic[8];
+        /// Values per record, 2 for relations (key, rid) and 3 for join results (key, rid_l, rid_r)
+        uint32_t columns;
+        /// Bytes per value, every column is a uint64_t
+        uint32_t key_width;
+        /// Number of records
+        uint64_t count;
+        /// Smallest and largest key, min_key > max_key for empty files
+        uint64_t min_key;
+        uint64_t max_key;
+        /// Byte offset of the first record
+        uint64_t offset;
+    };
+
+    /**
+     * Writes relation files record by record. The statistics are collected while appending, the header is
+     * written by finish(). I/O errors throw std::runtime_error.
+     */
+    class relation_writer {
+    public:
+        typedef std::tuple<uint64_t, uint64_t> tuple;
+        typedef std::tuple<uint64_t, uint64_t, uint64_t> triple;
+
+        /**
+         * @param path     file to create, existing files get truncated
+         * @param columns  2 for relations and 3 for join results
+         */
+        relation_writer(const std::string& path, uint32_t columns);
+        /// Finishes the file if the caller did not, errors are swallowed there
+        ~relation_writer();
+        relation_writer(const relation_writer&) = delete;
+        relation_writer& operator=(const relation_writer&) = delete;
+
+        /// Appends relation tuples, requires a file with two columns
+        void append(const tuple* data, uint64_t count);
+        /// Appends result triples, requires a file with three columns
+        void append(const triple* data, uint64_t count);
+        /// Writes the header and closes the file
+        void finish();
+
+    private:
+        /// Writes raw records and updates the statistics
+        void write(const void* data, uint64_t count, uint32_t columns, uint64_t min_key, uint64_t max_key);
+
+        int fd;
+        std::string path;
+        relation_header header;
+    };
+
+    /// Writes a whole relation, e.g. the output of a generator
+    void write_relation(const std::string& path, const std::vector<std::tuple<uint64_t, uint64_t>>& data);
+    /// Writes a join result, the partitioned vectors get concatenated
+    void write_result(const std::string& path,
+                      const std::vector<std::vector<std::tuple<uint64_t, uint64_t, uint64_t>>>& result);
+
+    /// Reads and validates the header of a relation file, throws std::runtime_error like mapped_relation
+    relation_header read_relation_header(const std::string& path);
+
+    /**
+     * Read only view of a relation file mapped into memory. The mapping is private and writable, joins
+     * partitioning their inputs in place only copy the pages they touch and never modify the file.
+     */
+    class mapped_relation {
+    public:
+        typedef std::tuple<uint64_t, uint64_t> tuple;
+        typedef std::tuple<uint64_t, uint64_t, uint64_t> triple;
+
+        /// Maps the given file, throws std::runtime_error if it cannot be read or is no relation file
+        explicit mapped_relation(const std::string& path);
+        ~mapped_relation();
+        mapped_relation(const mapped_relation&) = delete;
+        mapped_relation& operator=(const mapped_relation&) = delete;
+
+        /// Header including the statistics of the file
+        const relation_header& header() const;
+        /// Number of records
+        uint64_t size() const;
+        /// Records of a relation file, throws std::logic_error for result files
+        tuple* tuples();
+        /// Records of a result file, throws std::logic_error for relation files
+        triple* triples();
+
+    private:
+        void* mapping;
+        uint64_t length;
+        relation_header head;
+    };
+
+}  // namespace helpers
+
+#endif  // HASHJOINS_RELATION_FILE_H
@@ -0,0 +1,59 @@
+//
+// Benjamin Wagner 2018
+//
+
+#ifndef HASHJOINS_SPILL_FILE_H
+#define HASHJOINS_SPILL_FILE_H
+
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace helpers {
+
+    /// Directory spill files are created in, TMPDIR if set and /tmp otherwise
+    std::string default_spill_directory();
+
+    /**
+     * Anonymous temporary file holding spilled tuples. The file is unlinked right after creation, so it
+     * disappears once closed, even if the process dies. Appends are collected in a buffer which reaches
+     * the disk as one large sequential write. I/O errors throw std::runtime_error.
+     */
+    class spill_file {
+    public:
+        /// First element is the join value, second one the rid
+        typedef std::tuple<uint64_t, uint64_t> tuple;
+
+        /**
+         * @param directory     directory the file gets created in
+         * @param buffer_bytes  size of the write buffer, rounded down to whole tuples
+         */
+        spill_file(const std::string& directory, uint64_t buffer_bytes);
+        ~spill_file();
+        spill_file(const spill_file&) = delete;
+        spill_file& operator=(const spill_file&) = delete;
+
+        /// Appends tuples, the buffer gets written out whenever it is full
+        void append(const tuple* data, uint64_t count);
+        /// Writes out the buffered tuples and releases the buffer, further appends allocate it again
+        void finish();
+        /// Number of tuples appended so far
+        uint64_t size() const;
+        /// Reads the tuples [start, start + count), which have to be written out already, into 'target'
+        void read(uint64_t start, uint64_t count, tuple* target) const;
+
+    private:
+        /// Writes out the buffered tuples
+        void flush();
+
+        int fd;
+        uint64_t capacity;
+        std::vector<tuple> buffer;
+        /// Tuples already written to the file
+        uint64_t written;
+    };
+
+}  // namespace helpers
+
+#endif  // HASHJOINS_SPILL_FILE_H
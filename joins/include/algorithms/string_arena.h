@@ -0,0 +1,63 @@
+//
+// Benjamin Wagner 2018
+//
+
+#ifndef HASHJOINS_STRING_ARENA_H
+#define HASHJOINS_STRING_ARENA_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace helpers {
+
+    /**
+     * Append only storage for variable length strings. All characters live in one contiguous
+     * buffer, every string is described by a small fixed size entry also holding its first
+     * eight bytes as prefix. Strings are referred to by their index within the arena.
+     */
+    class string_arena {
+    public:
+        /// Creates an empty arena
+        string_arena() = default;
+
+        /// Appends a string and returns its index
+        uint64_t add(const char* data, uint64_t length);
+        /// Appends a string and returns its index
+        uint64_t add(const std::string& str);
+
+        /// Number of strings stored within the arena
+        uint64_t size() const;
+
+        /// Returns a copy of the string with the given index
+        std::string get(uint64_t index) const;
+
+        /// 64 bit hash of the string with the given index
+        uint64_t hash(uint64_t index) const;
+
+        /**
+         * Compares a string of this arena with one of another arena. Length and inline prefix
+         * are checked first, the characters are only touched if both agree.
+         */
+        bool equal(uint64_t index, const string_arena& other, uint64_t other_index) const;
+
+    private:
+        /// Fixed size description of one string
+        struct entry {
+            /// Offset of the first character within the character buffer
+            uint64_t offset;
+            /// Length of the string
+            uint64_t length;
+            /// First eight characters, zero padded
+            uint64_t prefix;
+        };
+
+        /// Contiguous buffer of all characters
+        std::vector<char> chars;
+        /// Description of all strings
+        std::vector<entry> entries;
+    };
+
+}  // namespace helpers
+
+#endif  // HASHJOINS_STRING_ARENA_H
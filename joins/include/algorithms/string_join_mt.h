@@ -0,0 +1,69 @@
+//
+// Benjamin Wagner 2018
+//
+
+#ifndef HASHJOINS_STRING_JOIN_MT_H
+#define HASHJOINS_STRING_JOIN_MT_H
+
+#include <memory>
+#include <vector>
+#include <tuple>
+#include "algorithms/string_arena.h"
+#include "algorithms/executor.h"
+
+namespace algorithms {
+
+    /**
+     * Multi threaded join on variable length string keys stored within string arenas.
+     * The partitioned and hashed tuples stay (hash, arena index) pairs of 16 bytes, so scattering
+     * costs the same as for fixed width keys. Candidates with equal hashes get their lengths and
+     * inline prefixes compared before the actual characters are looked at.
+     * The rid of a string is its index within the arena.
+     */
+    class string_join_mt {
+    public:
+        /// Join result, containing (index_left, index_right)
+        typedef std::tuple<uint64_t, uint64_t> pair;
+
+        /// Basic constructor, uses the no partitioning join
+        string_join_mt(const helpers::string_arena& left, const helpers::string_arena& right);
+        /// Join constructor with additional parameters, zero passes select the no partitioning join
+        string_join_mt(const helpers::string_arena& left, const helpers::string_arena& right, double table_size,
+                       uint8_t threads, uint8_t bits_per_pass, uint8_t passes);
+
+        /// Performs the actual join and writes result
+        void execute();
+
+        /// Returns a reference to the result vectors
+        std::vector<std::vector<pair>>& get();
+
+        /// Pass a result vector to the join, will be moved and may not be used further by the caller
+        void set(std::vector<std::vector<pair>>& res_vec);
+
+        /// Runs the parallel phases on the given executor instead of the process wide one
+        void set_executor(helpers::executor& exec);
+
+    private:
+        /// Keys of the left join partner
+        const helpers::string_arena& left;
+        /// Keys of the right join partner
+        const helpers::string_arena& right;
+        /// table_size*|left| is the size of the hash table being built
+        double table_size;
+        /// number of threads on which the algorithm should be run
+        uint8_t threads;
+        /// Number of radix bits on which data should be partitioned every pass
+        uint8_t bits_per_pass;
+        /// Number of partitioning passes that should be performed, 0 for the no partitioning join
+        uint8_t passes;
+        /// Boolean flag indicating whether build was already called
+        bool built;
+        /// Executor running the parallel phases, defaults to helpers::executor::global()
+        helpers::executor* exec;
+        /// Result vectors, one per thread
+        std::vector<std::vector<pair>> result;
+    };
+
+}  // namespace algorithms
+
+#endif  // HASHJOINS_STRING_JOIN_MT_H
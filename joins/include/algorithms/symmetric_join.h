@@ -0,0 +1,116 @@
+//
+// Benjamin Wagner 2018
+//
+
+#ifndef HASHJOINS_SYMMETRIC_JOIN_H
+#define HASHJOINS_SYMMETRIC_JOIN_H
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+#include "algorithms/hash_helpers.h"
+#include "algorithms/executor.h"
+
+namespace algorithms {
+
+    /**
+     * Pipelined symmetric hash join for unbounded inputs. Tuples arrive in batches on either side, get
+     * inserted into the table of their side and immediately probe the table of the other side, so every
+     * match is emitted as soon as its second tuple arrived. Inner join semantics only.
+     *
+     * Every side is kept as a sequence of panes, each with its own latched_hash_table sized for a full
+     * pane. New tuples go to the newest pane, probes visit all panes of the other side. With a window,
+     * the oldest pane is dropped as a whole once the window is exceeded, which bounds the memory without
+     * deleting single tuples. A tuple always meets at least the last 'window' tuples of the other side.
+     * Without a window the panes grow geometrically, so every probe visits a logarithmic number of tables.
+     */
+    class symmetric_join {
+    public:
+        /// First element is the value on which should be joined, second one the rid
+        typedef std::tuple<uint64_t, uint64_t> tuple;
+        /// Join result, containing (join_val, rid_left, rid_right)
+        typedef std::tuple<uint64_t, uint64_t, uint64_t> triple;
+
+        /// Unbounded join keeping every tuple, single threaded
+        symmetric_join();
+        /**
+         * Join constructor offering maximum flexibility
+         * @param window      tuples per side every new tuple gets matched with, 0 keeps all tuples
+         * @param panes       number of panes the window is evicted in, more panes evict in smaller steps
+         *                    but make every probe visit more tables
+         * @param table_size  table_size*|pane| is the size of every pane's hash table
+         * @param threads     number of threads processing large batches
+         */
+        symmetric_join(uint64_t window, uint32_t panes, double table_size, uint8_t threads);
+
+        /// Tuples of the first pane if no window bounds the join
+        static constexpr uint64_t unbounded_pane = static_cast<uint64_t>(1) << 16;
+        /// Batches smaller than this are processed by the calling thread alone
+        static constexpr uint64_t parallel_batch = static_cast<uint64_t>(1) << 13;
+
+        /// Inserts a batch of left tuples and appends their matches with the right side to 'out'
+        void push_left(const tuple* data, uint64_t count, std::vector<triple>& out);
+        /// Inserts a batch of right tuples and appends their matches with the left side to 'out'
+        void push_right(const tuple* data, uint64_t count, std::vector<triple>& out);
+
+        /// Left tuples currently held for matching
+        uint64_t resident_left() const;
+        /// Right tuples currently held for matching
+        uint64_t resident_right() const;
+        /// Bytes of the bucket arrays of all panes, overflow chains are not included
+        uint64_t table_bytes() const;
+
+        /// Runs large batches on the given executor instead of the process wide one
+        void set_executor(helpers::executor& exec);
+
+    private:
+        /// A fixed size part of one side
+        struct pane {
+            pane(uint64_t capacity, double table_size);
+
+            helpers::latched_hash_table table;
+            /// Tuples the pane takes before the next one gets opened
+            uint64_t capacity;
+            /// Tuples inserted so far
+            uint64_t count;
+        };
+
+        /// All panes of one side, the newest one at the back
+        struct side {
+            std::deque<std::unique_ptr<pane>> panes;
+            /// Sum of the pane counts
+            uint64_t resident = 0;
+        };
+
+        /**
+         * Inserts a batch into 'own' and probes it against 'other'
+         * @param left_side  whether 'own' is the left side, decides the order within the emitted triples
+         */
+        void push(side& own, side& other, bool left_side, const tuple* data, uint64_t count,
+                  std::vector<triple>& out);
+        /// Inserts tuples into the newest pane of 'own' and probes them against every pane of 'other'
+        void process(pane& target, const side& other, bool left_side, const tuple* data, uint64_t count,
+                     std::vector<triple>& out);
+
+        /// Tuples per pane, for unbounded joins the size of the first one, later ones match the side so far
+        uint64_t pane_size;
+        /// Full panes kept besides the newest one, 0 for unbounded joins
+        uint32_t pane_count;
+        /// table_size*pane_size is the size of every pane's table
+        double table_size;
+        /// number of threads on which large batches are processed
+        uint8_t threads;
+        /// Executor running large batches, defaults to helpers::executor::global()
+        helpers::executor* exec;
+        /// Serializes batches, tuples of one batch have to see all tuples of earlier ones
+        mutable std::mutex lock;
+        side left;
+        side right;
+    };
+
+}  // namespace algorithms
+
+#endif  // HASHJOINS_SYMMETRIC_JOIN_H
@@ -6,6 +6,7 @@
 #define HASHJOINS_ZIPF_GENERATOR_H
 
 #include <memory>
+#include <string>
 #include <vector>
 #include <tuple>
 
@@ -37,6 +38,8 @@ namespace generators {
         uint64_t get_count();
         /// Return an exclusive copy of the data in a vector. May not be called before previous call to build.
         std::vector<std::tuple<uint64_t, uint64_t>> get_vec_copy();
+        /// Write the data to a relation file which can be mapped by helpers::mapped_relation
+        void write(const std::string& path);
 
         /// Member-wise copy and move is fine
         ~zipf_generator() = default;
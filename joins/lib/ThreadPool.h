@@ -1,5 +1,11 @@
 /*
-SLightly modified thread Pool implementation: https://github.com/progschj/ThreadPool
+Modified thread Pool implementation: https://github.com/progschj/ThreadPool
+
+The central task queue was replaced by work stealing: every worker owns a deque,
+tasks enqueued from within a worker are pushed onto its own deque and idle
+workers steal from randomly chosen victims. Tasks are stored inline as fixed
+size objects, the fire-and-forget post() path does not allocate. Workers can
+run a start hook (e.g. for pinning) and tasks can be placed on a given worker.
 
 Copyright (c) 2012 Jakob Progsch, Václav Zeman
 
@@ -27,59 +33,240 @@ freely, subject to the following restrictions:
 #define THREAD_POOL_H
 
 #include <vector>
-#include <queue>
+#include <cstddef>
 #include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <thread>
 #include <mutex>
+#include <atomic>
 #include <condition_variable>
 #include <future>
 #include <functional>
 #include <stdexcept>
 
+// Type erased callable with a fixed size inline buffer, never allocates
+class PoolTask {
+public:
+    static constexpr size_t capacity = 120;
+
+    PoolTask(): manage(nullptr) {}
+    template<class F,
+             class = typename std::enable_if<!std::is_same<typename std::decay<F>::type, PoolTask>::value>::type>
+    explicit PoolTask(F&& f) {
+        using T = typename std::decay<F>::type;
+        static_assert(sizeof(T) <= capacity, "task does not fit into the inline buffer of PoolTask");
+        static_assert(alignof(T) <= alignof(std::max_align_t), "task is over-aligned for PoolTask");
+        new (storage) T(std::forward<F>(f));
+        manage = [](op o, PoolTask* self, PoolTask* other) {
+            T* callable = reinterpret_cast<T*>(self->storage);
+            switch(o) {
+                case op::invoke:
+                    (*callable)();
+                    break;
+                case op::move:
+                    new (other->storage) T(std::move(*callable));
+                    callable->~T();
+                    break;
+                case op::destroy:
+                    callable->~T();
+                    break;
+            }
+        };
+    }
+    PoolTask(PoolTask&& other) noexcept: manage(nullptr) { *this = std::move(other); }
+    PoolTask& operator=(PoolTask&& other) noexcept {
+        if(this != &other) {
+            reset();
+            manage = other.manage;
+            if(manage) {
+                manage(op::move, &other, this);
+                other.manage = nullptr;
+            }
+        }
+        return *this;
+    }
+    PoolTask(const PoolTask&) = delete;
+    PoolTask& operator=(const PoolTask&) = delete;
+    ~PoolTask() { reset(); }
+
+    void operator()() { manage(op::invoke, this, nullptr); }
+
+private:
+    enum class op { invoke, move, destroy };
+
+    void reset() {
+        if(manage) {
+            manage(op::destroy, this, nullptr);
+            manage = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char storage[capacity];
+    void (*manage)(op, PoolTask*, PoolTask*);
+};
+
 class ThreadPool {
 public:
     ThreadPool(size_t);
+    // the start hook runs on every worker with its index before it takes any task
+    ThreadPool(size_t, std::function<void(size_t)> start);
     template<class F, class... Args>
     auto enqueue(F&& f, Args&&... args)
     -> std::future<typename std::result_of<F(Args...)>::type>;
+    // fire-and-forget enqueue, the task and its arguments are stored inline without any allocation
+    template<class F, class... Args>
+    void post(F&& f, Args&&... args);
+    // fire-and-forget enqueue onto the deque of the given worker, idle workers may still steal it
+    template<class F, class... Args>
+    void post_to(size_t worker, F&& f, Args&&... args);
     void finish();
+    // number of workers
+    size_t size() const;
+    // worker index of the calling thread or -1 if it does not belong to this pool
+    long current_worker() const;
 
 private:
+    // deque owned by a single worker, the owner works LIFO on the back while thieves take from the front.
+    // Implemented as a growing ring buffer so pushing does not allocate once the capacity is reached.
+    struct worker_queue {
+        std::mutex lock;
+        std::vector<PoolTask> ring;
+        size_t head = 0;
+        size_t count = 0;
+
+        bool empty() const { return count == 0; }
+        void push_back(PoolTask&& task) {
+            if(count == ring.size()) {
+                std::vector<PoolTask> grown(ring.empty() ? 64 : 2 * ring.size());
+                for(size_t k = 0; k < count; ++k)
+                    grown[k] = std::move(ring[(head + k) % ring.size()]);
+                ring = std::move(grown);
+                head = 0;
+            }
+            ring[(head + count++) % ring.size()] = std::move(task);
+        }
+        PoolTask pop_back() {
+            return std::move(ring[(head + --count) % ring.size()]);
+        }
+        PoolTask pop_front() {
+            PoolTask task = std::move(ring[head]);
+            head = (head + 1) % ring.size();
+            --count;
+            return task;
+        }
+    };
+
     // need to keep track of threads so we can join them
     std::vector< std::thread > workers;
-    // the task queue
-    std::queue< std::function<void()> > tasks;
+    // the per worker task deques
+    std::vector< std::unique_ptr<worker_queue> > queues;
+    // number of tasks sitting in any of the deques
+    std::atomic<size_t> pending;
+    // number of workers currently waiting for work
+    std::atomic<size_t> sleeping;
+    // round robin target for tasks enqueued from outside the pool
+    std::atomic<size_t> next_queue;
 
-    // synchronization
-    std::mutex queue_mutex;
+    // synchronization, only used for putting idle workers to sleep
+    std::mutex sleep_mutex;
     std::condition_variable condition;
-    bool stop;
+    std::atomic<bool> stop;
+    // hook run by every worker before its main loop
+    std::function<void(size_t)> start;
+
+    // take a task from the own deque or steal one from the others
+    bool take(size_t index, uint64_t& seed, PoolTask& task);
+    // push a task onto the deque of the calling worker or distribute it round robin
+    void push(PoolTask&& task);
+    // push a task onto the deque with the given index
+    void push_to(size_t index, PoolTask&& task);
+    // main loop of every worker
+    void run(size_t index);
+};
+
+// Identifies the pool and index of a worker thread, used for pushing spawned tasks locally
+struct ThreadPoolWorker {
+    static const ThreadPool*& pool() {
+        static thread_local const ThreadPool* current = nullptr;
+        return current;
+    }
+    static size_t& index() {
+        static thread_local size_t current = 0;
+        return current;
+    }
 };
 
 // the constructor just launches some amount of workers
 inline ThreadPool::ThreadPool(size_t threads)
-        :   stop(false) {
+        :   ThreadPool(threads, nullptr) {}
+
+inline ThreadPool::ThreadPool(size_t threads, std::function<void(size_t)> start)
+        :   pending(0), sleeping(0), next_queue(0), stop(false), start(std::move(start)) {
+    for(size_t i = 0;i<threads;++i)
+        queues.emplace_back(new worker_queue());
     for(size_t i = 0;i<threads;++i)
-        workers.emplace_back(
-                [this] {
-                    for(;;)
-                    {
-                        std::function<void()> task;
-
-                        {
-                            std::unique_lock<std::mutex> lock(this->queue_mutex);
-                            this->condition.wait(lock,
-                                                 [this]{ return this->stop || !this->tasks.empty(); });
-                            if(this->stop && this->tasks.empty())
-                                return;
-                            task = std::move(this->tasks.front());
-                            this->tasks.pop();
-                        }
-
-                        task();
-                    }
-                }
-        );
+        workers.emplace_back(&ThreadPool::run, this, i);
+}
+
+inline size_t ThreadPool::size() const {
+    return workers.size();
+}
+
+inline long ThreadPool::current_worker() const {
+    return ThreadPoolWorker::pool() == this ? static_cast<long>(ThreadPoolWorker::index()) : -1;
+}
+
+inline bool ThreadPool::take(size_t index, uint64_t& seed, PoolTask& task) {
+    // Own deque first, most recently spawned tasks are the most cache friendly ones
+    {
+        worker_queue& own = *queues[index];
+        std::lock_guard<std::mutex> lock(own.lock);
+        if(!own.empty()) {
+            task = own.pop_back();
+            return true;
+        }
+    }
+    // Steal the oldest task of a randomly chosen victim, fall back to the others
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    for(size_t k = 0; k < queues.size(); ++k) {
+        worker_queue& victim = *queues[(seed + k) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.lock);
+        if(!victim.empty()) {
+            task = victim.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+inline void ThreadPool::run(size_t index) {
+    ThreadPoolWorker::pool() = this;
+    ThreadPoolWorker::index() = index;
+    if(start)
+        start(index);
+    uint64_t seed = 0x9e3779b97f4a7c15 * (index + 1);
+    for(;;)
+    {
+        PoolTask task;
+        if(take(index, seed, task)) {
+            --pending;
+            task();
+            continue;
+        }
+        // Nothing to do, sleep until new work arrives
+        std::unique_lock<std::mutex> lock(this->sleep_mutex);
+        ++sleeping;
+        this->condition.wait(lock,
+                             [this]{ return this->stop || this->pending > 0; });
+        --sleeping;
+        if(this->stop && this->pending == 0)
+            return;
+    }
 }
 
 // add new work item to the pool
@@ -94,24 +281,58 @@ auto ThreadPool::enqueue(F&& f, Args&&... args)
     );
 
     std::future<return_type> res = task->get_future();
-    {
-        std::unique_lock<std::mutex> lock(queue_mutex);
+    push(PoolTask([task](){ (*task)(); }));
+    return res;
+}
 
-        // don't allow enqueueing after stopping the pool
-        if(stop)
-            throw std::runtime_error("enqueue on stopped ThreadPool");
+// add new work item to the pool without a way of waiting for it
+template<class F, class... Args>
+void ThreadPool::post(F&& f, Args&&... args)
+{
+    push(PoolTask([f = std::forward<F>(f), args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+        std::apply(f, args);
+    }));
+}
 
-        tasks.emplace([task](){ (*task)(); });
+// add new work item to the deque of a specific worker
+template<class F, class... Args>
+void ThreadPool::post_to(size_t worker, F&& f, Args&&... args)
+{
+    push_to(worker % queues.size(),
+            PoolTask([f = std::forward<F>(f), args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+        std::apply(f, args);
+    }));
+}
+
+inline void ThreadPool::push(PoolTask&& task)
+{
+    // Subtasks spawned by a worker stay local, others get distributed round robin
+    long own = current_worker();
+    push_to(own >= 0 ? static_cast<size_t>(own) : next_queue++ % queues.size(), std::move(task));
+}
+
+inline void ThreadPool::push_to(size_t index, PoolTask&& task)
+{
+    // don't allow enqueueing after stopping the pool
+    if(stop)
+        throw std::runtime_error("enqueue on stopped ThreadPool");
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->lock);
+        queues[index]->push_back(std::move(task));
+    }
+    ++pending;
+    // Only wake up sleepers if there are any, the lock prevents lost wake ups
+    if(sleeping > 0) {
+        { std::lock_guard<std::mutex> lock(sleep_mutex); }
+        condition.notify_one();
     }
-    condition.notify_one();
-    return res;
 }
 
 // Finish up the work of all threads, modified destructor
 inline void ThreadPool::finish()
 {
     {
-        std::unique_lock<std::mutex> lock(queue_mutex);
+        std::unique_lock<std::mutex> lock(sleep_mutex);
         stop = true;
     }
     condition.notify_all();
@@ -119,4 +340,4 @@ inline void ThreadPool::finish()
         worker.join();
 }
 
-#endif
\ No newline at end of file
+#endif
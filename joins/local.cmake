@@ -6,9 +6,32 @@ set(SRC_LIB_H
         "${CMAKE_SOURCE_DIR}/joins/include/algorithms/nop_join.h"
         "${CMAKE_SOURCE_DIR}/joins/include/algorithms/radix_join.h"
         "${CMAKE_SOURCE_DIR}/joins/include/algorithms/nop_join_mt.h"
+        "${CMAKE_SOURCE_DIR}/joins/include/algorithms/group_join.h"
+        "${CMAKE_SOURCE_DIR}/joins/include/algorithms/radix_partitioner.h"
+        "${CMAKE_SOURCE_DIR}/joins/include/algorithms/composite_join_mt.h"
+        "${CMAKE_SOURCE_DIR}/joins/include/algorithms/fingerprint_join.h"
+        "${CMAKE_SOURCE_DIR}/joins/include/algorithms/string_arena.h"
+        "${CMAKE_SOURCE_DIR}/joins/include/algorithms/string_join_mt.h"
+        "${CMAKE_SOURCE_DIR}/joins/include/algorithms/band_join_mt.h"
         "${CMAKE_SOURCE_DIR}/joins/include/algorithms/hash_helpers.h"
+        "${CMAKE_SOURCE_DIR}/joins/include/algorithms/page_allocator.h"
+        "${CMAKE_SOURCE_DIR}/joins/include/algorithms/spill_file.h"
+        "${CMAKE_SOURCE_DIR}/joins/include/algorithms/grace_join.h"
+        "${CMAKE_SOURCE_DIR}/joins/include/algorithms/relation_file.h"
+        "${CMAKE_SOURCE_DIR}/joins/include/algorithms/async_reader.h"
+        "${CMAKE_SOURCE_DIR}/joins/include/algorithms/symmetric_join.h"
+        "${CMAKE_SOURCE_DIR}/joins/include/algorithms/hash_index.h"
+        "${CMAKE_SOURCE_DIR}/joins/include/algorithms/dynamic_hash_table.h"
+        "${CMAKE_SOURCE_DIR}/joins/include/algorithms/executor.h"
+        "${CMAKE_SOURCE_DIR}/joins/include/algorithms/numa.h"
+        "${CMAKE_SOURCE_DIR}/joins/include/algorithms/numa_hash_table.h"
+        "${CMAKE_SOURCE_DIR}/joins/include/algorithms/join_planner.h"
+        "${CMAKE_SOURCE_DIR}/joins/include/algorithms/join_optimizer.h"
+        "${CMAKE_SOURCE_DIR}/joins/include/algorithms/calibration.h"
         "${CMAKE_SOURCE_DIR}/joins/include/algorithms/mt_radix/radix_join_mt.h"
         "${CMAKE_SOURCE_DIR}/joins/include/algorithms/mt_radix/radix_tasks.h"
+        "${CMAKE_SOURCE_DIR}/joins/include/algorithms/mt_radix/group_join_mt.h"
+        "${CMAKE_SOURCE_DIR}/joins/include/algorithms/mt_radix/radix_aggregation_mt.h"
         "${CMAKE_SOURCE_DIR}/joins/lib/ThreadPool.h"
         "${CMAKE_SOURCE_DIR}/joins/include/generators/uniform_generator.h"
         "${CMAKE_SOURCE_DIR}/joins/include/generators/incremental_generator.h"
@@ -19,8 +42,30 @@ set(SRC_LIB_CC
         "${CMAKE_SOURCE_DIR}/joins/src/algorithms/nop_join.cpp"
         "${CMAKE_SOURCE_DIR}/joins/src/algorithms/radix_join.cpp"
         "${CMAKE_SOURCE_DIR}/joins/src/algorithms/nop_join_mt.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/src/algorithms/group_join.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/src/algorithms/radix_partitioner.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/src/algorithms/composite_join_mt.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/src/algorithms/string_arena.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/src/algorithms/string_join_mt.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/src/algorithms/band_join_mt.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/src/algorithms/page_allocator.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/src/algorithms/spill_file.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/src/algorithms/grace_join.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/src/algorithms/relation_file.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/src/algorithms/async_reader.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/src/algorithms/symmetric_join.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/src/algorithms/hash_index.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/src/algorithms/dynamic_hash_table.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/src/algorithms/executor.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/src/algorithms/numa.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/src/algorithms/numa_hash_table.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/src/algorithms/join_planner.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/src/algorithms/join_optimizer.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/src/algorithms/calibration.cpp"
         "${CMAKE_SOURCE_DIR}/joins/src/algorithms/mt_radix/radix_join_mt.cpp"
         "${CMAKE_SOURCE_DIR}/joins/src/algorithms/mt_radix/radix_tasks.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/src/algorithms/mt_radix/group_join_mt.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/src/algorithms/mt_radix/radix_aggregation_mt.cpp"
         "${CMAKE_SOURCE_DIR}/joins/src/generators/uniform_generator.cpp"
         "${CMAKE_SOURCE_DIR}/joins/src/generators/incremental_generator.cpp"
         "${CMAKE_SOURCE_DIR}/joins/src/generators/zipf_generator.cpp"
@@ -35,6 +80,25 @@ set(TEST_LIB_CC
         "${CMAKE_SOURCE_DIR}/joins/test/algorithms/nop_join_mt_test.cpp"
         "${CMAKE_SOURCE_DIR}/joins/test/algorithms/radix_join_test.cpp"
         "${CMAKE_SOURCE_DIR}/joins/test/algorithms/radix_join_mt_test.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/test/algorithms/group_join_test.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/test/algorithms/group_join_mt_test.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/test/algorithms/radix_aggregation_mt_test.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/test/algorithms/radix_partitioner_test.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/test/algorithms/composite_join_mt_test.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/test/algorithms/string_join_mt_test.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/test/algorithms/band_join_mt_test.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/test/lib/thread_pool_test.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/test/algorithms/executor_test.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/test/algorithms/join_planner_test.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/test/algorithms/join_optimizer_test.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/test/algorithms/calibration_test.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/test/algorithms/numa_test.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/test/algorithms/page_allocator_test.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/test/algorithms/grace_join_test.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/test/algorithms/relation_file_test.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/test/algorithms/symmetric_join_test.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/test/algorithms/hash_index_test.cpp"
+        "${CMAKE_SOURCE_DIR}/joins/test/algorithms/dynamic_hash_table_test.cpp"
     )
 
 # ---------------------------------------------------------------------------
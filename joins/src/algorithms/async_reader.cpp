@@ -0,0 +1,88 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "algorithms/async_reader.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace helpers {
+
+    async_reader::async_reader(const std::string& path, uint64_t offset, uint64_t bytes, void* target,
+                               uint64_t chunk_bytes, uint32_t depth):
+            fd(-1), offset(offset), bytes(bytes), target(static_cast<char*>(target)),
+            chunk_bytes(std::max<uint64_t>(chunk_bytes, 1)), chunks(0), next(0), prefix(0) {
+        chunks = (bytes + this->chunk_bytes - 1) / this->chunk_bytes;
+        done.assign(chunks, false);
+        fd = open(path.c_str(), O_RDONLY);
+        if(fd < 0){
+            throw std::runtime_error("Could not open " + path + ": " + std::strerror(errno));
+        }
+        uint64_t threads = std::min<uint64_t>(std::max<uint32_t>(depth, 1), chunks);
+        for(uint64_t k = 0; k < threads; ++k){
+            workers.emplace_back(&async_reader::run, this);
+        }
+    }
+
+    async_reader::~async_reader() {
+        for(auto& worker: workers){
+            worker.join();
+        }
+        close(fd);
+    }
+
+    void async_reader::run() {
+        for(uint64_t chunk = next++; chunk < chunks; chunk = next++){
+            uint64_t start = chunk * chunk_bytes;
+            uint64_t remaining = std::min(chunk_bytes, bytes - start);
+            std::string failure;
+            while(remaining > 0){
+                ssize_t read = pread(fd, target + start, remaining, static_cast<off_t>(offset + start));
+                if(read < 0 && errno == EINTR){
+                    continue;
+                }
+                if(read <= 0){
+                    failure = read == 0 ? "Unexpected end of file" : std::strerror(errno);
+                    break;
+                }
+                start += read;
+                remaining -= read;
+            }
+            std::lock_guard<std::mutex> guard(lock);
+            if(!failure.empty()){
+                error = failure;
+                // Stop the other threads, consumers wake up and throw
+                next = chunks;
+                arrived.notify_all();
+                return;
+            }
+            done[chunk] = true;
+            while(prefix < chunks && done[prefix]){
+                ++prefix;
+            }
+            arrived.notify_all();
+        }
+    }
+
+    void async_reader::wait(uint64_t start, uint64_t end) {
+        if(end <= start || start >= bytes){
+            return;
+        }
+        uint64_t last = (std::min(end, bytes) - 1) / chunk_bytes;
+        std::unique_lock<std::mutex> guard(lock);
+        arrived.wait(guard, [&]{ return !error.empty() || prefix > last || std::all_of(
+                done.begin() + start / chunk_bytes, done.begin() + last + 1, [](bool flag){ return flag; }); });
+        if(!error.empty()){
+            throw std::runtime_error("Could not read input: " + error);
+        }
+    }
+
+    void async_reader::wait_all() {
+        wait(0, bytes);
+    }
+
+}  // namespace helpers
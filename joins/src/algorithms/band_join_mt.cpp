@@ -0,0 +1,168 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "algorithms/band_join_mt.h"
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace algorithms {
+
+    band_join_mt::band_join_mt(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r, uint64_t band):
+            band_join_mt(left, right, size_l, size_r, band, 4, 256) {}
+
+    band_join_mt::band_join_mt(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r, uint64_t band,
+                               uint8_t threads, uint32_t partitions):
+            left(left), right(right), size_l(size_l), size_r(size_r), band(band), threads(threads),
+            partitions(partitions > 0 ? partitions : 1), built(false),
+            exec(&helpers::executor::global()), result(this->partitions) {}
+
+    std::vector<uint64_t> band_join_mt::splitters() {
+        uint64_t sample_size = std::min<uint64_t>(size_l, static_cast<uint64_t>(partitions) * 64);
+        std::vector<uint64_t> sample(sample_size);
+        for(uint64_t k = 0; k < sample_size; ++k){
+            sample[k] = std::get<0>(left[k * (size_l / sample_size)]);
+        }
+        std::sort(sample.begin(), sample.end());
+        std::vector<uint64_t> split(partitions - 1);
+        for(uint32_t p = 0; p < partitions - 1; ++p){
+            split[p] = sample[(p + 1) * sample_size / partitions];
+        }
+        return split;
+    }
+
+    void band_join_mt::execute() {
+        built = true;
+        // No results on empty datasets
+        if(size_l == 0 || size_r == 0){
+            return;
+        }
+        std::vector<uint64_t> split = splitters();
+        // Partition p holds the left keys within [split[p - 1], split[p])
+        auto part_of = [&split](uint64_t key){
+            return static_cast<uint64_t>(std::upper_bound(split.begin(), split.end(), key) - split.begin());
+        };
+        // Values matching the given key, [key - band, key + band] clamped to the value domain
+        auto window = [this](uint64_t key){
+            uint64_t max = std::numeric_limits<uint64_t>::max();
+            return std::make_pair(key >= band ? key - band : 0, key <= max - band ? key + band : max);
+        };
+        // A right tuple has to be sent to all partitions overlapping its window
+        auto band_of = [&window, &part_of](uint64_t key){
+            auto win = window(key);
+            return std::make_pair(part_of(win.first), part_of(win.second));
+        };
+        helpers::executor::ticket admission(*exec, threads);
+        // Joins running concurrently may leave fewer workers than requested, the inputs get one chunk per grant
+        auto workers = static_cast<uint8_t>(admission.granted());
+        helpers::executor::task_group tasks(*exec);
+        uint64_t range_l = size_l / workers;
+        uint64_t range_r = size_r / workers;
+        // Histograms of every chunk, right tuples are counted once per partition they are replicated into
+        std::vector<std::vector<uint64_t>> hist_l(workers, std::vector<uint64_t>(partitions));
+        std::vector<std::vector<uint64_t>> hist_r(workers, std::vector<uint64_t>(partitions));
+        auto chunk = [](uint64_t range, uint64_t size, uint8_t t, uint8_t chunks){
+            return std::make_pair(t * range, t == chunks - 1 ? size : (t + 1) * range);
+        };
+        for(uint8_t t = 0; t < workers; ++t){
+            tasks.post([&, t]{
+                auto cl = chunk(range_l, size_l, t, workers);
+                for(uint64_t k = cl.first; k < cl.second; ++k){
+                    ++hist_l[t][part_of(std::get<0>(left[k]))];
+                }
+                auto cr = chunk(range_r, size_r, t, workers);
+                for(uint64_t k = cr.first; k < cr.second; ++k){
+                    auto parts = band_of(std::get<0>(right[k]));
+                    for(uint64_t p = parts.first; p <= parts.second; ++p){
+                        ++hist_r[t][p];
+                    }
+                }
+            });
+        }
+        tasks.wait();
+        // Turn the histograms into the write offsets of every chunk, partition by partition
+        std::vector<uint64_t> bounds_l(partitions + 1);
+        std::vector<uint64_t> bounds_r(partitions + 1);
+        uint64_t sum_l = 0;
+        uint64_t sum_r = 0;
+        for(uint32_t p = 0; p < partitions; ++p){
+            bounds_l[p] = sum_l;
+            bounds_r[p] = sum_r;
+            for(uint8_t t = 0; t < workers; ++t){
+                uint64_t temp_l = hist_l[t][p];
+                uint64_t temp_r = hist_r[t][p];
+                hist_l[t][p] = sum_l;
+                hist_r[t][p] = sum_r;
+                sum_l += temp_l;
+                sum_r += temp_r;
+            }
+        }
+        bounds_l[partitions] = sum_l;
+        bounds_r[partitions] = sum_r;
+        // Scatter both sides, the right target grows by the replicated boundary tuples
+        std::unique_ptr<tuple[]> target_l(new tuple[sum_l]);
+        std::unique_ptr<tuple[]> target_r(new tuple[sum_r]);
+        for(uint8_t t = 0; t < workers; ++t){
+            tasks.post([&, t]{
+                auto cl = chunk(range_l, size_l, t, workers);
+                for(uint64_t k = cl.first; k < cl.second; ++k){
+                    target_l[hist_l[t][part_of(std::get<0>(left[k]))]++] = left[k];
+                }
+                auto cr = chunk(range_r, size_r, t, workers);
+                for(uint64_t k = cr.first; k < cr.second; ++k){
+                    auto parts = band_of(std::get<0>(right[k]));
+                    for(uint64_t p = parts.first; p <= parts.second; ++p){
+                        target_r[hist_r[t][p]++] = right[k];
+                    }
+                }
+            });
+        }
+        tasks.wait();
+        // Join every partition by sorting its left side and scanning the band of every right tuple
+        std::atomic<uint32_t> cursor(0);
+        for(uint8_t t = 0; t < workers; ++t){
+            tasks.post([&]{
+                for(uint32_t p = cursor++; p < partitions; p = cursor++){
+                    if(bounds_l[p] == bounds_l[p + 1] || bounds_r[p] == bounds_r[p + 1]){
+                        continue;
+                    }
+                    tuple* part_l = target_l.get() + bounds_l[p];
+                    tuple* end_l = target_l.get() + bounds_l[p + 1];
+                    std::sort(part_l, end_l);
+                    auto& out = result[p];
+                    for(uint64_t k = bounds_r[p]; k < bounds_r[p + 1]; ++k){
+                        auto win = window(std::get<0>(target_r[k]));
+                        tuple* curr = std::lower_bound(part_l, end_l, tuple(win.first, 0));
+                        for(; curr != end_l && std::get<0>(*curr) <= win.second; ++curr){
+                            out.emplace_back(std::get<0>(*curr), std::get<1>(*curr), std::get<1>(target_r[k]));
+                        }
+                    }
+                }
+            });
+        }
+        // Wait for all partition joins
+        tasks.wait();
+    }
+
+    std::vector<std::vector<band_join_mt::triple>>& band_join_mt::get() {
+        if(!built){
+            throw std::logic_error("Join must be performed before querying results.");
+        }
+        return result;
+    }
+
+    void band_join_mt::set(std::vector<std::vector<band_join_mt::triple>> &res_vec) {
+        // The vector is moved for maximum performance. The vector cannot be used by the caller afterwards.
+        result = std::move(res_vec);
+        // Set built to false again, since data was not built into the new vector
+        built = false;
+    }
+
+    void band_join_mt::set_executor(helpers::executor& exec) {
+        this->exec = &exec;
+    }
+
+}  // namespace algorithms
@@ -0,0 +1,157 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "algorithms/calibration.h"
+#include "algorithms/executor.h"
+#include "algorithms/mt_radix/radix_join_mt.h"
+#include "generators/incremental_generator.h"
+#include "generators/uniform_generator.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace algorithms {
+
+    namespace {
+
+        /// Fastest of 'repetitions' radix joins with the given parameters in seconds
+        double time_radix(const std::vector<calibration::tuple>& left, const std::vector<calibration::tuple>& right,
+                          helpers::executor& exec, uint8_t threads, uint32_t repetitions, uint8_t bits,
+                          uint8_t passes, double table_size) {
+            double best = std::numeric_limits<double>::max();
+            for(uint32_t run = 0; run < repetitions; ++run){
+                // Private copies, multi pass radix joins use their input as scratch space
+                auto l = left;
+                auto r = right;
+                radix_join_mt join(l.data(), r.data(), l.size(), r.size(), table_size, threads, bits, passes);
+                join.set_executor(exec);
+                // Fixed threshold so the automatic skew handling does not depend on the fanout under test
+                join.set_skew_threshold(std::numeric_limits<uint64_t>::max());
+                auto start = std::chrono::steady_clock::now();
+                join.execute();
+                std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                best = std::min(best, elapsed.count());
+            }
+            return best;
+        }
+
+    }  // namespace
+
+    calibration::calibration(std::vector<calibration_entry> entries): brackets(std::move(entries)) {
+        std::sort(brackets.begin(), brackets.end(), [](const calibration_entry& a, const calibration_entry& b){
+            return a.max_build < b.max_build;
+        });
+    }
+
+    calibration calibration::measure(const std::vector<uint64_t>& brackets, uint8_t threads,
+                                     uint32_t repetitions) {
+        helpers::executor exec(std::max<uint8_t>(threads, 1));
+        repetitions = std::max<uint32_t>(repetitions, 1);
+        std::vector<calibration_entry> entries;
+        for(uint64_t size: brackets){
+            generators::incremental_generator gen_l(1, size);
+            gen_l.build();
+            auto left = gen_l.get_vec_copy();
+            generators::uniform_generator gen_r(0, size > 0 ? size - 1 : 0, size, 0);
+            gen_r.build();
+            auto right = gen_r.get_vec_copy();
+            // Partitions should keep at least 64 tuples on average
+            auto max_total = static_cast<uint8_t>(std::max(std::log2(std::max<double>(size, 1)) - 6, 1.0));
+            calibration_entry best{size, 1, 1, 1.5};
+            double best_time = std::numeric_limits<double>::max();
+            for(uint8_t passes = 1; passes <= 2; ++passes){
+                for(uint8_t bits = 1; bits * passes <= max_total && bits <= 12; ++bits){
+                    double time = time_radix(left, right, exec, threads, repetitions, bits, passes, 1.5);
+                    if(time < best_time){
+                        best_time = time;
+                        best.bits_per_pass = bits;
+                        best.passes = passes;
+                    }
+                }
+            }
+            // Table size trades bucket chains against the partitions' cache footprint, it sizes every leaf table
+            for(double table_size: {0.5, 1.0, 2.0}){
+                double time = time_radix(left, right, exec, threads, repetitions, best.bits_per_pass, best.passes,
+                                         table_size);
+                if(time < best_time){
+                    best_time = time;
+                    best.table_size = table_size;
+                }
+            }
+            entries.push_back(best);
+        }
+        return calibration(std::move(entries));
+    }
+
+    calibration calibration::load(const std::string& path) {
+        std::ifstream in(path);
+        if(!in){
+            return calibration();
+        }
+        std::vector<calibration_entry> entries;
+        std::string line;
+        while(std::getline(in, line)){
+            if(line.empty() || line[0] == '#'){
+                continue;
+            }
+            std::istringstream fields(line);
+            uint64_t max_build;
+            uint32_t bits;
+            uint32_t passes;
+            double table_size;
+            if(!(fields >> max_build >> bits >> passes >> table_size) || bits == 0 || passes == 0 ||
+               table_size <= 0){
+                throw std::runtime_error("Malformed calibration entry in " + path + ": " + line);
+            }
+            entries.push_back({max_build, static_cast<uint8_t>(bits), static_cast<uint8_t>(passes), table_size});
+        }
+        return calibration(std::move(entries));
+    }
+
+    void calibration::save(const std::string& path) const {
+        std::ofstream out(path);
+        out << "# max_build bits_per_pass passes table_size\n";
+        for(auto& entry: brackets){
+            out << entry.max_build << " " << static_cast<uint32_t>(entry.bits_per_pass) << " "
+                << static_cast<uint32_t>(entry.passes) << " " << entry.table_size << "\n";
+        }
+        if(!out){
+            throw std::runtime_error("Could not write calibration file " + path);
+        }
+    }
+
+    const calibration& calibration::host() {
+        static const calibration instance = []{
+            const char* path = std::getenv(path_variable);
+            try {
+                return load(path != nullptr ? path : default_path);
+            } catch(const std::runtime_error&){
+                // A broken file must not take down every join, the static defaults apply instead
+                return calibration();
+            }
+        }();
+        return instance;
+    }
+
+    const calibration_entry* calibration::lookup(uint64_t size_l) const {
+        if(brackets.empty()){
+            return nullptr;
+        }
+        auto it = std::lower_bound(brackets.begin(), brackets.end(), size_l,
+                                   [](const calibration_entry& entry, uint64_t size){
+            return entry.max_build < size;
+        });
+        return it == brackets.end() ? &brackets.back() : &*it;
+    }
+
+    const std::vector<calibration_entry>& calibration::entries() const {
+        return brackets;
+    }
+
+}  // namespace algorithms
@@ -0,0 +1,72 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "algorithms/composite_join_mt.h"
+#include "algorithms/fingerprint_join.h"
+#include <stdexcept>
+#include <utility>
+
+namespace algorithms {
+
+    composite_join_mt::composite_join_mt(std::vector<const uint64_t*> left, std::vector<const uint64_t*> right,
+                                         uint64_t size_l, uint64_t size_r):
+            composite_join_mt(std::move(left), std::move(right), size_l, size_r, 1.5, 4, 0, 0) {}
+
+    composite_join_mt::composite_join_mt(std::vector<const uint64_t*> left, std::vector<const uint64_t*> right,
+                                         uint64_t size_l, uint64_t size_r, double table_size, uint8_t threads,
+                                         uint8_t bits_per_pass, uint8_t passes):
+            left(std::move(left)), right(std::move(right)), size_l(size_l), size_r(size_r), table_size(table_size),
+            threads(threads), bits_per_pass(bits_per_pass), passes(passes), built(false),
+            exec(&helpers::executor::global()), result(threads) {
+        if(this->left.size() != this->right.size() || this->left.empty()){
+            throw std::invalid_argument("Both relations need the same, non-zero number of key columns.");
+        }
+    }
+
+    void composite_join_mt::execute() {
+        built = true;
+        // No results on empty datasets
+        if(size_l == 0 || size_r == 0){
+            return;
+        }
+        uint64_t columns = left.size();
+        // Reduce the rows of both sides to (fingerprint, row) tuples
+        std::vector<helpers::tuple> hashed_l(size_l);
+        std::vector<helpers::tuple> hashed_r(size_r);
+        fingerprint::rows(hashed_l.data(), size_l, threads, *exec, [this, columns](uint64_t row){
+            return helpers::composite_hash(left.data(), columns, row);
+        });
+        fingerprint::rows(hashed_r.data(), size_r, threads, *exec, [this, columns](uint64_t row){
+            return helpers::composite_hash(right.data(), columns, row);
+        });
+        // Join on the fingerprints, then compare the full keys of all candidates
+        fingerprint::join(hashed_l.data(), hashed_r.data(), size_l, size_r, table_size, threads, bits_per_pass,
+                          passes, *exec, [this, columns](uint64_t row_l, uint64_t row_r){
+            uint64_t c = 0;
+            while(c < columns && left[c][row_l] == right[c][row_r]){
+                ++c;
+            }
+            return c == columns;
+        }, result);
+    }
+
+    std::vector<std::vector<composite_join_mt::pair>>& composite_join_mt::get() {
+        if(!built){
+            throw std::logic_error("Join must be performed before querying results.");
+        }
+        return result;
+    }
+
+    void composite_join_mt::set(std::vector<std::vector<composite_join_mt::pair>> &res_vec) {
+        // The vector is moved for maximum performance. The vector cannot be used by the caller afterwards.
+        result = std::move(res_vec);
+        // Set built to false again, since data was not built into the new vector
+        built = false;
+    }
+
+    void composite_join_mt::set_executor(helpers::executor& exec) {
+        this->exec = &exec;
+    }
+
+}  // namespace algorithms
@@ -0,0 +1,325 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "algorithms/dynamic_hash_table.h"
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+namespace algorithms {
+
+    namespace {
+
+        /// Rid of a slot which never held a tuple or whose tuple was shifted away
+        constexpr uint64_t empty_rid = helpers::null_rid;
+        /// Rid of a deleted slot in a table which is being moved over
+        constexpr uint64_t dead_rid = helpers::null_rid - 1;
+
+    }  // namespace
+
+    dynamic_hash_table::table::table(uint64_t slots): mask(slots - 1), slots(new slot[slots]), used(0) {
+        for(uint64_t k = 0; k < slots; ++k){
+            this->slots[k].key.store(0, std::memory_order_relaxed);
+            this->slots[k].rid.store(empty_rid, std::memory_order_relaxed);
+        }
+    }
+
+    dynamic_hash_table::dynamic_hash_table(): dynamic_hash_table(0) {}
+
+    dynamic_hash_table::dynamic_hash_table(uint64_t capacity): sequence(0), epoch(0), active{{0}, {0}},
+                                                                retired_epoch(0), previous_view(nullptr),
+                                                                moved(0), stored(0), retries(0) {
+        // The table grows once it is half full
+        uint64_t slots = min_slots;
+        while(slots < 2 * capacity){
+            slots <<= 1;
+        }
+        current = std::make_unique<table>(slots);
+        current_view.store(current.get(), std::memory_order_release);
+    }
+
+    dynamic_hash_table::dynamic_hash_table(const tuple* data, uint64_t size): dynamic_hash_table(size) {
+        insert(data, size);
+    }
+
+    void dynamic_hash_table::insert(const tuple& curr) {
+        insert(&curr, 1);
+    }
+
+    void dynamic_hash_table::insert(const tuple* data, uint64_t count) {
+        for(uint64_t k = 0; k < count; ++k){
+            if(std::get<1>(data[k]) > max_rid){
+                throw std::invalid_argument("Rids above dynamic_hash_table::max_rid mark empty slots.");
+            }
+        }
+        std::lock_guard<std::mutex> guard(update_lock);
+        reclaim(false);
+        // Every tuple is an update of its own, so probes do not wait for the whole batch
+        for(uint64_t k = 0; k < count; ++k){
+            // Clearing the larger table takes time linear in its size, probes must not wait for that
+            reserve();
+            begin_update();
+            place(*current, std::get<0>(data[k]), std::get<1>(data[k]));
+            stored.store(stored.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            migrate();
+            grow();
+            end_update();
+        }
+    }
+
+    bool dynamic_hash_table::erase(const tuple& curr) {
+        return erase(&curr, 1) > 0;
+    }
+
+    uint64_t dynamic_hash_table::erase(const tuple* data, uint64_t count) {
+        std::lock_guard<std::mutex> guard(update_lock);
+        reclaim(false);
+        uint64_t erased = 0;
+        for(uint64_t k = 0; k < count; ++k){
+            uint64_t key = std::get<0>(data[k]);
+            uint64_t rid = std::get<1>(data[k]);
+            begin_update();
+            bool found = remove(*current, key, rid);
+            if(!found && previous){
+                // Slots of the old table only get marked, shifting them could move them across 'moved'
+                uint64_t done = moved.load(std::memory_order_relaxed);
+                uint64_t i = helpers::murmur3(key) & previous->mask;
+                for(uint64_t n = 0; !found && n <= previous->mask; ++n, i = (i + 1) & previous->mask){
+                    uint64_t curr = previous->slots[i].rid.load(std::memory_order_relaxed);
+                    if(curr == empty_rid){
+                        break;
+                    }
+                    if(i >= done && curr == rid && previous->slots[i].key.load(std::memory_order_relaxed) == key){
+                        previous->slots[i].rid.store(dead_rid, std::memory_order_release);
+                        found = true;
+                    }
+                }
+            }
+            if(found){
+                stored.store(stored.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+                ++erased;
+            }
+            migrate();
+            end_update();
+        }
+        return erased;
+    }
+
+    void dynamic_hash_table::place(table& target, uint64_t key, uint64_t rid) {
+        uint64_t i = helpers::murmur3(key) & target.mask;
+        while(target.slots[i].rid.load(std::memory_order_relaxed) != empty_rid){
+            i = (i + 1) & target.mask;
+        }
+        target.slots[i].key.store(key, std::memory_order_release);
+        target.slots[i].rid.store(rid, std::memory_order_release);
+        ++target.used;
+    }
+
+    bool dynamic_hash_table::remove(table& target, uint64_t key, uint64_t rid) {
+        uint64_t i = helpers::murmur3(key) & target.mask;
+        while(true){
+            uint64_t curr = target.slots[i].rid.load(std::memory_order_relaxed);
+            if(curr == empty_rid){
+                return false;
+            }
+            if(curr == rid && target.slots[i].key.load(std::memory_order_relaxed) == key){
+                break;
+            }
+            i = (i + 1) & target.mask;
+        }
+        // Shift back every following tuple of the cluster whose home is not between the hole and itself
+        for(uint64_t j = (i + 1) & target.mask;; j = (j + 1) & target.mask){
+            uint64_t curr = target.slots[j].rid.load(std::memory_order_relaxed);
+            if(curr == empty_rid){
+                break;
+            }
+            uint64_t other = target.slots[j].key.load(std::memory_order_relaxed);
+            uint64_t home = helpers::murmur3(other) & target.mask;
+            if(((j - home) & target.mask) >= ((j - i) & target.mask)){
+                target.slots[i].key.store(other, std::memory_order_release);
+                target.slots[i].rid.store(curr, std::memory_order_release);
+                i = j;
+            }
+        }
+        target.slots[i].rid.store(empty_rid, std::memory_order_release);
+        --target.used;
+        return true;
+    }
+
+    void dynamic_hash_table::migrate() {
+        if(!previous){
+            return;
+        }
+        uint64_t start = moved.load(std::memory_order_relaxed);
+        uint64_t end = std::min(start + migrate_step, previous->mask + 1);
+        for(uint64_t k = start; k < end; ++k){
+            uint64_t rid = previous->slots[k].rid.load(std::memory_order_relaxed);
+            if(rid != empty_rid && rid != dead_rid){
+                place(*current, previous->slots[k].key.load(std::memory_order_relaxed), rid);
+            }
+        }
+        moved.store(end, std::memory_order_release);
+        if(end == previous->mask + 1){
+            previous_view.store(nullptr);
+            moved.store(0, std::memory_order_release);
+            retired.push_back(std::move(previous));
+            // Probes registering from now on cannot reach the old table, only the ones of this epoch can
+            retired_epoch = epoch.load(std::memory_order_relaxed);
+            epoch.store(retired_epoch + 1);
+        }
+    }
+
+    void dynamic_hash_table::reserve() {
+        if(previous || spare || 2 * (current->used + 1) <= current->mask + 1){
+            return;
+        }
+        // The next table gets retired in a later epoch, probes of this one must not be counted for it
+        reclaim(true);
+        spare = std::make_unique<table>(2 * (current->mask + 1));
+    }
+
+    void dynamic_hash_table::grow() {
+        // Every update moves migrate_step slots, so the old table is gone long before the new one is half full
+        if(previous || !spare || 2 * current->used <= current->mask + 1){
+            return;
+        }
+        previous = std::move(current);
+        current = std::move(spare);
+        moved.store(0, std::memory_order_release);
+        current_view.store(current.get(), std::memory_order_release);
+        previous_view.store(previous.get(), std::memory_order_release);
+    }
+
+    void dynamic_hash_table::reclaim(bool wait) {
+        if(retired.empty()){
+            return;
+        }
+        // Probes of later epochs register with the other counter, so this one drains even under steady probing
+        while(active[retired_epoch % 2].load() != 0){
+            if(!wait){
+                return;
+            }
+            std::this_thread::yield();
+        }
+        retired.clear();
+    }
+
+    dynamic_hash_table::reader::reader(const dynamic_hash_table& owner): active(nullptr) {
+        // A probe which read the epoch right before it moved on registers again with the new one
+        while(true){
+            uint64_t curr = owner.epoch.load();
+            owner.active[curr % 2].fetch_add(1);
+            if(owner.epoch.load() == curr){
+                active = &owner.active[curr % 2];
+                return;
+            }
+            owner.active[curr % 2].fetch_sub(1);
+        }
+    }
+
+    dynamic_hash_table::reader::~reader() {
+        active->fetch_sub(1);
+    }
+
+    void dynamic_hash_table::begin_update() {
+        // Stores of the update are releases, a probe reading one of them sees the odd number afterwards
+        sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    void dynamic_hash_table::end_update() {
+        sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool dynamic_hash_table::find(const tuple& curr, std::vector<triple>& out) const {
+        uint64_t first = out.size();
+        while(true){
+            uint64_t before = sequence.load(std::memory_order_acquire);
+            if(before % 2 == 1){
+                retries.fetch_add(1, std::memory_order_relaxed);
+                std::this_thread::yield();
+                continue;
+            }
+            lookup(*current_view.load(std::memory_order_acquire), 0, curr, out);
+            const table* old = previous_view.load(std::memory_order_acquire);
+            if(old != nullptr){
+                lookup(*old, moved.load(std::memory_order_acquire), curr, out);
+            }
+            if(sequence.load(std::memory_order_relaxed) == before){
+                return out.size() > first;
+            }
+            // An update ran meanwhile, what was read might be torn
+            retries.fetch_add(1, std::memory_order_relaxed);
+            out.resize(first);
+        }
+    }
+
+    void dynamic_hash_table::lookup(const table& source, uint64_t moved, const tuple& curr,
+                                    std::vector<triple>& out) {
+        uint64_t key = std::get<0>(curr);
+        uint64_t i = helpers::murmur3(key) & source.mask;
+        // Reads racing with an update may see no empty slot, the bound keeps them finite until they repeat
+        for(uint64_t n = 0; n <= source.mask; ++n, i = (i + 1) & source.mask){
+            uint64_t rid = source.slots[i].rid.load(std::memory_order_acquire);
+            if(rid == empty_rid){
+                break;
+            }
+            if(rid != dead_rid && i >= moved && source.slots[i].key.load(std::memory_order_acquire) == key){
+                out.emplace_back(key, rid, std::get<1>(curr));
+            }
+        }
+    }
+
+    bool dynamic_hash_table::probe(const tuple& curr, std::vector<triple>& out) const {
+        reader guard(*this);
+        return find(curr, out);
+    }
+
+    void dynamic_hash_table::probe(const tuple* data, uint64_t count, helpers::join_type type,
+                                   std::vector<triple>& out) const {
+        if(helpers::preserves_left(type)){
+            throw std::invalid_argument("Dynamic hash tables keep no match flags, they cannot preserve the table "
+                                        "side.");
+        }
+        bool outer = helpers::preserves_right(type);
+        reader guard(*this);
+        for(uint64_t k = 0; k < count; ++k){
+            if(!find(data[k], out) && outer){
+                out.emplace_back(std::get<0>(data[k]), helpers::null_rid, std::get<1>(data[k]));
+            }
+        }
+    }
+
+    uint64_t dynamic_hash_table::size() const {
+        return stored.load(std::memory_order_relaxed);
+    }
+
+    uint64_t dynamic_hash_table::capacity() const {
+        reader guard(*this);
+        return current_view.load(std::memory_order_acquire)->mask + 1;
+    }
+
+    bool dynamic_hash_table::resizing() const {
+        return previous_view.load(std::memory_order_acquire) != nullptr;
+    }
+
+    uint64_t dynamic_hash_table::memory_bytes() const {
+        std::lock_guard<std::mutex> guard(update_lock);
+        uint64_t slots = current->mask + 1;
+        if(previous){
+            slots += previous->mask + 1;
+        }
+        if(spare){
+            slots += spare->mask + 1;
+        }
+        for(auto& curr: retired){
+            slots += curr->mask + 1;
+        }
+        return slots * sizeof(slot);
+    }
+
+    uint64_t dynamic_hash_table::probe_retries() const {
+        return retries.load(std::memory_order_relaxed);
+    }
+
+}  // namespace algorithms
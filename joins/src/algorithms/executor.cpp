@@ -0,0 +1,121 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "algorithms/executor.h"
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
+
+namespace helpers {
+
+    executor::ticket::ticket(executor& exec, uint32_t parallelism):
+        exec(exec), reserved(exec.admit(parallelism))
+    {}
+
+    executor::ticket::~ticket() {
+        exec.leave(reserved);
+    }
+
+    uint32_t executor::ticket::granted() const {
+        return reserved;
+    }
+
+    executor::task_group::task_group(executor& exec): exec(exec), next_worker(exec.topology().nodes()),
+        outstanding(0)
+    {}
+
+    executor::task_group::~task_group() {
+        wait();
+    }
+
+    void executor::task_group::wait() {
+        std::unique_lock<std::mutex> guard(lock);
+        done.wait(guard, [this]{ return outstanding == 0; });
+    }
+
+    ThreadPool& executor::task_group::pool() {
+        return exec.pool();
+    }
+
+    void executor::task_group::finish_one() {
+        // Notifying under the lock keeps the group alive until the waiter can observe the counter
+        std::lock_guard<std::mutex> guard(lock);
+        if(--outstanding == 0){
+            done.notify_all();
+        }
+    }
+
+    executor::executor(uint32_t workers): executor(workers, numa_topology::detect(), false)
+    {}
+
+    executor::executor(uint32_t workers, numa_topology topology, bool pin):
+        workers(std::max<uint32_t>(workers, 1)), nodes(std::move(topology)), pin(pin),
+        node_workers(nodes.nodes()),
+        threads(this->workers, [this](size_t worker){
+            if(this->pin){
+                nodes.pin_current(nodes.cpu_of_worker(worker));
+            }
+        }),
+        next_ticket(0), serving(0), reserved(0)
+    {
+        for(size_t worker = 0; worker < this->workers; ++worker){
+            node_workers[nodes.node_of_worker(worker)].push_back(worker);
+        }
+    }
+
+    executor::~executor() {
+        threads.finish();
+    }
+
+    executor& executor::global() {
+        const char* pin = std::getenv("HASHJOINS_PIN");
+        static executor instance(std::thread::hardware_concurrency(), numa_topology::detect(),
+                                 pin != nullptr && std::atoi(pin) != 0);
+        return instance;
+    }
+
+    uint32_t executor::size() const {
+        return workers;
+    }
+
+    ThreadPool& executor::pool() {
+        return threads;
+    }
+
+    const numa_topology& executor::topology() const {
+        return nodes;
+    }
+
+    bool executor::pinned() const {
+        return pin;
+    }
+
+    const std::vector<size_t>& executor::workers_on(uint32_t node) const {
+        return node_workers[node];
+    }
+
+    uint32_t executor::admit(uint32_t parallelism) {
+        // Requests larger than the executor could never be served, they get the whole executor instead
+        uint32_t want = std::min(std::max<uint32_t>(parallelism, 1), workers);
+        std::unique_lock<std::mutex> guard(admission_lock);
+        uint64_t own = next_ticket++;
+        // Taking what is free instead of waiting for the whole request lets concurrent joins run side by side
+        admission.wait(guard, [&]{ return serving == own && reserved < workers; });
+        uint32_t granted = std::min(want, workers - reserved);
+        reserved += granted;
+        ++serving;
+        // The next one in line might fit as well
+        admission.notify_all();
+        return granted;
+    }
+
+    void executor::leave(uint32_t parallelism) {
+        {
+            std::lock_guard<std::mutex> guard(admission_lock);
+            reserved -= parallelism;
+        }
+        admission.notify_all();
+    }
+
+}  // namespace helpers
@@ -0,0 +1,285 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "algorithms/grace_join.h"
+#include "algorithms/radix_partitioner.h"
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+namespace algorithms {
+
+    namespace {
+
+        /// Every spilled partition keeps a file descriptor open, 2^9 stay well below the usual limit
+        constexpr uint8_t max_bits = 9;
+        /// Smaller spill buffers would turn the sequential writes into random ones
+        constexpr uint64_t min_buffer = static_cast<uint64_t>(1) << 16;
+
+    }  // namespace
+
+    grace_join::grace_join(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r):
+            grace_join(left, right, size_l, size_r, 1.5, 4, static_cast<uint64_t>(1) << 30,
+                       static_cast<uint64_t>(1) << 20, helpers::join_type::inner)
+    {}
+
+    grace_join::grace_join(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r, double table_size,
+                           uint8_t threads, uint64_t memory_budget, uint64_t io_buffer, helpers::join_type type):
+            left(left), right(right), size_l(size_l), size_r(size_r), table_size(table_size),
+            threads(threads > 0 ? threads : 1), memory_budget(memory_budget), io_buffer(io_buffer), type(type),
+            built(false), exec(&helpers::executor::global()), directory(helpers::default_spill_directory()),
+            result(1), workers(1), bits(0), chunk(0), buffer_bytes(0), available(0), resident(0), spilled(0)
+    {}
+
+    void grace_join::execute() {
+        built = true;
+        // No matches on empty datasets, only the preserved sides have to be emitted
+        if(size_l == 0 || size_r == 0){
+            if(result.empty()){
+                result.resize(1);
+            }
+            for(uint64_t k = 0; helpers::preserves_left(type) && size_r == 0 && k < size_l; ++k){
+                result[0].emplace_back(std::get<0>(left[k]), std::get<1>(left[k]), helpers::null_rid);
+            }
+            for(uint64_t k = 0; helpers::preserves_right(type) && size_l == 0 && k < size_r; ++k){
+                result[0].emplace_back(std::get<0>(right[k]), helpers::null_rid, std::get<1>(right[k]));
+            }
+            return;
+        }
+        // An eighth of the budget holds the partitioned chunk, the rest the partitions
+        uint64_t chunk_bytes = std::max<uint64_t>(memory_budget / 8, sizeof(tuple) << 10);
+        chunk = chunk_bytes / sizeof(tuple);
+        available = memory_budget > chunk_bytes ? memory_budget - chunk_bytes : 0;
+        // Every partition's build side may take half of the memory, the spill buffers share the other half.
+        // The fanout stops where the buffers would drop below min_buffer, so partitions get larger instead.
+        uint64_t needed = size_l * tuple_bytes();
+        bits = 0;
+        while(bits < max_bits && (needed >> bits) > available / 2 && (min_buffer << (bits + 1)) <= available / 2){
+            ++bits;
+        }
+        uint64_t count = static_cast<uint64_t>(1) << bits;
+        buffer_bytes = std::max<uint64_t>(std::min(std::max(io_buffer, min_buffer), available / 2 / count),
+                                          sizeof(tuple));
+        parts = std::vector<partition>(count);
+        // Vectors handed in through set() are kept, results get appended to them
+        if(result.size() < count){
+            result.resize(count);
+        }
+        resident = 0;
+        spilled = 0;
+        helpers::executor::ticket admission(*exec, threads);
+        // Joins running concurrently may leave fewer workers than requested
+        workers = static_cast<uint8_t>(admission.granted());
+        helpers::executor::task_group tasks(*exec);
+        // Build Phase, resident partitions get their tables once the whole relation was seen
+        stream(left, size_l, true);
+        for(auto& part: parts){
+            if(part.file){
+                part.spilled_build = part.file->size();
+                part.file->finish();
+            }
+        }
+        std::atomic<uint64_t> cursor(0);
+        for(uint8_t t = 0; t < workers; ++t){
+            tasks.post([this, &cursor]{
+                for(uint64_t p = cursor++; p < parts.size(); p = cursor++){
+                    partition& part = parts[p];
+                    if(part.file){
+                        continue;
+                    }
+                    auto length = static_cast<uint64_t>(table_size * part.build.size());
+                    part.table = std::make_unique<helpers::latched_hash_table>(std::max<uint64_t>(length, 1));
+                    for(auto& curr: part.build){
+                        part.table->insert(curr);
+                    }
+                    std::vector<tuple>().swap(part.build);
+                }
+            });
+        }
+        tasks.wait();
+        // Probe Phase, resident partitions get probed right away, the others spill their probe tuples
+        stream(right, size_r, false);
+        std::vector<uint64_t> pending;
+        for(uint64_t p = 0; p < count; ++p){
+            if(parts[p].table && helpers::preserves_left(type)){
+                parts[p].table->scan(0, parts[p].table->size, result[p]);
+            }
+            parts[p].table.reset();
+            if(parts[p].file){
+                parts[p].file->finish();
+                pending.push_back(p);
+            }
+        }
+        join_spilled(tasks, pending);
+        parts.clear();
+    }
+
+    void grace_join::join_spilled(helpers::executor::task_group& tasks, const std::vector<uint64_t>& pending) {
+        std::atomic<uint64_t> cursor(0);
+        std::mutex lock;
+        std::condition_variable released;
+        uint64_t in_use = 0;
+        for(uint8_t t = 0; t < workers; ++t){
+            tasks.post([&]{
+                for(uint64_t k = cursor++; k < pending.size(); k = cursor++){
+                    uint64_t part = pending[k];
+                    // The table and the probe block, a partition exceeding the memory on its own runs alone
+                    uint64_t needed = parts[part].spilled_build * tuple_bytes() + buffer_bytes;
+                    {
+                        std::unique_lock<std::mutex> guard(lock);
+                        released.wait(guard, [&]{ return in_use == 0 || in_use + needed <= available; });
+                        in_use += needed;
+                    }
+                    join_spilled(part);
+                    {
+                        std::lock_guard<std::mutex> guard(lock);
+                        in_use -= needed;
+                    }
+                    released.notify_all();
+                }
+            });
+        }
+        tasks.wait();
+    }
+
+    uint64_t grace_join::tuple_bytes() const {
+        // Growing the staging vector may double its tuples, the table holds another copy in its buckets
+        return 2 * sizeof(tuple) + static_cast<uint64_t>(table_size * sizeof(helpers::latched_hash_table::bucket));
+    }
+
+    void grace_join::stream(tuple* data, uint64_t size, bool build_side) {
+        helpers::page_buffer target(std::min(chunk, size) * sizeof(tuple));
+        helpers::executor::task_group tasks(*exec);
+        // The high hash bits decide the partition, the tables index with the whole hash
+        auto shift = static_cast<uint8_t>(bits > 0 ? 64 - bits : 0);
+        for(uint64_t start = 0; start < size; start += chunk){
+            uint64_t count = std::min(chunk, size - start);
+            radix_partitioner partitioner(data + start, count, shift, bits, workers, target.as<tuple>());
+            partitioner.execute(tasks);
+            const std::vector<uint64_t>& bounds = partitioner.get_bounds();
+            // Every partition of the chunk is handled by exactly one task
+            std::atomic<uint64_t> cursor(0);
+            for(uint8_t t = 0; t < workers; ++t){
+                tasks.post([&]{
+                    for(uint64_t p = cursor++; p < parts.size(); p = cursor++){
+                        consume(p, target.as<tuple>() + bounds[p], bounds[p + 1] - bounds[p], build_side);
+                    }
+                });
+            }
+            tasks.wait();
+            if(build_side){
+                evict();
+            }
+        }
+    }
+
+    void grace_join::consume(uint64_t part, const tuple* data, uint64_t count, bool build_side) {
+        partition& curr = parts[part];
+        if(count == 0){
+            return;
+        }
+        if(curr.file){
+            curr.file->append(data, count);
+        } else if(build_side){
+            curr.build.insert(curr.build.end(), data, data + count);
+            resident += count;
+        } else {
+            bool outer_l = helpers::preserves_left(type);
+            bool outer_r = helpers::preserves_right(type);
+            for(uint64_t k = 0; k < count; ++k){
+                bool found = curr.table->probe(data[k], outer_l, result[part]);
+                if(outer_r && !found){
+                    result[part].emplace_back(std::get<0>(data[k]), helpers::null_rid, std::get<1>(data[k]));
+                }
+            }
+        }
+    }
+
+    void grace_join::evict() {
+        while(resident * tuple_bytes() + spilled * buffer_bytes > available){
+            partition* victim = nullptr;
+            for(auto& part: parts){
+                if(!part.file && !part.build.empty() && (victim == nullptr || part.build.size() > victim->build.size())){
+                    victim = &part;
+                }
+            }
+            // Nothing left to spill, only the buffers of spilled partitions remain
+            if(victim == nullptr){
+                return;
+            }
+            victim->file = std::make_unique<helpers::spill_file>(directory, buffer_bytes);
+            victim->file->append(victim->build.data(), victim->build.size());
+            resident -= victim->build.size();
+            std::vector<tuple>().swap(victim->build);
+            ++spilled;
+        }
+    }
+
+    void grace_join::join_spilled(uint64_t part) {
+        partition& curr = parts[part];
+        uint64_t count_l = curr.spilled_build;
+        uint64_t count_r = curr.file->size() - count_l;
+        // Partitions were sized for half of the memory, unless the budget could not hold enough spill buffers
+        std::vector<tuple> build(count_l);
+        curr.file->read(0, count_l, build.data());
+        auto length = static_cast<uint64_t>(table_size * count_l);
+        helpers::latched_hash_table table(std::max<uint64_t>(length, 1));
+        for(auto& tup: build){
+            table.insert(tup);
+        }
+        std::vector<tuple>().swap(build);
+        // The probe side gets read back block by block
+        bool outer_l = helpers::preserves_left(type);
+        bool outer_r = helpers::preserves_right(type);
+        uint64_t block = std::max<uint64_t>(buffer_bytes / sizeof(tuple), 1);
+        std::vector<tuple> probe(std::min(block, count_r));
+        for(uint64_t start = 0; start < count_r; start += block){
+            uint64_t count = std::min(block, count_r - start);
+            curr.file->read(count_l + start, count, probe.data());
+            for(uint64_t k = 0; k < count; ++k){
+                bool found = table.probe(probe[k], outer_l, result[part]);
+                if(outer_r && !found){
+                    result[part].emplace_back(std::get<0>(probe[k]), helpers::null_rid, std::get<1>(probe[k]));
+                }
+            }
+        }
+        if(outer_l){
+            table.scan(0, table.size, result[part]);
+        }
+        curr.file.reset();
+    }
+
+    std::vector<std::vector<grace_join::triple>>& grace_join::get() {
+        if(!built){
+            throw std::logic_error("Join must be performed before querying results.");
+        }
+        return result;
+    }
+
+    void grace_join::set(std::vector<std::vector<grace_join::triple>>& res_vec) {
+        // The vector is moved for maximum performance. The vector cannot be used by the caller afterwards.
+        result = std::move(res_vec);
+        // Set built to false again, since data was not built into the new vector
+        built = false;
+    }
+
+    void grace_join::set_executor(helpers::executor& exec) {
+        this->exec = &exec;
+    }
+
+    void grace_join::set_spill_directory(const std::string& directory) {
+        this->directory = directory;
+    }
+
+    uint64_t grace_join::partitions() const {
+        return static_cast<uint64_t>(1) << bits;
+    }
+
+    uint64_t grace_join::spilled_partitions() const {
+        return spilled;
+    }
+
+}  // namespace algorithms
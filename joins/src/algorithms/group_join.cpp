@@ -0,0 +1,61 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "algorithms/group_join.h"
+#include <stdexcept>
+#include <utility>
+
+namespace algorithms{
+
+    group_join::group_join(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r):
+            group_join(left, right, size_l, size_r, 1.5){}
+
+    group_join::group_join(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r, double table_size):
+            left(left), right(right), size_l(size_l), size_r(size_r),
+            table_size(table_size), built(false), result(){}
+
+    group_join::group_join(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r,
+                           double table_size, std::vector<group>& result):
+            left(left), right(right), size_l(size_l), size_r(size_r),
+            table_size(table_size), built(false), result(std::move(result)){}
+
+    void group_join::execute() {
+        built = true;
+        // No results on empty datasets
+        if(size_l == 0 || size_r == 0){
+            return;
+        }
+        auto new_size = static_cast<uint64_t>(table_size * size_l);
+        helpers::aggregate_table table(new_size > 0 ? new_size : 1);
+        // Build Phase, duplicate keys only increase the multiplicity of their group
+        for(uint64_t k = 0; k < size_l; ++k){
+            ++table.insert(std::get<0>(left[k])).multiplicity;
+        }
+        // Probe Phase, every probe tuple updates the aggregates of its group in place
+        for(uint64_t k = 0; k < size_r; ++k){
+            tuple& curr = right[k];
+            helpers::aggregate* group = table.find(std::get<0>(curr));
+            if(group != nullptr){
+                group->update(std::get<1>(curr));
+            }
+        }
+        // Output Phase, only groups which found a join partner are emitted
+        table.collect(result);
+    }
+
+    std::vector<group_join::group>& group_join::get() {
+        if(!built){
+            throw std::logic_error("Join must be performed before querying results.");
+        }
+        return result;
+    }
+
+    void group_join::set(std::vector<group_join::group> &res_vec) {
+        // The vector is moved for maximum performance. The vector cannot be used by the caller afterwards.
+        result = std::move(res_vec);
+        // Set built to false again, since data was not built into the new vector
+        built = false;
+    }
+
+} // namespace algorithms
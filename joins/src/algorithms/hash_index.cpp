@@ -0,0 +1,249 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "algorithms/hash_index.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace algorithms {
+
+    namespace {
+
+        constexpr char index_magic[8] = "HJIDX01";
+
+        /// Leading part of an index file, offsets and tuples follow right after it
+        struct index_header {
+            char magic[8];
+            uint64_t count;
+            uint64_t buckets;
+        };
+
+        /// Bucket ranges per build thread, more ranges than threads balance skewed buckets
+        constexpr uint64_t ranges_per_thread = 64;
+
+        uint64_t bucket_count_for(uint64_t size, double table_size) {
+            return std::max<uint64_t>(static_cast<uint64_t>(table_size * size), 1);
+        }
+
+    }  // namespace
+
+    hash_index::hash_index(const tuple* data, uint64_t size): hash_index(data, size, 1.5, 1) {}
+
+    hash_index::hash_index(const tuple* data, uint64_t size, double table_size, uint8_t threads):
+            hash_index(data, size, table_size, threads, helpers::executor::global()) {}
+
+    hash_index::hash_index(const tuple* data, uint64_t size, double table_size, uint8_t threads,
+                           helpers::executor& exec):
+            count(size), bucket_count(bucket_count_for(size, table_size)), exec(&exec),
+            offsets(std::make_unique<helpers::page_buffer>((bucket_count + 1) * sizeof(uint64_t))),
+            tuples(std::make_unique<helpers::page_buffer>(size * sizeof(tuple))) {
+        offsets->as<uint64_t>()[bucket_count] = count;
+        threads = std::max<uint8_t>(threads, 1);
+        if(threads == 1 || count < default_morsel){
+            build_range(data, count, 0, bucket_count, 0);
+            return;
+        }
+        // Builds running concurrently may leave fewer workers than requested, the input gets one chunk per grant
+        helpers::executor::ticket admission(exec, threads);
+        threads = static_cast<uint8_t>(admission.granted());
+        // Ranges of buckets, the bucket b falls into the range b * ranges / bucket_count
+        uint64_t ranges = std::min(bucket_count, threads * ranges_per_thread);
+        auto range_of = [this, ranges](uint64_t key){ return bucket_of(key) * ranges / bucket_count; };
+        uint64_t chunk = (count + threads - 1) / threads;
+        std::vector<std::vector<uint64_t>> hist(threads, std::vector<uint64_t>(ranges, 0));
+        {
+            helpers::executor::task_group tasks(exec);
+            for(uint8_t t = 0; t < threads; ++t){
+                tasks.post([&, t]{
+                    uint64_t end = std::min(count, (t + 1) * chunk);
+                    for(uint64_t k = std::min(count, t * chunk); k < end; ++k){
+                        ++hist[t][range_of(std::get<0>(data[k]))];
+                    }
+                });
+            }
+            tasks.wait();
+        }
+        // Every thread writes its part of a range behind the parts of the threads before it
+        std::vector<uint64_t> starts(ranges + 1, 0);
+        uint64_t sum = 0;
+        for(uint64_t r = 0; r < ranges; ++r){
+            starts[r] = sum;
+            for(uint8_t t = 0; t < threads; ++t){
+                uint64_t tmp = hist[t][r];
+                hist[t][r] = sum;
+                sum += tmp;
+            }
+        }
+        starts[ranges] = sum;
+        helpers::page_buffer scratch(count * sizeof(tuple));
+        auto partitioned = scratch.as<tuple>();
+        {
+            helpers::executor::task_group tasks(exec);
+            for(uint8_t t = 0; t < threads; ++t){
+                tasks.post([&, t]{
+                    uint64_t end = std::min(count, (t + 1) * chunk);
+                    for(uint64_t k = std::min(count, t * chunk); k < end; ++k){
+                        partitioned[hist[t][range_of(std::get<0>(data[k]))]++] = data[k];
+                    }
+                });
+            }
+            tasks.wait();
+        }
+        // Ranges cover disjoint buckets and tuples, every one is finished by a single task claiming it
+        helpers::executor::task_group tasks(exec);
+        std::atomic<uint64_t> cursor(0);
+        for(uint8_t t = 0; t < threads; ++t){
+            tasks.post([&]{
+                for(uint64_t r = cursor++; r < ranges; r = cursor++){
+                    // First bucket of range r is the smallest b with b * ranges / bucket_count >= r
+                    uint64_t first = (r * bucket_count + ranges - 1) / ranges;
+                    uint64_t last = ((r + 1) * bucket_count + ranges - 1) / ranges;
+                    build_range(partitioned + starts[r], starts[r + 1] - starts[r], first, last, starts[r]);
+                }
+            });
+        }
+        tasks.wait();
+    }
+
+    hash_index::hash_index(const std::string& path): count(0), bucket_count(0), exec(&helpers::executor::global()) {
+        std::ifstream in(path, std::ios::binary);
+        index_header head{};
+        if(!in || !in.read(reinterpret_cast<char*>(&head), sizeof(head))
+           || std::memcmp(head.magic, index_magic, sizeof(head.magic)) != 0 || head.buckets == 0){
+            throw std::runtime_error("Not a hash index file: " + path);
+        }
+        count = head.count;
+        bucket_count = head.buckets;
+        offsets = std::make_unique<helpers::page_buffer>((bucket_count + 1) * sizeof(uint64_t));
+        tuples = std::make_unique<helpers::page_buffer>(count * sizeof(tuple));
+        auto bounds = offsets->as<uint64_t>();
+        if(!in.read(reinterpret_cast<char*>(bounds), offsets->size())
+           || !in.read(reinterpret_cast<char*>(tuples->data()), tuples->size())){
+            throw std::runtime_error("Truncated hash index file: " + path);
+        }
+        // Probes trust the offsets, so a corrupt file must not get past this point
+        bool valid = bounds[0] == 0 && bounds[bucket_count] == count;
+        for(uint64_t b = 0; valid && b < bucket_count; ++b){
+            valid = bounds[b] <= bounds[b + 1];
+        }
+        if(!valid){
+            throw std::runtime_error("Corrupt hash index file: " + path);
+        }
+    }
+
+    void hash_index::build_range(const tuple* src, uint64_t count, uint64_t first, uint64_t last, uint64_t target) {
+        auto bounds = offsets->as<uint64_t>();
+        auto dest = tuples->as<tuple>();
+        // Counting sort, the offsets of the range first hold the bucket sizes
+        std::fill(bounds + first, bounds + last, 0);
+        for(uint64_t k = 0; k < count; ++k){
+            ++bounds[bucket_of(std::get<0>(src[k]))];
+        }
+        std::vector<uint64_t> cursor(last - first);
+        uint64_t sum = target;
+        for(uint64_t b = first; b < last; ++b){
+            uint64_t tmp = bounds[b];
+            bounds[b] = sum;
+            cursor[b - first] = sum;
+            sum += tmp;
+        }
+        for(uint64_t k = 0; k < count; ++k){
+            dest[cursor[bucket_of(std::get<0>(src[k])) - first]++] = src[k];
+        }
+    }
+
+    uint64_t hash_index::bucket_of(uint64_t key) const {
+        return helpers::murmur3(key) % bucket_count;
+    }
+
+    bool hash_index::probe(const tuple& curr, std::vector<triple>& out) const {
+        auto bounds = offsets->as<uint64_t>();
+        auto data = tuples->as<tuple>();
+        uint64_t key = std::get<0>(curr);
+        uint64_t b = bucket_of(key);
+        bool found = false;
+        for(uint64_t k = bounds[b]; k < bounds[b + 1]; ++k){
+            if(std::get<0>(data[k]) == key){
+                out.emplace_back(key, std::get<1>(data[k]), std::get<1>(curr));
+                found = true;
+            }
+        }
+        return found;
+    }
+
+    void hash_index::probe(const tuple* data, uint64_t count, helpers::join_type type,
+                           std::vector<triple>& out) const {
+        if(helpers::preserves_left(type)){
+            throw std::invalid_argument("Hash indexes keep no match flags, they cannot preserve the index side.");
+        }
+        bool outer = helpers::preserves_right(type);
+        for(uint64_t k = 0; k < count; ++k){
+            if(!probe(data[k], out) && outer){
+                out.emplace_back(std::get<0>(data[k]), helpers::null_rid, std::get<1>(data[k]));
+            }
+        }
+    }
+
+    void hash_index::probe(const tuple* data, uint64_t count, helpers::join_type type, uint8_t threads,
+                           std::vector<std::vector<triple>>& out) const {
+        if(helpers::preserves_left(type)){
+            throw std::invalid_argument("Hash indexes keep no match flags, they cannot preserve the index side.");
+        }
+        uint64_t morsels = (count + default_morsel - 1) / default_morsel;
+        uint64_t first = out.size();
+        out.resize(first + morsels);
+        helpers::executor::ticket admission(*exec, std::max<uint8_t>(threads, 1));
+        helpers::executor::task_group tasks(*exec);
+        // One task per granted worker, the tasks claim the morsels
+        std::atomic<uint64_t> cursor(0);
+        for(uint32_t t = 0; t < admission.granted(); ++t){
+            tasks.post([this, data, count, type, &out, first, morsels, &cursor]{
+                for(uint64_t m = cursor++; m < morsels; m = cursor++){
+                    uint64_t start = m * default_morsel;
+                    probe(data + start, std::min(default_morsel, count - start), type, out[first + m]);
+                }
+            });
+        }
+        tasks.wait();
+    }
+
+    void hash_index::save(const std::string& path) const {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        index_header head{};
+        std::memcpy(head.magic, index_magic, sizeof(head.magic));
+        head.count = count;
+        head.buckets = bucket_count;
+        out.write(reinterpret_cast<const char*>(&head), sizeof(head));
+        out.write(static_cast<const char*>(offsets->data()), offsets->size());
+        out.write(static_cast<const char*>(tuples->data()), tuples->size());
+        out.flush();
+        if(!out){
+            throw std::runtime_error("Could not write hash index file " + path);
+        }
+    }
+
+    uint64_t hash_index::size() const {
+        return count;
+    }
+
+    uint64_t hash_index::buckets() const {
+        return bucket_count;
+    }
+
+    uint64_t hash_index::memory_bytes() const {
+        return offsets->size() + tuples->size();
+    }
+
+    uint64_t hash_index::estimate_bytes(uint64_t size, double table_size) {
+        return (bucket_count_for(size, table_size) + 1) * sizeof(uint64_t) + size * sizeof(tuple);
+    }
+
+    void hash_index::set_executor(helpers::executor& exec) {
+        this->exec = &exec;
+    }
+
+}  // namespace algorithms
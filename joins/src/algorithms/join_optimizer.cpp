@@ -0,0 +1,194 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "algorithms/join_optimizer.h"
+#include "algorithms/nop_join_mt.h"
+#include "algorithms/mt_radix/radix_join_mt.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+namespace algorithms {
+
+    namespace {
+
+        /// Parses sysfs cache sizes like "48K", "2048K" or "32M"
+        uint64_t parse_size(const std::string& text) {
+            std::istringstream in(text);
+            uint64_t value = 0;
+            char unit = 0;
+            in >> value >> unit;
+            if(unit == 'K'){
+                return value << 10;
+            } else if(unit == 'M'){
+                return value << 20;
+            }
+            return value;
+        }
+
+        /// Sysfs description of the data or unified cache on the given level, 0 if there is none
+        uint64_t sysfs_cache(uint32_t level) {
+            for(uint32_t index = 0; index < 16; ++index){
+                std::string dir = "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(index) + "/";
+                std::ifstream level_in(dir + "level");
+                std::ifstream type_in(dir + "type");
+                std::ifstream size_in(dir + "size");
+                if(!level_in || !type_in || !size_in){
+                    break;
+                }
+                uint32_t found;
+                std::string type;
+                std::string size;
+                level_in >> found;
+                type_in >> type;
+                size_in >> size;
+                if(found == level && type != "Instruction"){
+                    return parse_size(size);
+                }
+            }
+            return 0;
+        }
+
+        /// Size of the cache on the given level, sysconf first and sysfs as fallback
+        uint64_t cache_size(uint32_t level) {
+            long size = 0;
+#if defined(_SC_LEVEL2_CACHE_SIZE) && defined(_SC_LEVEL3_CACHE_SIZE)
+            size = sysconf(level == 2 ? _SC_LEVEL2_CACHE_SIZE : _SC_LEVEL3_CACHE_SIZE);
+#endif
+            return size > 0 ? static_cast<uint64_t>(size) : sysfs_cache(level);
+        }
+
+        /// Entries of the first level data TLB for 4KiB pages, 0 if cpuid does not report them
+        uint64_t tlb_entries() {
+#if defined(__x86_64__) || defined(__i386__)
+            uint32_t eax, ebx, ecx, edx;
+            // Intel: deterministic address translation leaf, one sub leaf per TLB
+            if(__get_cpuid_max(0, nullptr) >= 0x18){
+                __cpuid_count(0x18, 0, eax, ebx, ecx, edx);
+                uint32_t subleafs = eax;
+                for(uint32_t sub = 0; sub <= subleafs; ++sub){
+                    __cpuid_count(0x18, sub, eax, ebx, ecx, edx);
+                    uint32_t type = edx & 0x1f;
+                    uint32_t level = (edx >> 5) & 0x7;
+                    // Data or unified TLB on the first level supporting 4KiB pages
+                    if((type == 1 || type == 3) && level == 1 && (ebx & 0x1)){
+                        return static_cast<uint64_t>(ebx >> 16) * ecx;
+                    }
+                }
+            }
+            // AMD: L1 data TLB of 4KiB pages within the extended cache leaf
+            if(__get_cpuid_max(0x80000000, nullptr) >= 0x80000005){
+                __cpuid(0x80000005, eax, ebx, ecx, edx);
+                return (ebx >> 16) & 0xff;
+            }
+#endif
+            return 0;
+        }
+
+    }  // namespace
+
+    join_optimizer::join_optimizer(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r):
+            join_optimizer(left, right, size_l, size_r, 4, helpers::join_type::inner) {}
+
+    join_optimizer::join_optimizer(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r, uint8_t threads,
+                                   helpers::join_type type):
+            join_optimizer(left, right, size_l, size_r, threads, type, machine()) {}
+
+    join_optimizer::join_optimizer(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r, uint8_t threads,
+                                   helpers::join_type type, cache_info caches):
+            left(left), right(right), size_l(size_l), size_r(size_r), threads(threads), type(type), caches(caches),
+            planned(false), built(false), exec(&helpers::executor::global()), decision(), result() {}
+
+    const cache_info& join_optimizer::machine() {
+        static const cache_info detected = detect_caches();
+        return detected;
+    }
+
+    cache_info join_optimizer::detect_caches() {
+        cache_info caches;
+        uint64_t l2 = cache_size(2);
+        uint64_t llc = cache_size(3);
+        uint64_t tlb = tlb_entries();
+        if(l2 > 0){
+            caches.l2_bytes = l2;
+        }
+        // Machines without a third level treat the second one as last level cache
+        caches.llc_bytes = llc > 0 ? llc : std::max(caches.l2_bytes, caches.llc_bytes);
+        if(tlb > 0){
+            caches.tlb_entries = tlb;
+        }
+        return caches;
+    }
+
+    const join_plan& join_optimizer::plan() {
+        if(!planned){
+            join_planner planner(left, right, size_l, size_r, static_cast<uint64_t>(1) << 14, caches, 0);
+            decision = planner.plan();
+            planned = true;
+        }
+        return decision;
+    }
+
+    void join_optimizer::execute() {
+        plan();
+        if(decision.partition){
+            radix_join_mt join(left, right, size_l, size_r, decision.table_size, threads, decision.bits_per_pass,
+                               decision.passes, type);
+            join.set_executor(*exec);
+            join.set_plan(decision);
+            join.execute();
+            result = std::move(join.get());
+        } else {
+            nop_join_mt join(left, right, size_l, size_r, decision.table_size, threads, type);
+            join.set_executor(*exec);
+            join.set_plan(decision);
+            join.execute();
+            result = std::move(join.get());
+        }
+        built = true;
+    }
+
+    std::vector<std::vector<join_optimizer::triple>>& join_optimizer::get() {
+        if(!built){
+            throw std::logic_error("Join must be performed before querying results.");
+        }
+        return result;
+    }
+
+    void join_optimizer::set(std::vector<std::vector<triple>>& res_vec) {
+        // The vector is moved for maximum performance. The vector cannot be used by the caller afterwards.
+        result = std::move(res_vec);
+        // Set built to false again, since data was not built into the new vector
+        built = false;
+    }
+
+    void join_optimizer::set_executor(helpers::executor& exec) {
+        this->exec = &exec;
+    }
+
+    std::string join_optimizer::report() {
+        plan();
+        std::ostringstream out;
+        if(decision.partition){
+            out << "radix_join_mt bits_per_pass=" << static_cast<uint32_t>(decision.bits_per_pass)
+                << " passes=" << static_cast<uint32_t>(decision.passes)
+                << " split_threshold=" << decision.split_threshold;
+        } else {
+            out << "nop_join_mt morsel_size=" << decision.morsel_size;
+        }
+        out << " table_size=" << decision.table_size
+            << " | size_l=" << size_l << " size_r=" << size_r
+            << " distinct_l=" << decision.distinct_l << " distinct_r=" << decision.distinct_r
+            << " skew_l=" << decision.skew_l << " skew_r=" << decision.skew_r
+            << " heavy_hitters=" << decision.heavy_hitters.size()
+            << " | l2=" << caches.l2_bytes << " llc=" << caches.llc_bytes << " tlb=" << caches.tlb_entries;
+        return out.str();
+    }
+
+}  // namespace algorithms
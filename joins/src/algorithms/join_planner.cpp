@@ -0,0 +1,128 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "algorithms/join_planner.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace algorithms {
+
+    join_planner::join_planner(const tuple* left, const tuple* right, uint64_t size_l, uint64_t size_r):
+            join_planner(left, right, size_l, size_r, static_cast<uint64_t>(1) << 14, cache_info(), 0) {}
+
+    join_planner::join_planner(const tuple* left, const tuple* right, uint64_t size_l, uint64_t size_r,
+                               uint64_t sample_size, cache_info caches, uint64_t seed):
+            left(left), right(right), size_l(size_l), size_r(size_r), sample_size(sample_size > 0 ? sample_size : 1),
+            caches(caches), seed(seed) {}
+
+    join_planner::sample_stats join_planner::analyze(const tuple* data, uint64_t size, uint64_t seed) {
+        sample_stats stats{0, 0, 0, 0, {}};
+        if(size == 0){
+            return stats;
+        }
+        /*
+         * Small inputs are looked at completely. Larger ones are cut into n strata with one random position
+         * each, so no position is sampled twice and sorted inputs are still covered evenly.
+         */
+        uint64_t n = std::min(size, sample_size);
+        std::vector<uint64_t> keys(n);
+        if(n == size){
+            for(uint64_t k = 0; k < n; ++k){
+                keys[k] = std::get<0>(data[k]);
+            }
+        } else {
+            std::mt19937_64 gen(seed);
+            for(uint64_t k = 0; k < n; ++k){
+                uint64_t start = size * k / n;
+                uint64_t end = size * (k + 1) / n;
+                std::uniform_int_distribution<uint64_t> pos(start, end - 1);
+                keys[k] = std::get<0>(data[pos(gen)]);
+            }
+        }
+        std::sort(keys.begin(), keys.end());
+        // Frequencies of the sampled keys, singletons get scaled up by the GEE distinct value estimator
+        uint64_t singletons = 0;
+        uint64_t repeated = 0;
+        uint64_t max_run = 0;
+        auto heavy_min = static_cast<uint64_t>(std::ceil(heavy_share * n));
+        for(uint64_t k = 0; k < n;){
+            uint64_t run = 1;
+            while(k + run < n && keys[k + run] == keys[k]){
+                ++run;
+            }
+            if(run == 1){
+                ++singletons;
+            } else {
+                ++repeated;
+            }
+            if(run >= heavy_min && run > 1){
+                stats.heavy.push_back(keys[k]);
+            }
+            max_run = std::max(max_run, run);
+            k += run;
+        }
+        double scale = std::sqrt(static_cast<double>(size) / n);
+        // A sample without any repetition gives no evidence of duplicates at all
+        stats.distinct = repeated == 0 ? size : std::min(size, static_cast<uint64_t>(scale * singletons) + repeated);
+        stats.sampled = n;
+        stats.sampled_distinct = singletons + repeated;
+        stats.skew = static_cast<double>(max_run) / n;
+        return stats;
+    }
+
+    join_plan join_planner::plan() {
+        join_plan result;
+        sample_stats stats_l = analyze(left, size_l, seed);
+        sample_stats stats_r = analyze(right, size_r, seed + 1);
+        result.distinct_l = stats_l.distinct;
+        result.distinct_r = stats_r.distinct;
+        result.skew_l = stats_l.skew;
+        result.skew_r = stats_r.skew;
+        result.heavy_hitters = stats_l.heavy;
+        result.heavy_hitters.insert(result.heavy_hitters.end(), stats_r.heavy.begin(), stats_r.heavy.end());
+        std::sort(result.heavy_hitters.begin(), result.heavy_hitters.end());
+        result.heavy_hitters.erase(std::unique(result.heavy_hitters.begin(), result.heavy_hitters.end()),
+                                   result.heavy_hitters.end());
+        /*
+         * Duplicates of a key share their bucket, so a build side where most sampled keys repeat can do with
+         * a smaller table. The estimate is only trusted then, since it underestimates on mostly unique keys.
+         */
+        if(size_l > 0 && stats_l.sampled_distinct * 2 <= stats_l.sampled){
+            double ratio = static_cast<double>(stats_l.distinct) / size_l;
+            result.table_size = std::max(1.5 * ratio, 0.1);
+        }
+        // Footprint of the build side's hash table
+        auto table_bytes = static_cast<uint64_t>(result.table_size * size_l * sizeof(helpers::hash_table::bucket));
+        /*
+         * Partitioning does not pay off if the whole table is cache resident already. Heavily skewed probe
+         * sides mostly hit a few hot buckets, so the table only has to fit into the last level cache.
+         */
+        bool skewed = stats_r.skew >= 0.25;
+        if(table_bytes <= caches.l2_bytes || (skewed && table_bytes <= caches.llc_bytes)){
+            result.partition = false;
+        } else {
+            // Total fanout bringing every partition's table into the private cache
+            auto total_bits = static_cast<uint64_t>(std::ceil(std::log2(
+                    static_cast<double>(table_bytes) / caches.l2_bytes)));
+            total_bits = std::max<uint64_t>(total_bits, 1);
+            // A single pass should not write to more partitions than there are TLB entries
+            uint64_t entries = std::max<uint64_t>(caches.tlb_entries, 2);
+            auto max_bits = static_cast<uint64_t>(std::log2(static_cast<double>(entries)));
+            uint64_t passes = (total_bits + max_bits - 1) / max_bits;
+            result.passes = static_cast<uint8_t>(passes);
+            result.bits_per_pass = static_cast<uint8_t>((total_bits + passes - 1) / passes);
+        }
+        if(!stats_r.heavy.empty()){
+            // Partitions of heavy probe keys get split early, twice the average partition is enough
+            uint64_t fanout_bits = result.partition ? static_cast<uint64_t>(result.bits_per_pass * result.passes) : 0;
+            uint64_t average = fanout_bits < 64 ? size_r >> fanout_bits : 0;
+            result.split_threshold = std::max<uint64_t>(2 * average, static_cast<uint64_t>(1) << 12);
+            // Probe tuples of heavy keys produce many matches, smaller morsels keep the threads balanced
+            result.morsel_size = static_cast<uint64_t>(1) << 11;
+        }
+        return result;
+    }
+
+}  // namespace algorithms
@@ -0,0 +1,72 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "algorithms/mt_radix/group_join_mt.h"
+#include "algorithms/mt_radix/radix_tasks.h"
+#include "algorithms/group_join.h"
+#include <stdexcept>
+#include <utility>
+
+namespace algorithms{
+
+    group_join_mt::group_join_mt(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r,
+                                 uint8_t bits_per_pass, uint8_t passes):
+            group_join_mt(left, right, size_l, size_r, 1.5, 4, bits_per_pass, passes) {}
+
+    group_join_mt::group_join_mt(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r,
+                                 double table_size, uint8_t threads, uint8_t bits_per_pass, uint8_t passes):
+            left(left), right(right), size_l(size_l), size_r(size_r), table_size(table_size), threads(threads),
+            built(false),
+            exec(&helpers::executor::global()), result(threads), bits_per_pass(bits_per_pass), passes(passes) {}
+
+    void group_join_mt::execute() {
+        built = true;
+        // No results on empty datasets
+        if(size_l == 0 || size_r == 0){
+            return;
+        }
+        // Target Arrays used for scattering
+        helpers::page_buffer target_l(size_l * sizeof(tuple));
+        helpers::page_buffer target_r(size_r * sizeof(tuple));
+        // The join triples of the context stay unused, groups get written into our own result vectors
+        std::vector<std::vector<task_context::triple>> unused;
+        helpers::executor::ticket admission(*exec, threads);
+        helpers::executor::task_group tasks(*exec);
+        // Joins running concurrently may leave fewer workers than requested, the first pass is split accordingly
+        auto workers = static_cast<uint8_t>(admission.granted());
+        task_context context(bits_per_pass, passes, workers, table_size, helpers::join_type::inner, &tasks, unused);
+        context.leaf = [this](task_context* ctx, tuple* data_l, tuple* data_r, uint64_t part_l, uint64_t part_r){
+            // No groups can be produced on empty partitions
+            if(part_l == 0 || part_r == 0){
+                return;
+            }
+            uint8_t index = ctx->acquire_output();
+            // Group join the partition pair, the output buffer gets moved in and out again
+            group_join join(data_l, data_r, part_l, part_r, ctx->table_size, result[index]);
+            join.execute();
+            result[index] = std::move(join.get());
+            ctx->release_output(index);
+        };
+        radix_run::execute(&context, left, right, size_l, size_r, target_l.as<tuple>(), target_r.as<tuple>());
+    }
+
+    std::vector<std::vector<group_join_mt::group>>& group_join_mt::get(){
+        if(!built){
+            throw std::logic_error("Join must be performed before querying results.");
+        }
+        return result;
+    }
+
+    void group_join_mt::set(std::vector<std::vector<group_join_mt::group>> &res_vec) {
+        // The vector is moved for maximum performance. The vector cannot be used by the caller afterwards.
+        result = std::move(res_vec);
+        // Set built to false again, since data was not built into the new vector
+        built = false;
+    }
+
+    void group_join_mt::set_executor(helpers::executor& exec) {
+        this->exec = &exec;
+    }
+
+} // namespace algorithms
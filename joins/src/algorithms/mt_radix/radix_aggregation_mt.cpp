@@ -0,0 +1,72 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "algorithms/mt_radix/radix_aggregation_mt.h"
+#include "algorithms/mt_radix/radix_tasks.h"
+#include <stdexcept>
+#include <utility>
+
+namespace algorithms{
+
+    radix_aggregation_mt::radix_aggregation_mt(tuple* data, uint64_t size, uint8_t bits_per_pass, uint8_t passes):
+            radix_aggregation_mt(data, size, 1.5, 4, bits_per_pass, passes) {}
+
+    radix_aggregation_mt::radix_aggregation_mt(tuple* data, uint64_t size, double table_size, uint8_t threads,
+                                               uint8_t bits_per_pass, uint8_t passes):
+            data(data), size(size), table_size(table_size), threads(threads), built(false),
+            exec(&helpers::executor::global()), result(threads),
+            bits_per_pass(bits_per_pass), passes(passes) {}
+
+    void radix_aggregation_mt::execute() {
+        built = true;
+        // No groups on empty datasets
+        if(size == 0){
+            return;
+        }
+        // Target Array used for scattering, the right side of the partition tasks stays empty
+        helpers::page_buffer target(size * sizeof(tuple));
+        std::vector<std::vector<task_context::triple>> unused;
+        helpers::executor::ticket admission(*exec, threads);
+        helpers::executor::task_group tasks(*exec);
+        // Joins running concurrently may leave fewer workers than requested, the first pass is split accordingly
+        auto workers = static_cast<uint8_t>(admission.granted());
+        task_context context(bits_per_pass, passes, workers, table_size, helpers::join_type::inner, &tasks, unused);
+        context.leaf = [this](task_context* ctx, tuple* part, tuple*, uint64_t part_size, uint64_t){
+            if(part_size == 0){
+                return;
+            }
+            // Aggregate the partition within a local, cache resident table
+            auto table_len = static_cast<uint64_t>(ctx->table_size * part_size);
+            helpers::aggregate_table table(table_len > 0 ? table_len : 1);
+            for(uint64_t k = 0; k < part_size; ++k){
+                helpers::aggregate& group = table.insert(std::get<0>(part[k]));
+                group.multiplicity = 1;
+                group.update(std::get<1>(part[k]));
+            }
+            uint8_t index = ctx->acquire_output();
+            table.collect(result[index]);
+            ctx->release_output(index);
+        };
+        radix_run::execute(&context, data, nullptr, size, 0, target.as<tuple>(), nullptr);
+    }
+
+    std::vector<std::vector<radix_aggregation_mt::group>>& radix_aggregation_mt::get(){
+        if(!built){
+            throw std::logic_error("Aggregation must be performed before querying results.");
+        }
+        return result;
+    }
+
+    void radix_aggregation_mt::set(std::vector<std::vector<radix_aggregation_mt::group>> &res_vec) {
+        // The vector is moved for maximum performance. The vector cannot be used by the caller afterwards.
+        result = std::move(res_vec);
+        // Set built to false again, since data was not built into the new vector
+        built = false;
+    }
+
+    void radix_aggregation_mt::set_executor(helpers::executor& exec) {
+        this->exec = &exec;
+    }
+
+} // namespace algorithms
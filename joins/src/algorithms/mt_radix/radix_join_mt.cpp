@@ -4,134 +4,146 @@
 
 #include "algorithms/mt_radix/radix_join_mt.h"
 #include "algorithms/mt_radix/radix_tasks.h"
+#include "algorithms/async_reader.h"
+#include "algorithms/relation_file.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
 #include <utility>
-#include <future>
 
 namespace algorithms{
 
+    radix_join_mt::radix_join_mt(radix_join_mt::tuple *left, tuple *right, uint64_t size_l, uint64_t size_r):
+                radix_join_mt(left, right, size_l, size_r, 4, helpers::join_type::inner) {}
+
+    radix_join_mt::radix_join_mt(radix_join_mt::tuple *left, tuple *right, uint64_t size_l, uint64_t size_r,
+                                 uint8_t threads, helpers::join_type type):
+                radix_join_mt(left, right, size_l, size_r, 1.5, threads, 6, 2, type) {
+        // Parameters tuned on this machine take precedence over the static defaults
+        set_calibration(calibration::host());
+    }
+
     radix_join_mt::radix_join_mt(radix_join_mt::tuple *left, tuple *right, uint64_t size_l, uint64_t size_r,
                                  uint8_t bits_per_pass, uint8_t passes):
                 radix_join_mt(left, right, size_l, size_r, 1.5, 4, bits_per_pass, passes) {}
 
     radix_join_mt::radix_join_mt(radix_join_mt::tuple *left, tuple *right, uint64_t size_l, uint64_t size_r,
                                  double table_size, uint8_t threads, uint8_t bits_per_pass, uint8_t passes):
+            radix_join_mt(left, right, size_l, size_r, table_size, threads, bits_per_pass, passes,
+                          helpers::join_type::inner) {}
+
+    radix_join_mt::radix_join_mt(radix_join_mt::tuple *left, tuple *right, uint64_t size_l, uint64_t size_r,
+                                 double table_size, uint8_t threads, uint8_t bits_per_pass, uint8_t passes,
+                                 helpers::join_type type):
             left(left), right(right), size_l(size_l), size_r(size_r), table_size(table_size), threads(threads),
-            built(false), result(threads), bits_per_pass(bits_per_pass), passes(passes) {}
+            built(false), exec(&helpers::executor::global()), result(threads), bits_per_pass(bits_per_pass),
+            passes(passes), type(type), skew_threshold(0), numa_aware(false), mode(partition_mode::scratch),
+            used_mode(partition_mode::scratch), used_buckets(0), used_unbound(0),
+            memory_budget(std::numeric_limits<uint64_t>::max()), offset_l(0), offset_r(0),
+            io_chunk(static_cast<uint64_t>(1) << 22), io_depth(4) {}
+
+    radix_join_mt::radix_join_mt(const std::string& path_l, const std::string& path_r, double table_size,
+                                 uint8_t threads, uint8_t bits_per_pass, uint8_t passes, helpers::join_type type):
+            radix_join_mt(nullptr, nullptr, 0, 0, table_size, threads, bits_per_pass, passes, type) {
+        // Only the headers are read here, the records follow on execute()
+        helpers::relation_header head_l = helpers::read_relation_header(path_l);
+        helpers::relation_header head_r = helpers::read_relation_header(path_r);
+        if(head_l.columns != 2 || head_r.columns != 2){
+            throw std::runtime_error("Join inputs have to be relation files, not join results.");
+        }
+        this->path_l = path_l;
+        this->path_r = path_r;
+        size_l = head_l.count;
+        size_r = head_r.count;
+        offset_l = head_l.offset;
+        offset_r = head_r.offset;
+    }
 
     // Run the actual radix join using the tools from radix_task
     void radix_join_mt::execute() {
-        // No results on empty datasets
+        // File inputs get read in the background, every phase not overlapping with the reads waits for them
+        std::unique_ptr<helpers::async_reader> reader_l;
+        std::unique_ptr<helpers::async_reader> reader_r;
+        if(!path_l.empty()){
+            input_l = std::make_unique<helpers::page_buffer>(size_l * sizeof(tuple));
+            input_r = std::make_unique<helpers::page_buffer>(size_r * sizeof(tuple));
+            left = input_l->as<tuple>();
+            right = input_r->as<tuple>();
+            reader_l = std::make_unique<helpers::async_reader>(path_l, offset_l, size_l * sizeof(tuple), left,
+                                                               io_chunk, io_depth);
+            reader_r = std::make_unique<helpers::async_reader>(path_r, offset_r, size_r * sizeof(tuple), right,
+                                                               io_chunk, io_depth);
+        }
+        bool streamed = reader_l != nullptr;
+        auto wait_all = [&]{
+            if(streamed){
+                reader_l->wait_all();
+                reader_r->wait_all();
+                streamed = false;
+            }
+        };
+        // No matches on empty datasets, only the preserved sides have to be emitted
         if(size_l == 0 || size_r == 0){
+            wait_all();
+            used_buckets = 0;
+            used_unbound = 0;
             built = true;
-            return;
-        }
-        // Target Arrays used for scattering
-        std::unique_ptr<tuple[]> target_l(new tuple[size_l]);
-        std::unique_ptr<tuple[]> target_r(new tuple[size_r]);
-        typedef std::pair<std::shared_ptr<std::vector<uint64_t>>, std::shared_ptr<std::vector<uint64_t>>> histograms;
-        // Thread pool and context needed for further subtasks
-        ThreadPool pool(threads);
-        task_context context(bits_per_pass, passes, threads, table_size, &pool, result);
-        // Will get unlocked once all partition tasks are finished
-        std::vector<std::future<histograms>> vec(threads);
-        // Schedule the first round of partition tasks
-        uint64_t range_l = size_l / threads;
-        uint64_t range_r = size_r / threads;
-        for(uint8_t k = 0; k < threads - 1; ++k){
-            vec[k] = pool.enqueue(partition_task::execute, &context, false, 1, left + (k*range_l), right + (k*range_r),
-                    range_l, range_r, nullptr, nullptr);
-        }
-        vec[threads-1] = pool.enqueue(partition_task::execute, &context, false, 1, left + ((threads - 1)*range_l),
-                right + ((threads - 1)*range_r), size_l - ((threads - 1)*range_l), size_r - ((threads - 1)*range_r),
-                                      nullptr, nullptr);
-        std::vector<histograms> res(threads);
-        // Get all histograms of the first partition runs
-        for(uint8_t k = 0; k < threads; ++k){
-            res[k] = vec[k].get();
-        }
-        // The following code builds history and prefix sums
-        uint64_t part_count = (static_cast<uint64_t>(1) << static_cast<uint64_t>(bits_per_pass));
-        // Global histogram
-        std::vector<uint64_t> hist_l(part_count);
-        std::vector<uint64_t> hist_r(part_count);
-        // Build sum over the partition arrays creating global histogram
-        for(uint64_t n = 0; n < threads; ++n){
-            for(uint64_t k = 0; k < part_count; ++k){
-                (hist_l)[k] += (*res[n].first)[k];
-                (hist_r)[k] += (*res[n].second)[k];
+            for(uint64_t k = 0; helpers::preserves_left(type) && size_r == 0 && k < size_l; ++k){
+                result[0].emplace_back(std::get<0>(left[k]), std::get<1>(left[k]), helpers::null_rid);
             }
-        }
-        // Vectors containing the prefix sum
-        std::vector<uint64_t> sum_l(part_count);
-        std::vector<uint64_t> sum_r(part_count);
-        // Build the actual prefix sum
-        uint64_t cl = (hist_l)[0];
-        uint64_t cr = (hist_r)[0];
-        sum_l[0] = 0;
-        sum_r[0] = 0;
-        for(uint64_t k = 1; k < part_count; ++k){
-            sum_l[k] = cl;
-            sum_r[k] = cr;
-            cl += hist_l[k];
-            cr += hist_r[k];
-        }
-
-        /*
-         * Now we can create the first group of scatter tasks.
-         * For this we have to assign each thread a unique local partition within the target array.
-         * Similar to the build process in the creation of the prefix sums we perform deferred additions
-         * of the thread's histograms onto the prefix sum.
-         * Since we are working on fairly small vectors here all data should still be L1 residing.
-         */
-        std::vector<std::future<bool>> scatter_vec(threads);
-        // Schedule scatter tasks for all except the last thread
-        // Create copies of the sum arrays
-        auto localsum_l = sum_l;
-        auto localsum_r = sum_r;
-        for(uint8_t k = 0; k < threads - 1; ++k){
-            // Create the thread specific scatter information, have to copy the arrays
-            auto local_l = std::make_shared<std::vector<uint64_t>>(localsum_l);
-            auto local_r = std::make_shared<std::vector<uint64_t>>(localsum_r);
-            // Run scatter task
-            scatter_vec[k] = pool.enqueue(scatter_task::execute, &context, false, 1, local_l, local_r,
-                    left + (k*range_l), right + (k*range_r), range_l, range_r, target_l.get(), target_r.get());
-            // Update the sum vectors with thread's histogram data
-            for(uint64_t j = 0; j < part_count; ++j){
-                localsum_l[j] += (*(res[k]).first)[j];
-                localsum_r[j] += (*(res[k]).second)[j];
+            for(uint64_t k = 0; helpers::preserves_right(type) && size_l == 0 && k < size_r; ++k){
+                result[0].emplace_back(std::get<0>(right[k]), helpers::null_rid, std::get<1>(right[k]));
             }
+            return;
         }
-        // Schedule the final scatter task, fairly complicated calling logic here
-        scatter_vec[threads - 1] = pool.enqueue(scatter_task::execute, &context, false, 1,
-                std::make_shared<std::vector<uint64_t>>(localsum_l), std::make_shared<std::vector<uint64_t>>(localsum_r),
-                left + ((threads - 1)*range_l), right + ((threads - 1)*range_r), size_l - ((threads - 1)*range_l),
-                size_r - ((threads - 1)*range_r), target_l.get(), target_r.get());
-        // Join Scatter tasks again, as the first round forms a barrier
-        for(uint8_t k = 0; k < threads; ++k){
-            scatter_vec[k].get();
-        }
-
-        // If we are only running one pass we now have to schedule the final build and probe tasks
-        if(passes == 1){
-            // Schedule partition tasks
-            for(uint64_t k = 0; k < part_count; ++k){
-                pool.enqueue(join_task::execute, &context, target_l.get() + sum_l[k], target_r.get() + sum_r[k],
-                             hist_l[k], hist_r[k]);
+        // Pick the mode staying within the budget. Only multi pass scratch partitioning reorders the inputs anyway
+        // and may fall back to in place, the inputs of the other modes must not be touched.
+        used_mode = mode;
+        if(buffer_bytes(used_mode) > memory_budget){
+            if(used_mode == partition_mode::copy || passes == 1){
+                throw std::length_error("Non destructive partitioning exceeds the memory budget.");
             }
+            used_mode = partition_mode::in_place;
         }
-        // We have to perform more partitions and scatters
-        else {
-            // We schedule the second round of partition tasks, but this time with automatic subtask spawning
-            for(uint64_t k = 0; k < part_count; ++k){
-                pool.enqueue(partition_task::execute, &context, true, 2, target_l.get() + sum_l[k],
-                             target_r.get() + sum_r[k], hist_l[k], hist_r[k], left + sum_l[k], right + sum_r[k]);
-            }
+        bool in_place = used_mode == partition_mode::in_place;
+        bool ping_pong = used_mode == partition_mode::copy && passes > 1;
+        // Target Arrays used for scattering, left untouched so their pages get placed by the scattering threads
+        helpers::page_buffer target_l(in_place ? 0 : size_l * sizeof(tuple));
+        helpers::page_buffer target_r(in_place ? 0 : size_r * sizeof(tuple));
+        // Private scratch space for the intermediate passes instead of the inputs
+        helpers::page_buffer scratch_l(ping_pong ? size_l * sizeof(tuple) : 0);
+        helpers::page_buffer scratch_r(ping_pong ? size_r * sizeof(tuple) : 0);
+        // Admission on the shared executor and context needed for further subtasks
+        helpers::executor::ticket admission(*exec, threads);
+        helpers::executor::task_group tasks(*exec);
+        // Joins running concurrently may leave fewer workers than requested, the first pass is split accordingly
+        auto workers = static_cast<uint8_t>(admission.granted());
+        task_context context(bits_per_pass, passes, workers, table_size, type, &tasks, result);
+        context.split_threshold = skew_threshold;
+        // Placement binds the target buffers, the inputs belong to the caller
+        context.numa = numa_aware && !in_place ? &exec->topology() : nullptr;
+        // Both targets get bound in whole pages of the larger page size, which is aligned for both
+        context.numa_page = std::max(helpers::page_bytes(target_l.pages()), helpers::page_bytes(target_r.pages()));
+        // Partition both sides, final partitions get joined by the default join_task leaf
+        if(in_place){
+            // Permuting needs the complete histograms, there is nothing to overlap with
+            wait_all();
+            radix_run::execute_in_place(&context, left, right, size_l, size_r);
+        } else if(streamed){
+            radix_run::execute_streamed(&context, left, right, size_l, size_r, target_l.as<tuple>(),
+                    target_r.as<tuple>(), ping_pong ? scratch_l.as<tuple>() : left,
+                    ping_pong ? scratch_r.as<tuple>() : right, std::max<uint64_t>(io_chunk / sizeof(tuple), 1),
+                    [&](uint64_t start, uint64_t end){ reader_l->wait(start * sizeof(tuple), end * sizeof(tuple)); },
+                    [&](uint64_t start, uint64_t end){ reader_r->wait(start * sizeof(tuple), end * sizeof(tuple)); });
+        } else if(ping_pong){
+            radix_run::execute(&context, left, right, size_l, size_r, target_l.as<tuple>(), target_r.as<tuple>(),
+                               scratch_l.as<tuple>(), scratch_r.as<tuple>());
+        } else {
+            radix_run::execute(&context, left, right, size_l, size_r, target_l.as<tuple>(), target_r.as<tuple>());
         }
+        used_buckets = context.leaf_buckets;
+        used_unbound = context.unbound;
         built = true;
-        // Wait until all last level join tasks are finished, then we can finish up
-        std::unique_lock<std::mutex> lk(context.join_wait);
-        context.wait.wait(lk, [&context]{return context.finished;});
-        pool.finish();
     }
 
     std::vector<std::vector<radix_join_mt::triple>>& radix_join_mt::get(){
@@ -148,4 +160,69 @@ namespace algorithms{
         built = false;
     }
 
+    void radix_join_mt::set_skew_threshold(uint64_t threshold) {
+        skew_threshold = threshold;
+    }
+
+    void radix_join_mt::set_plan(const join_plan& plan) {
+        bits_per_pass = plan.bits_per_pass;
+        passes = plan.passes;
+        table_size = plan.table_size;
+        skew_threshold = plan.split_threshold;
+    }
+
+    void radix_join_mt::set_calibration(const calibration& tuned) {
+        const calibration_entry* entry = tuned.lookup(size_l);
+        if(entry != nullptr){
+            bits_per_pass = entry->bits_per_pass;
+            passes = entry->passes;
+            table_size = entry->table_size;
+        }
+    }
+
+    void radix_join_mt::set_partition_mode(partition_mode mode) {
+        this->mode = mode;
+    }
+
+    void radix_join_mt::set_memory_budget(uint64_t bytes) {
+        memory_budget = bytes;
+    }
+
+    radix_join_mt::partition_mode radix_join_mt::used_partition_mode() const {
+        return used_mode;
+    }
+
+    uint64_t radix_join_mt::leaf_buckets() const {
+        return used_buckets;
+    }
+
+    uint64_t radix_join_mt::unbound_ranges() const {
+        return used_unbound;
+    }
+
+    void radix_join_mt::set_io(uint64_t chunk_bytes, uint32_t depth) {
+        io_chunk = chunk_bytes;
+        io_depth = depth;
+    }
+
+    uint64_t radix_join_mt::buffer_bytes(partition_mode mode) const {
+        uint64_t relations = (size_l + size_r) * sizeof(tuple);
+        switch(mode){
+            case partition_mode::in_place:
+                return 0;
+            case partition_mode::copy:
+                return passes > 1 ? 2 * relations : relations;
+            default:
+                return relations;
+        }
+    }
+
+    void radix_join_mt::set_numa(bool enabled) {
+        numa_aware = enabled;
+    }
+
+    void radix_join_mt::set_executor(helpers::executor& exec) {
+        this->exec = &exec;
+    }
+
 } // namespace algorithms
\ No newline at end of file
@@ -4,14 +4,69 @@
 
 #include "algorithms/mt_radix/radix_tasks.h"
 #include "algorithms/nop_join.h"
+#include <algorithm>
+#include <cstring>
 
 namespace algorithms{
 
+    namespace {
+
+        /// Leaves several times larger than the average one get split, tiny ones are not worth it
+        void init_split(task_context* context, uint64_t size_r) {
+            if(context->split_threshold == 0){
+                uint64_t fanout_bits = static_cast<uint64_t>(context->radix_bits * context->radix_passes);
+                uint64_t average = fanout_bits < 64 ? size_r >> fanout_bits : 0;
+                context->split_threshold = std::max<uint64_t>(4 * average, static_cast<uint64_t>(1) << 15);
+            }
+            if(context->split_chunk == 0){
+                context->split_chunk = std::max<uint64_t>(context->split_threshold / 4,
+                                                          static_cast<uint64_t>(1) << 13);
+            }
+        }
+
+        /// Tuples per thread below which a speculative permutation round is not worth its repair step
+        constexpr uint64_t min_speculative = static_cast<uint64_t>(1) << 14;
+
+    }  // namespace
+
+    histogram_arena::histogram_arena(uint64_t part_count, size_t workers):
+        part_count(part_count), free_lists(workers + 1), chunk_used(chunk_blocks)
+    {
+    }
+
+    uint64_t* histogram_arena::acquire(size_t owner) {
+        uint64_t* hist;
+        auto& free = free_lists[owner];
+        if(!free.empty()){
+            hist = free.back();
+            free.pop_back();
+        }
+        else{
+            // Carve a fresh histogram, a new chunk is only needed every chunk_blocks histograms
+            std::lock_guard<std::mutex> lock(chunk_lock);
+            if(chunk_used == chunk_blocks){
+                chunks.emplace_back(new uint64_t[chunk_blocks * part_count]);
+                chunk_used = 0;
+            }
+            hist = chunks.back().get() + (chunk_used++) * part_count;
+        }
+        std::fill(hist, hist + part_count, 0);
+        return hist;
+    }
+
+    void histogram_arena::release(size_t owner, uint64_t* hist) {
+        free_lists[owner].push_back(hist);
+    }
+
     task_context::task_context(uint8_t radix_bits, uint8_t radix_passes, uint8_t thread_count, double table_size,
-                               ThreadPool *pool, std::vector<std::vector<triple>>& results):
+                               helpers::join_type type, helpers::executor::task_group* tasks,
+                               std::vector<std::vector<triple>>& results):
         radix_bits(radix_bits), radix_passes(radix_passes), thread_count(thread_count), table_size(table_size),
-        pool(pool), free_index(thread_count), output_mutex(), results(results), finished(false),
-        join_count(0), join_exp(static_cast<uint64_t>(1) << static_cast<uint64_t>(radix_bits*radix_passes))
+        type(type), tasks(tasks), pool(&tasks->pool()),
+        histograms(static_cast<uint64_t>(1) << radix_bits, pool->size()), free_index(thread_count), output_mutex(),
+        output_free(),
+        results(results), leaf(join_task::execute), split_threshold(0), split_chunk(0), leaf_buckets(0),
+        numa(nullptr), numa_page(0), unbound(0)
     {
         // Properly fill the free_index vector
         for(uint8_t k = 0; k < thread_count; ++k){
@@ -19,85 +74,75 @@ namespace algorithms{
         }
     }
 
+    uint8_t task_context::acquire_output() {
+        // A shared executor may run more leaves of this join at once than there are output buffers
+        std::unique_lock<std::mutex> lock(output_mutex);
+        output_free.wait(lock, [this]{ return !free_index.empty(); });
+        uint8_t index = free_index.back();
+        free_index.pop_back();
+        return index;
+    }
+
+    void task_context::release_output(uint8_t index) {
+        {
+            std::lock_guard<std::mutex> lock(output_mutex);
+            free_index.emplace_back(index);
+        }
+        output_free.notify_one();
+    }
+
+    size_t task_context::histogram_owner() const {
+        long worker = pool->current_worker();
+        return worker >= 0 ? static_cast<size_t>(worker) : pool->size();
+    }
+
     // Main string of execution or a partition task
-    std::pair<std::shared_ptr<std::vector<uint64_t>>, std::shared_ptr<std::vector<uint64_t>>>
-            partition_task::execute(task_context* context, bool spawn, uint8_t curr_depth, tuple* data_l, tuple* data_r,
-                                    uint64_t size_l, uint64_t size_r, tuple* target_l, tuple* target_r) {
+    std::pair<uint64_t*, uint64_t*> partition_task::execute(task_context* context, bool spawn, uint8_t curr_depth,
+                                    tuple* data_l, tuple* data_r, uint64_t size_l, uint64_t size_r,
+                                    tuple* target_l, tuple* target_r) {
         // Create histograms
-        auto hist_l = std::make_shared<std::vector<uint64_t>>(static_cast<uint64_t>(1) << context->radix_bits);
-        auto hist_r = std::make_shared<std::vector<uint64_t>>(static_cast<uint64_t>(1) << context->radix_bits);
-        // Create bit pattern on which should be filtered
-        uint64_t pattern = (static_cast<uint64_t>(1) << static_cast<uint64_t>(curr_depth * context->radix_bits)) - 1;
-        auto shiftback = static_cast<uint64_t>((curr_depth - 1) * context->radix_bits);
-        // Build histogram for the left relation
-        for (uint64_t k = 0; k < size_l; ++k) {
-            tuple &curr = data_l[k];
-            uint64_t hash = helpers::murmur3(std::get<0>(curr));
-            // We only care about the specific partition's bits
-            uint64_t value = static_cast<uint64_t>(hash & pattern) >> shiftback;
-            // Increment histogram value
-            ++((*hist_l)[value]);
-        }
-        // Build histogram for the right relation
-        for (uint64_t k = 0; k < size_r; ++k) {
-            tuple &curr = data_r[k];
-            uint64_t hash = helpers::murmur3(std::get<0>(curr));
-            // We only care about the specific partition's bits
-            uint64_t value = static_cast<uint64_t>(hash & pattern) >> shiftback;
-            // Increment histogram value
-            ++((*hist_r)[value]);
-        }
+        size_t owner = context->histogram_owner();
+        uint64_t* hist_l = context->histograms.acquire(owner);
+        uint64_t* hist_r = context->histograms.acquire(owner);
+        // We only care about the specific partition's bits
+        auto shift = static_cast<uint8_t>((curr_depth - 1) * context->radix_bits);
+        // Build histograms for the left and right relation
+        helpers::radix_histogram(data_l, size_l, shift, context->radix_bits, hist_l);
+        helpers::radix_histogram(data_r, size_r, shift, context->radix_bits, hist_r);
         // Create scatter tasks if spawning is enabled
         if (spawn) {
             // Create prefix sums used by the scatter task
             uint64_t part_count = static_cast<uint64_t>(1) << static_cast<uint64_t>(context->radix_bits);
-            uint64_t cl = (*hist_l)[0];
-            uint64_t cr = (*hist_r)[0];
-            (*hist_l)[0] = 0;
-            (*hist_r)[0] = 0;
+            uint64_t cl = hist_l[0];
+            uint64_t cr = hist_r[0];
+            hist_l[0] = 0;
+            hist_r[0] = 0;
             for(uint64_t k = 1; k < part_count; ++k){
-                uint64_t temp_l = (*hist_l)[k];
-                uint64_t temp_r = (*hist_r)[k];
-                (*hist_l)[k] = cl;
-                (*hist_r)[k] = cr;
+                uint64_t temp_l = hist_l[k];
+                uint64_t temp_r = hist_r[k];
+                hist_l[k] = cl;
+                hist_r[k] = cr;
                 cl += temp_l;
                 cr += temp_r;
             }
-            // Schedule scatter task based on prefix sum
-            context->pool->enqueue(scatter_task::execute, context, true, curr_depth, hist_l, hist_r, data_l, data_r,
+            // Schedule scatter task based on prefix sum, it takes over the histograms
+            context->tasks->post(scatter_task::execute, context, true, curr_depth, hist_l, hist_r, data_l, data_r,
                     size_l, size_r, target_l, target_r);
+            return {nullptr, nullptr};
         }
-        // Return histograms
+        // Return histograms, the caller is responsible for releasing them
         return {hist_l, hist_r};
     }
 
     // Perform actual scattering
-    bool scatter_task::execute(task_context* context, bool spawn, uint8_t curr_depth,
-                               std::shared_ptr<std::vector<uint64_t>> sum_l,
-                               std::shared_ptr<std::vector<uint64_t>> sum_r, tuple* data_l, tuple* data_r,
-                               uint64_t size_l, uint64_t size_r, tuple* target_l, tuple* target_r) {
-        // Create bit pattern on which should be filtered
-        uint64_t pattern = (static_cast<uint64_t>(1) << static_cast<uint64_t>(curr_depth * context->radix_bits)) - 1;
-        auto shiftback = static_cast<uint64_t>((curr_depth - 1) * context->radix_bits);
-        // Scatter left relation based on prefix sum
-        for(uint64_t k = 0; k < size_l; ++k){
-            tuple& curr = data_l[k];
-            uint64_t hash = helpers::murmur3(std::get<0>(curr));
-            // We only care about the specific partition's bits
-            uint64_t value = static_cast<uint64_t>(hash & pattern) >> shiftback;
-            uint64_t write_to = (*sum_l)[value]++;
-            target_l[write_to] = curr;
-        }
-        // Scatter right relation based on prefix sum
-        for(uint64_t k = 0; k < size_r; ++k){
-            tuple& curr = data_r[k];
-            uint64_t hash = helpers::murmur3(std::get<0>(curr));
-            // Create bit pattern on which should be filtered
-            // We only care about the specific partition's bits
-            uint64_t value = static_cast<uint64_t>(hash & pattern) >> shiftback;
-            uint64_t write_to = (*sum_r)[value]++;
-            target_r[write_to] = curr;
-        }
+    bool scatter_task::execute(task_context* context, bool spawn, uint8_t curr_depth, uint64_t* sum_l,
+                               uint64_t* sum_r, tuple* data_l, tuple* data_r, uint64_t size_l, uint64_t size_r,
+                               tuple* target_l, tuple* target_r) {
+        // We only care about the specific partition's bits
+        auto shift = static_cast<uint8_t>((curr_depth - 1) * context->radix_bits);
+        // Scatter left and right relation based on prefix sum
+        helpers::radix_scatter(data_l, size_l, shift, context->radix_bits, sum_l, target_l);
+        helpers::radix_scatter(data_r, size_r, shift, context->radix_bits, sum_r, target_r);
         // Create new partition or probe/build tasks
         if(spawn){
             // Number of partitions created by this scatter task
@@ -111,61 +156,460 @@ namespace algorithms{
                  * to the first index of the next partition
                  */
                 for(uint64_t k = 0; k < part_count - 1; ++k){
-                    context->pool->enqueue(partition_task::execute, context, true, curr_depth + 1,
-                           target_l + (*sum_l)[k], target_r + (*sum_r)[k], (*sum_l)[k + 1] - (*sum_l)[k],
-                           (*sum_r)[k + 1] - (*sum_r)[k], data_l + (*sum_l)[k], data_r + (*sum_r)[k]);
+                    context->tasks->post(partition_task::execute, context, true, curr_depth + 1,
+                           target_l + sum_l[k], target_r + sum_r[k], sum_l[k + 1] - sum_l[k],
+                           sum_r[k + 1] - sum_r[k], data_l + sum_l[k], data_r + sum_r[k]);
                 }
                 // Fencepost, the first partition was not scheduled in the previous loop
-                context->pool->enqueue(partition_task::execute, context, true, curr_depth + 1,
-                           target_l, target_r, (*sum_l)[0], (*sum_r)[0], data_l, data_r);
+                context->tasks->post(partition_task::execute, context, true, curr_depth + 1,
+                           target_l, target_r, sum_l[0], sum_r[0], data_l, data_r);
             }
             // We create regular probe passes since we are in the deepest partition level
             else{
                 // Nearly same as before when scheduling next round of partition passes, just have to pass less data
                 for(uint64_t k = 0; k < part_count - 1; ++k){
-                    context->pool->enqueue(join_task::execute, context, target_l + (*sum_l)[k], target_r + (*sum_r)[k],
-                                           (*sum_l)[k + 1] - (*sum_l)[k], (*sum_r)[k + 1] - (*sum_r)[k]);
+                    context->tasks->post(leaf_task::execute, context, target_l + sum_l[k], target_r + sum_r[k],
+                                        sum_l[k + 1] - sum_l[k], sum_r[k + 1] - sum_r[k]);
                 }
                 // Fencepost, the first partition was not scheduled in the previous loop
-                context->pool->enqueue(join_task::execute, context, target_l, target_r, (*sum_l)[0], (*sum_r)[0]);
+                context->tasks->post(leaf_task::execute, context, target_l, target_r, sum_l[0], sum_r[0]);
             }
         }
+        // The prefix sums are no longer needed, hand them back for the next partition task on this worker
+        size_t owner = context->histogram_owner();
+        context->histograms.release(owner, sum_l);
+        context->histograms.release(owner, sum_r);
         return true;
     }
 
+    void leaf_task::execute(task_context* context, tuple* data_l, tuple* data_r, uint64_t size_l, uint64_t size_r){
+        context->leaf(context, data_l, data_r, size_l, size_r);
+    }
+
     void join_task::execute(task_context* context, tuple* data_l, tuple* data_r, uint64_t size_l, uint64_t size_r){
-        // Check if this was the final join task, if so finish up the thread pool
-        uint64_t value = ++(context->join_count);
-        // Notify the waiting call to execute() in radix_join_mt that we are finished
-        if(value == context->join_exp){
-            {
-                std::lock_guard<std::mutex> lk(context -> join_wait);
-                context -> finished = true;
-            }
-            (context -> wait).notify_one();
+        // No need to bother on empty partitions, unless the non-empty side has to be preserved
+        if((size_l == 0 || size_r == 0) && !(size_r == 0 && size_l > 0 && helpers::preserves_left(context->type))
+                                        && !(size_l == 0 && size_r > 0 && helpers::preserves_right(context->type))){
+            return;
         }
-
-        // No need to bother on empty partitions
-        if(size_l == 0 || size_r == 0){
+        // Oversized partitions would serialize the tail of the join, their probe side gets split
+        if(size_l > 0 && size_r > context->split_threshold){
+            split_join_task::execute(context, data_l, data_r, size_l, size_r);
             return;
         }
         // First we obtain a valid output buffer
-        std::unique_lock<std::mutex> lock(context -> output_mutex, std::defer_lock);
-        lock.lock();
-        uint8_t index = context->free_index.back();
-        context->free_index.pop_back();
-        lock.unlock();
+        uint8_t index = context->acquire_output();
         // We get that output buffer, since we wil have to write to it
         auto& output = (context->results)[index];
         // Run a simple no partitioning join on the given data, due to nop semantics output gets moved
-        nop_join join(data_l, data_r, size_l, size_r, context->table_size, output);
+        // The nop join also scans the partition's table for unmatched build tuples in case of outer joins
+        nop_join join(data_l, data_r, size_l, size_r, context->table_size, output, context->type);
         join.execute();
+        context->leaf_buckets += join.buckets();
         // We reclaim the vector and put it back into the results vectors
         (context->results)[index] = std::move(join.get());
         // We put the output buffer back into the unused stack
-        lock.lock();
-        context->free_index.emplace_back(index);
-        lock.unlock();
+        context->release_output(index);
+    }
+
+    void in_place_task::execute(task_context* context, uint8_t curr_depth, tuple* data_l, tuple* data_r,
+                                uint64_t size_l, uint64_t size_r) {
+        size_t owner = context->histogram_owner();
+        uint64_t* hist_l = context->histograms.acquire(owner);
+        uint64_t* hist_r = context->histograms.acquire(owner);
+        auto shift = static_cast<uint8_t>((curr_depth - 1) * context->radix_bits);
+        helpers::radix_histogram(data_l, size_l, shift, context->radix_bits, hist_l);
+        helpers::radix_histogram(data_r, size_r, shift, context->radix_bits, hist_r);
+        permute(context, curr_depth, data_l, hist_l);
+        permute(context, curr_depth, data_r, hist_r);
+        // Spawn the next pass or the leaves on the partitions which are now contiguous
+        uint64_t part_count = static_cast<uint64_t>(1) << static_cast<uint64_t>(context->radix_bits);
+        for(uint64_t k = 0; k < part_count; ++k){
+            if(curr_depth < context->radix_passes){
+                context->tasks->post(in_place_task::execute, context, curr_depth + 1, data_l, data_r, hist_l[k],
+                                     hist_r[k]);
+            } else {
+                context->tasks->post(leaf_task::execute, context, data_l, data_r, hist_l[k], hist_r[k]);
+            }
+            data_l += hist_l[k];
+            data_r += hist_r[k];
+        }
+        owner = context->histogram_owner();
+        context->histograms.release(owner, hist_l);
+        context->histograms.release(owner, hist_r);
+    }
+
+    void in_place_task::permute(task_context* context, uint8_t curr_depth, tuple* data, const uint64_t* hist) {
+        size_t owner = context->histogram_owner();
+        uint64_t* heads = context->histograms.acquire(owner);
+        uint64_t* ends = context->histograms.acquire(owner);
+        uint64_t part_count = static_cast<uint64_t>(1) << static_cast<uint64_t>(context->radix_bits);
+        uint64_t sum = 0;
+        for(uint64_t k = 0; k < part_count; ++k){
+            heads[k] = sum;
+            sum += hist[k];
+            ends[k] = sum;
+        }
+        auto shift = static_cast<uint8_t>((curr_depth - 1) * context->radix_bits);
+        helpers::radix_permute(data, shift, context->radix_bits, heads, ends);
+        context->histograms.release(owner, heads);
+        context->histograms.release(owner, ends);
+    }
+
+    void in_place_task::permute_parallel(task_context* context, uint8_t curr_depth, tuple* data,
+                                         const uint64_t* hist) {
+        uint8_t threads = context->thread_count;
+        uint8_t bits = context->radix_bits;
+        uint64_t part_count = static_cast<uint64_t>(1) << static_cast<uint64_t>(bits);
+        auto shift = static_cast<uint8_t>((curr_depth - 1) * bits);
+        uint64_t mask = part_count - 1;
+        std::vector<uint64_t> heads(part_count);
+        std::vector<uint64_t> ends(part_count);
+        uint64_t remaining = 0;
+        for(uint64_t k = 0; k < part_count; ++k){
+            heads[k] = remaining;
+            remaining += hist[k];
+            ends[k] = remaining;
+        }
+        /*
+         * Speculative rounds: every task permutes its own stripe of every partition, tuples whose partition
+         * stripe is full stay behind. The repair step then moves the tuples of each partition in front of the
+         * misplaced ones, which form the much smaller input of the next round.
+         */
+        std::vector<std::vector<uint64_t>> stripe_heads(threads, std::vector<uint64_t>(part_count));
+        std::vector<std::vector<uint64_t>> stripe_ends(threads, std::vector<uint64_t>(part_count));
+        std::vector<std::future<void>> vec(threads);
+        while(threads > 1 && remaining >= threads * min_speculative){
+            for(uint8_t t = 0; t < threads; ++t){
+                for(uint64_t p = 0; p < part_count; ++p){
+                    uint64_t range = ends[p] - heads[p];
+                    stripe_heads[t][p] = heads[p] + range * t / threads;
+                    stripe_ends[t][p] = heads[p] + range * (t + 1) / threads;
+                }
+                vec[t] = context->pool->enqueue([&, t]{
+                    helpers::radix_permute_bounded(data, shift, bits, stripe_heads[t].data(), stripe_ends[t].data());
+                });
+            }
+            for(auto& curr: vec){
+                curr.get();
+            }
+            std::atomic<uint64_t> cursor(0);
+            for(uint8_t t = 0; t < threads; ++t){
+                vec[t] = context->pool->enqueue([&]{
+                    for(uint64_t p = cursor++; p < part_count; p = cursor++){
+                        uint64_t i = heads[p];
+                        uint64_t j = ends[p];
+                        while(i < j){
+                            if(helpers::radix(helpers::murmur3(std::get<0>(data[i])), shift, mask) == p){
+                                ++i;
+                                continue;
+                            }
+                            --j;
+                            while(i < j && helpers::radix(helpers::murmur3(std::get<0>(data[j])), shift, mask) != p){
+                                --j;
+                            }
+                            if(i < j){
+                                std::swap(data[i++], data[j]);
+                            }
+                        }
+                        heads[p] = i;
+                    }
+                });
+            }
+            for(auto& curr: vec){
+                curr.get();
+            }
+            uint64_t left = 0;
+            for(uint64_t p = 0; p < part_count; ++p){
+                left += ends[p] - heads[p];
+            }
+            // Rounds stop paying off once hardly any tuple finds its place anymore
+            if(2 * left > remaining){
+                remaining = left;
+                break;
+            }
+            remaining = left;
+        }
+        // The misplaced rest is exactly what the cycles of the sequential kernel expect
+        helpers::radix_permute(data, shift, bits, heads.data(), ends.data());
+    }
+
+    split_join_task::shared_build::shared_build(uint64_t table_size, tuple* data_r, uint64_t chunks):
+        table(table_size > 0 ? table_size : 1), data_r(data_r), remaining(chunks)
+    {}
+
+    void split_join_task::execute(task_context* context, tuple* data_l, tuple* data_r, uint64_t size_l,
+                                  uint64_t size_r) {
+        uint64_t chunks = (size_r + context->split_chunk - 1) / context->split_chunk;
+        auto build = std::make_shared<shared_build>(static_cast<uint64_t>(context->table_size * size_l), data_r,
+                                                    chunks);
+        context->leaf_buckets += build->table.size;
+        for(uint64_t k = 0; k < size_l; ++k){
+            build->table.insert(data_l[k]);
+        }
+        // The chunks share the table, the last one to finish releases it
+        for(uint64_t c = 0; c < chunks; ++c){
+            uint64_t start = c * context->split_chunk;
+            context->tasks->post(split_join_task::probe, context, build, start,
+                                 std::min(start + context->split_chunk, size_r));
+        }
+    }
+
+    void split_join_task::probe(task_context* context, std::shared_ptr<shared_build> build, uint64_t start,
+                                uint64_t end) {
+        bool outer_l = helpers::preserves_left(context->type);
+        bool outer_r = helpers::preserves_right(context->type);
+        uint8_t index = context->acquire_output();
+        auto& output = (context->results)[index];
+        for(uint64_t k = start; k < end; ++k){
+            tuple& curr = build->data_r[k];
+            bool found = build->table.probe(curr, outer_l, output);
+            if(outer_r && !found){
+                output.emplace_back(std::get<0>(curr), helpers::null_rid, std::get<1>(curr));
+            }
+        }
+        // All match flags are visible to the last chunk, it emits the unmatched build tuples
+        if(--(build->remaining) == 0 && outer_l){
+            build->table.scan(0, build->table.size, output);
+        }
+        context->release_output(index);
+    }
+
+    namespace {
+
+        /**
+         * Drives the partitioning, first pass is coordinated from the calling thread. The inputs are split into
+         * 'ranges' ranges of range_l and range_r tuples, the last ones taking the remainder. Every range pair
+         * gets its own histogram and scatter task. If given, the waits are called for every range before it is
+         * touched, so the histograms of the first ranges get built while the later ones are still arriving.
+         */
+        void run_passes(task_context* context, task::tuple* left, task::tuple* right, uint64_t size_l,
+                        uint64_t size_r, task::tuple* target_l, task::tuple* target_r, task::tuple* scratch_l,
+                        task::tuple* scratch_r, uint64_t ranges, uint64_t range_l, uint64_t range_r,
+                        const input_wait* wait_l, const input_wait* wait_r) {
+            typedef std::pair<uint64_t*, uint64_t*> histograms;
+            typedef task::tuple tuple;
+            uint8_t bits_per_pass = context->radix_bits;
+            uint8_t passes = context->radix_passes;
+            size_t owner = context->histogram_owner();
+            init_split(context, size_r);
+            // Bounds of the ranges, the last ones reach the end of the inputs
+            std::vector<uint64_t> start_l(ranges), start_r(ranges), end_l(ranges), end_r(ranges);
+            for(uint64_t k = 0; k < ranges; ++k){
+                bool last = k == ranges - 1;
+                start_l[k] = std::min(k * range_l, size_l);
+                start_r[k] = std::min(k * range_r, size_r);
+                end_l[k] = last ? size_l : std::min((k + 1) * range_l, size_l);
+                end_r[k] = last ? size_r : std::min((k + 1) * range_r, size_r);
+            }
+            // Will get unlocked once all partition tasks are finished
+            std::vector<std::future<histograms>> vec(ranges);
+            // Schedule the first round of partition tasks, each one as soon as its range is available
+            for(uint64_t k = 0; k < ranges; ++k){
+                try {
+                    if(wait_l != nullptr){
+                        (*wait_l)(start_l[k], end_l[k]);
+                    }
+                    if(wait_r != nullptr){
+                        (*wait_r)(start_r[k], end_r[k]);
+                    }
+                } catch(...) {
+                    // Ranges scheduled already still reference the context, they have to finish first
+                    for(uint64_t j = 0; j < k; ++j){
+                        histograms res = vec[j].get();
+                        context->histograms.release(owner, res.first);
+                        context->histograms.release(owner, res.second);
+                    }
+                    throw;
+                }
+                vec[k] = context->pool->enqueue(partition_task::execute, context, false, 1, left + start_l[k],
+                        right + start_r[k], end_l[k] - start_l[k], end_r[k] - start_r[k], nullptr, nullptr);
+            }
+            std::vector<histograms> res(ranges);
+            // Get all histograms of the first partition runs
+            for(uint64_t k = 0; k < ranges; ++k){
+                res[k] = vec[k].get();
+            }
+            // The following code builds history and prefix sums
+            uint64_t part_count = (static_cast<uint64_t>(1) << static_cast<uint64_t>(bits_per_pass));
+            // Global histogram
+            std::vector<uint64_t> hist_l(part_count);
+            std::vector<uint64_t> hist_r(part_count);
+            // Build sum over the partition arrays creating global histogram
+            for(uint64_t n = 0; n < ranges; ++n){
+                for(uint64_t k = 0; k < part_count; ++k){
+                    (hist_l)[k] += res[n].first[k];
+                    (hist_r)[k] += res[n].second[k];
+                }
+            }
+            // Vectors containing the prefix sum
+            std::vector<uint64_t> sum_l(part_count);
+            std::vector<uint64_t> sum_r(part_count);
+            // Build the actual prefix sum
+            uint64_t cl = (hist_l)[0];
+            uint64_t cr = (hist_r)[0];
+            sum_l[0] = 0;
+            sum_r[0] = 0;
+            for(uint64_t k = 1; k < part_count; ++k){
+                sum_l[k] = cl;
+                sum_r[k] = cr;
+                cl += hist_l[k];
+                cr += hist_r[k];
+            }
+
+            /*
+             * With NUMA placement every node owns a contiguous range of partitions. Their target memory is bound
+             * to it before the scatter writes the first tuple, so the following passes and joins read locally.
+             */
+            uint64_t node_count = context->numa != nullptr ? context->numa->nodes() : 1;
+            auto nodes = static_cast<uint32_t>(std::min(node_count, part_count));
+            for(uint32_t node = 0; nodes > 1 && node < nodes; ++node){
+                uint64_t first = node * part_count / nodes;
+                uint64_t last = (node + 1) * part_count / nodes;
+                uint64_t end_l = last < part_count ? sum_l[last] : size_l;
+                uint64_t end_r = last < part_count ? sum_r[last] : size_r;
+                if(!context->numa->bind(target_l + sum_l[first], (end_l - sum_l[first]) * sizeof(tuple), node,
+                                        context->numa_page, false)){
+                    ++context->unbound;
+                }
+                if(!context->numa->bind(target_r + sum_r[first], (end_r - sum_r[first]) * sizeof(tuple), node,
+                                        context->numa_page, false)){
+                    ++context->unbound;
+                }
+            }
+
+            /*
+             * Now we can create the first group of scatter tasks.
+             * For this we have to assign each thread a unique local partition within the target array.
+             * Similar to the build process in the creation of the prefix sums we perform deferred additions
+             * of the thread's histograms onto the prefix sum.
+             * Since we are working on fairly small vectors here all data should still be L1 residing.
+             */
+            std::vector<std::future<bool>> scatter_vec(ranges);
+            // Running offsets, every scatter task gets its own arena copy which it releases once done
+            auto localsum_l = sum_l;
+            auto localsum_r = sum_r;
+            for(uint64_t k = 0; k < ranges; ++k){
+                uint64_t* local_l = context->histograms.acquire(owner);
+                uint64_t* local_r = context->histograms.acquire(owner);
+                std::memcpy(local_l, localsum_l.data(), part_count * sizeof(uint64_t));
+                std::memcpy(local_r, localsum_r.data(), part_count * sizeof(uint64_t));
+                scatter_vec[k] = context->pool->enqueue(scatter_task::execute, context, false, 1, local_l, local_r,
+                        left + start_l[k], right + start_r[k], end_l[k] - start_l[k], end_r[k] - start_r[k],
+                        target_l, target_r);
+                // Update the sum vectors with thread's histogram data
+                for(uint64_t j = 0; j < part_count; ++j){
+                    localsum_l[j] += res[k].first[j];
+                    localsum_r[j] += res[k].second[j];
+                }
+                context->histograms.release(owner, res[k].first);
+                context->histograms.release(owner, res[k].second);
+            }
+            // Join Scatter tasks again, as the first round forms a barrier
+            for(uint64_t k = 0; k < ranges; ++k){
+                scatter_vec[k].get();
+            }
+
+            // If we are only running one pass we now have to schedule the final build and probe tasks
+            if(passes == 1){
+                // Schedule partition tasks, on the node owning the partition if placement is enabled
+                for(uint64_t k = 0; k < part_count; ++k){
+                    if(nodes > 1){
+                        context->tasks->post_on(static_cast<uint32_t>(k * nodes / part_count), leaf_task::execute,
+                                                context, target_l + sum_l[k], target_r + sum_r[k], hist_l[k], hist_r[k]);
+                    } else {
+                        context->tasks->post(leaf_task::execute, context, target_l + sum_l[k], target_r + sum_r[k],
+                                             hist_l[k], hist_r[k]);
+                    }
+                }
+            }
+            // We have to perform more partitions and scatters
+            else {
+                // We schedule the second round of partition tasks, but this time with automatic subtask spawning.
+                // Deeper tasks are spawned locally by the worker, so they stay on the owning node.
+                for(uint64_t k = 0; k < part_count; ++k){
+                    if(nodes > 1){
+                        context->tasks->post_on(static_cast<uint32_t>(k * nodes / part_count), partition_task::execute,
+                                                context, true, 2, target_l + sum_l[k], target_r + sum_r[k], hist_l[k],
+                                                hist_r[k], scratch_l + sum_l[k], scratch_r + sum_r[k]);
+                    } else {
+                        context->tasks->post(partition_task::execute, context, true, 2, target_l + sum_l[k],
+                                             target_r + sum_r[k], hist_l[k], hist_r[k], scratch_l + sum_l[k],
+                                             scratch_r + sum_r[k]);
+                    }
+                }
+            }
+            // Wait until all spawned partition, scatter and leaf tasks are finished
+            context->tasks->wait();
+        }
+
+    }  // namespace
+
+    void radix_run::execute(task_context* context, tuple* left, tuple* right, uint64_t size_l, uint64_t size_r,
+                            tuple* target_l, tuple* target_r) {
+        execute(context, left, right, size_l, size_r, target_l, target_r, left, right);
+    }
+
+    void radix_run::execute(task_context* context, tuple* left, tuple* right, uint64_t size_l, uint64_t size_r,
+                            tuple* target_l, tuple* target_r, tuple* scratch_l, tuple* scratch_r) {
+        // One range per thread, the inputs are available already
+        uint8_t threads = context->thread_count;
+        run_passes(context, left, right, size_l, size_r, target_l, target_r, scratch_l, scratch_r, threads,
+                   size_l / threads, size_r / threads, nullptr, nullptr);
+    }
+
+    void radix_run::execute_streamed(task_context* context, tuple* left, tuple* right, uint64_t size_l,
+                                     uint64_t size_r, tuple* target_l, tuple* target_r, tuple* scratch_l,
+                                     tuple* scratch_r, uint64_t chunk, const input_wait& wait_l,
+                                     const input_wait& wait_r) {
+        chunk = std::max<uint64_t>(chunk, 1);
+        uint64_t ranges = std::max<uint64_t>(std::max((size_l + chunk - 1) / chunk, (size_r + chunk - 1) / chunk), 1);
+        run_passes(context, left, right, size_l, size_r, target_l, target_r, scratch_l, scratch_r, ranges, chunk,
+                   chunk, &wait_l, &wait_r);
+    }
+
+    void radix_run::execute_in_place(task_context* context, tuple* left, tuple* right, uint64_t size_l,
+                                     uint64_t size_r) {
+        typedef std::pair<uint64_t*, uint64_t*> histograms;
+        uint8_t threads = context->thread_count;
+        size_t owner = context->histogram_owner();
+        init_split(context, size_r);
+        // The histograms of the first pass are built in parallel just like in the scattering variant
+        std::vector<std::future<histograms>> vec(threads);
+        uint64_t range_l = size_l / threads;
+        uint64_t range_r = size_r / threads;
+        for(uint8_t k = 0; k < threads; ++k){
+            bool last = k == threads - 1;
+            vec[k] = context->pool->enqueue(partition_task::execute, context, false, 1, left + (k*range_l),
+                    right + (k*range_r), last ? size_l - (k*range_l) : range_l,
+                    last ? size_r - (k*range_r) : range_r, nullptr, nullptr);
+        }
+        uint64_t part_count = (static_cast<uint64_t>(1) << static_cast<uint64_t>(context->radix_bits));
+        std::vector<uint64_t> hist_l(part_count);
+        std::vector<uint64_t> hist_r(part_count);
+        for(uint8_t k = 0; k < threads; ++k){
+            histograms res = vec[k].get();
+            for(uint64_t j = 0; j < part_count; ++j){
+                hist_l[j] += res.first[j];
+                hist_r[j] += res.second[j];
+            }
+            context->histograms.release(owner, res.first);
+            context->histograms.release(owner, res.second);
+        }
+        // Swap cycles cross the whole array, the tasks of every side permute disjoint stripes and get repaired
+        in_place_task::permute_parallel(context, 1, left, hist_l.data());
+        in_place_task::permute_parallel(context, 1, right, hist_r.data());
+        // Deeper passes and the leaves work on disjoint partitions and run in parallel
+        for(uint64_t k = 0; k < part_count; ++k){
+            if(context->radix_passes > 1){
+                context->tasks->post(in_place_task::execute, context, 2, left, right, hist_l[k], hist_r[k]);
+            } else {
+                context->tasks->post(leaf_task::execute, context, left, right, hist_l[k], hist_r[k]);
+            }
+            left += hist_l[k];
+            right += hist_r[k];
+        }
+        context->tasks->wait();
     }
 
-} // namespace algorithms
\ No newline at end of file
+} // namespace algorithms
@@ -3,6 +3,7 @@
 //
 
 #include "algorithms/nop_join.h"
+#include <algorithm>
 #include <utility>
 
 namespace algorithms{
@@ -12,20 +13,34 @@ namespace algorithms{
 
     nop_join::nop_join(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r, double table_size):
             left(left), right(right), size_l(size_l), size_r(size_r),
-            table_size(table_size), built(false), result(){}
+            table_size(table_size), type(helpers::join_type::inner), built(false), table_buckets(0), result(){}
 
     nop_join::nop_join(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r,
                        double table_size, std::vector<triple>& result):
+            nop_join(left, right, size_l, size_r, table_size, result, helpers::join_type::inner){}
+
+    nop_join::nop_join(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r,
+                       double table_size, std::vector<triple>& result, helpers::join_type type):
                                 left(left), right(right), size_l(size_l), size_r(size_r),
-                                table_size(table_size), built(false), result(std::move(result)){}
+                                table_size(table_size), type(type), built(false), table_buckets(0),
+                                result(std::move(result)){}
 
     void nop_join::execute() {
-        // No results on empty datasets
+        bool outer_l = helpers::preserves_left(type);
+        bool outer_r = helpers::preserves_right(type);
+        // No matches on empty datasets, only the preserved sides have to be emitted
         if(size_l == 0 || size_r == 0){
             built = true;
+            for(uint64_t k = 0; outer_l && size_r == 0 && k < size_l; ++k){
+                result.emplace_back(std::get<0>(left[k]), std::get<1>(left[k]), helpers::null_rid);
+            }
+            for(uint64_t k = 0; outer_r && size_l == 0 && k < size_r; ++k){
+                result.emplace_back(std::get<0>(right[k]), helpers::null_rid, std::get<1>(right[k]));
+            }
             return;
         }
-        auto new_size = static_cast<uint64_t>(1.5 * size_l);
+        auto new_size = std::max<uint64_t>(static_cast<uint64_t>(table_size * size_l), 1);
+        table_buckets = new_size;
         helpers::hash_table table = helpers::hash_table(new_size);
         // Build Phase
         for(uint64_t k = 0; k < size_l; ++k){
@@ -59,12 +74,17 @@ namespace algorithms{
             tuple& curr = right[k];
             uint64_t index = helpers::murmur3(std::get<0>(curr)) % new_size;
             helpers::hash_table::bucket& bucket = table.arr[index];
+            bool found = false;
             // Follow overflow buckets
             if(bucket.count > 2){
                 helpers::overflow* curr_over = bucket.next.get();
                 for(uint64_t i = 0; i < static_cast<uint64_t>(bucket.count - 2); ++i){
                     if(std::get<0>(curr_over->t) == std::get<0>(curr)){
                         result.emplace_back(std::get<0>(curr_over->t), std::get<1>(curr_over->t), std::get<1>(curr));
+                        found = true;
+                        if(outer_l){
+                            curr_over->matched.store(true, std::memory_order_relaxed);
+                        }
                     }
                     curr_over = curr_over->next.get();
                 }
@@ -72,10 +92,41 @@ namespace algorithms{
             // Look at second tuple
             if(bucket.count > 1 && std::get<0>(bucket.t2) == std::get<0>(curr)){
                 result.emplace_back(std::get<0>(bucket.t2), std::get<1>(bucket.t2), std::get<1>(curr));
+                found = true;
+                if(outer_l){
+                    bucket.matched |= 2;
+                }
             }
             // Look at first tuple
             if(bucket.count > 0 && std::get<0>(bucket.t1) == std::get<0>(curr)){
                 result.emplace_back(std::get<0>(bucket.t1), std::get<1>(bucket.t1), std::get<1>(curr));
+                found = true;
+                if(outer_l){
+                    bucket.matched |= 1;
+                }
+            }
+            // Probe tuple without partner in a right or full outer join
+            if(outer_r && !found){
+                result.emplace_back(std::get<0>(curr), helpers::null_rid, std::get<1>(curr));
+            }
+        }
+        // Emit all build tuples which never found a partner
+        if(outer_l){
+            for(uint64_t k = 0; k < new_size; ++k){
+                helpers::hash_table::bucket& bucket = table.arr[k];
+                if(bucket.count > 0 && !(bucket.matched & 1)){
+                    result.emplace_back(std::get<0>(bucket.t1), std::get<1>(bucket.t1), helpers::null_rid);
+                }
+                if(bucket.count > 1 && !(bucket.matched & 2)){
+                    result.emplace_back(std::get<0>(bucket.t2), std::get<1>(bucket.t2), helpers::null_rid);
+                }
+                helpers::overflow* curr_over = bucket.next.get();
+                while(curr_over != nullptr){
+                    if(!curr_over->matched.load(std::memory_order_relaxed)){
+                        result.emplace_back(std::get<0>(curr_over->t), std::get<1>(curr_over->t), helpers::null_rid);
+                    }
+                    curr_over = curr_over->next.get();
+                }
             }
         }
     }
@@ -87,6 +138,10 @@ namespace algorithms{
         return result;
     }
 
+    uint64_t nop_join::buckets() const {
+        return table_buckets;
+    }
+
     void nop_join::set(std::vector<nop_join::triple> &res_vec) {
         // The vector is moved for maximum performance. The vector cannot be used by the caller afterwards.
         result = std::move(res_vec);
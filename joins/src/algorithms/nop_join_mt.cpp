@@ -3,9 +3,9 @@
 //
 
 #include "algorithms/nop_join_mt.h"
+#include <algorithm>
 #include <utility>
 #include <mutex>
-#include <thread>
 
 namespace algorithms{
 
@@ -15,107 +15,220 @@ namespace algorithms{
 
     nop_join_mt::nop_join_mt(tuple* left, tuple* right, uint64_t size_l,
                              uint64_t size_r, double table_size, uint8_t threads):
+            nop_join_mt(left, right, size_l, size_r, table_size, threads, helpers::join_type::inner)
+    {}
+
+    nop_join_mt::nop_join_mt(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r,
+                             double table_size, uint8_t threads, helpers::join_type type):
+            nop_join_mt(left, right, size_l, size_r, table_size, threads, type, default_morsel)
+    {}
+
+    nop_join_mt::nop_join_mt(tuple* left, tuple* right, uint64_t size_l, uint64_t size_r,
+                             double table_size, uint8_t threads, helpers::join_type type, uint64_t morsel_size):
             left(left), right(right), size_l(size_l), size_r(size_r),
-            table_size(table_size), threads(threads), built(false), result(threads)
+            table_size(table_size), threads(threads), type(type), morsel_size(morsel_size),
+            placement(table_placement::single), unbound(0), built(false),
+            exec(&helpers::executor::global()), result(threads)
     {}
 
     void nop_join_mt::execute() {
-        // No results on empty datasets
+        // No matches on empty datasets, only the preserved sides have to be emitted
         if(size_l == 0 || size_r == 0){
             built = true;
+            if(result.empty()){
+                result.resize(1);
+            }
+            for(uint64_t k = 0; helpers::preserves_left(type) && size_r == 0 && k < size_l; ++k){
+                result[0].emplace_back(std::get<0>(left[k]), std::get<1>(left[k]), helpers::null_rid);
+            }
+            for(uint64_t k = 0; helpers::preserves_right(type) && size_l == 0 && k < size_r; ++k){
+                result[0].emplace_back(std::get<0>(right[k]), helpers::null_rid, std::get<1>(right[k]));
+            }
             return;
         }
         built = true;
-        helpers::latched_hash_table table(static_cast<uint64_t>(table_size * size_l));
+        helpers::executor::ticket admission(*exec, threads);
+        // Joins running concurrently may leave fewer workers than requested
+        auto workers = static_cast<uint8_t>(admission.granted());
+        helpers::executor::task_group tasks(*exec);
+        const helpers::numa_topology& topology = exec->topology();
+        uint32_t nodes = table_nodes();
+        helpers::numa_hash_table table(static_cast<uint64_t>(table_size * size_l), nodes);
+        /*
+         * Every phase posts one task per granted worker, the tasks then claim morsels through a shared cursor
+         * until the input is exhausted. Slow or descheduled threads simply claim fewer morsels.
+         */
+        std::atomic<uint64_t> cursor(0);
         // Build Phase:
-        // Chunk size per thread
-        uint64_t offset = size_l/threads;
-        std::vector<std::thread> thread_vec{};
-        // Start all threads except for the final one
-        for(uint8_t curr_t = 0; curr_t < threads - 1; ++curr_t){
-            thread_vec.emplace_back(&nop_join_mt::build, this, curr_t * offset, (curr_t + 1) * offset, &table);
-        }
-        // Start final thread
-        thread_vec.emplace_back(&nop_join_mt::build, this,(threads - 1) * offset, size_l, &table);
-        // Join threads again, afterwards build phase is done
-        for(uint8_t curr_t = 0; curr_t < threads; ++curr_t){
-            thread_vec[curr_t].join();
-        }
-        // Probe Phase:
-        std::vector<std::thread> thread_vec2{};
-        offset = size_r/threads;
-        for(uint8_t curr_t = 0; curr_t < threads - 1; ++curr_t){
-            thread_vec2.emplace_back(&nop_join_mt::probe, this, curr_t * offset,
-                    (curr_t + 1) * offset, &table, curr_t);
-        }
-        // Start final thread
-        thread_vec2.emplace_back(&nop_join_mt::probe, this,(threads - 1) * offset, size_r,
-                &table, threads - 1);
-        // Join threads again, afterwards probe phase is done as well
-        for(uint8_t curr_t = 0; curr_t < threads; ++curr_t){
-            thread_vec2[curr_t].join();
-        }
-    }
-
-    void nop_join_mt::build(uint64_t start, uint64_t end, helpers::latched_hash_table* table) {
-        for(uint64_t k = start; k < end; ++k) {
-            tuple &curr = left[k];
-            uint64_t index = helpers::murmur3(std::get<0>(curr)) % table->size;
-            helpers::latched_hash_table::bucket &bucket = table->arr[index];
-            // Critical Section
-            bucket.lock.lock();
-            // Follow overflow buckets
-            switch (bucket.count) {
-                case 0:
-                    bucket.t1 = curr;
-                    break;
-                case 1:
-                    bucket.t2 = curr;
-                    break;
-                case 2:
-                    bucket.next = std::make_unique<helpers::overflow>(curr);
-                    break;
-                default:
-                    helpers::overflow *ptr = bucket.next.get();
-                    // Follow pointer indirection
-                    for (uint64_t i = 0; i < static_cast<uint64_t>(bucket.count - 3); i++) {
-                        ptr = ptr->next.get();
-                    }
-                    // Create new bucket containing tuple
-                    ptr->next = std::make_unique<helpers::overflow>(curr);
+        uint64_t morsel = morsel_for(size_l);
+        // Node local tasks are spread over all nodes, even if there are fewer threads
+        uint32_t node_tasks = std::max<uint32_t>(workers, nodes);
+        std::unique_ptr<std::atomic<uint64_t>[]> node_cursors(new std::atomic<uint64_t>[nodes]());
+        if(nodes == 1){
+            table.allocate(0, 0, topology);
+            for(uint8_t curr_t = 0; curr_t < workers; ++curr_t){
+                tasks.post(&nop_join_mt::build, this, &cursor, morsel, &table);
             }
-            ++bucket.count;
-            bucket.lock.unlock();
+        } else {
+            // Every node creates its chunk, then the tuples get sorted by node and inserted node locally
+            for(uint32_t node = 0; node < nodes; ++node){
+                tasks.post_on(node, [&table, &topology, node]{ table.allocate(node, node, topology); });
+            }
+            tasks.wait();
+            std::vector<std::vector<tuple>> staged(((size_l + morsel - 1) / morsel) * nodes);
+            for(uint8_t curr_t = 0; curr_t < workers; ++curr_t){
+                tasks.post(&nop_join_mt::stage, this, &cursor, morsel, &table, &staged);
+            }
+            tasks.wait();
+            for(uint32_t k = 0; k < node_tasks; ++k){
+                tasks.post_on(k % nodes, &nop_join_mt::insert_staged, this, &node_cursors[k % nodes], k % nodes,
+                              &table, &staged);
+            }
+            // The staged tuples have to outlive the inserting tasks
+            tasks.wait();
+        }
+        // Wait for all build tasks, afterwards build phase is done
+        tasks.wait();
+        uint64_t scan_morsel = morsel_for(table.size());
+        // Replication Phase, every node copies the finished table into its own memory:
+        std::vector<std::unique_ptr<helpers::numa_hash_table>> replicas;
+        if(placement == table_placement::replicated && nodes > 1 && !helpers::preserves_left(type)){
+            for(uint32_t node = 0; node < nodes; ++node){
+                replicas.emplace_back(new helpers::numa_hash_table(table.size(), 1));
+                tasks.post_on(node, [&replicas, &topology, node]{ replicas[node]->allocate(0, node, topology); });
+            }
+            tasks.wait();
+            for(uint32_t k = 0; k < nodes; ++k){
+                node_cursors[k] = 0;
+            }
+            for(uint32_t k = 0; k < node_tasks; ++k){
+                tasks.post_on(k % nodes, &nop_join_mt::replicate, this, &node_cursors[k % nodes], scan_morsel,
+                              replicas[k % nodes].get(), &table);
+            }
+            tasks.wait();
+        }
+        // Probe Phase, every probe morsel gets its own output vector:
+        morsel = morsel_for(size_r);
+        uint64_t probe_morsels = (size_r + morsel - 1) / morsel;
+        uint64_t scan_morsels = helpers::preserves_left(type) ? (table.size() + scan_morsel - 1) / scan_morsel : 0;
+        unbound = table.unbound_chunks();
+        for(auto& replica: replicas){
+            unbound += replica->unbound_chunks();
+        }
+        // Vectors handed in through set() are kept, results get appended to them
+        if(result.size() < probe_morsels + scan_morsels){
+            result.resize(probe_morsels + scan_morsels);
+        }
+        cursor = 0;
+        for(uint8_t curr_t = 0; curr_t < workers; ++curr_t){
+            tasks.post(&nop_join_mt::probe, this, &cursor, morsel, &table, &replicas);
+        }
+        // Wait for all probe tasks, afterwards probe phase is done as well
+        tasks.wait();
+        // Scan Phase, only needed if unmatched build tuples have to be emitted:
+        if(helpers::preserves_left(type)){
+            cursor = 0;
+            for(uint8_t curr_t = 0; curr_t < workers; ++curr_t){
+                tasks.post(&nop_join_mt::scan, this, &cursor, scan_morsel, &table, probe_morsels);
+            }
+            tasks.wait();
         }
     }
 
-    void nop_join_mt::probe(uint64_t start, uint64_t end, helpers::latched_hash_table* table, uint8_t t_num) {
-        for(uint64_t k = start; k < end; ++k){
-            tuple& curr = right[k];
-            auto& vec = result[t_num];
-            uint64_t index = helpers::murmur3(std::get<0>(curr)) % table->size;
-            helpers::latched_hash_table::bucket& bucket = table->arr[index];
-            // Follow overflow buckets
-            if(bucket.count > 2){
-                helpers::overflow* curr_over = bucket.next.get();
-                for(uint64_t i = 0; i < static_cast<uint64_t>(bucket.count - 2); ++i){
-                    if(std::get<0>(curr_over->t) == std::get<0>(curr)){
-                        vec.emplace_back(std::get<0>(curr_over->t), std::get<1>(curr_over->t), std::get<1>(curr));
-                    }
-                    curr_over = curr_over->next.get();
-                }
+    uint64_t nop_join_mt::morsel_for(uint64_t size) const {
+        if(morsel_size > 0){
+            return morsel_size;
+        }
+        // Static mode, one equally sized range per thread
+        uint64_t range = (size + threads - 1) / threads;
+        return range > 0 ? range : 1;
+    }
+
+    uint32_t nop_join_mt::table_nodes() const {
+        return placement == table_placement::single ? 1 : exec->topology().nodes();
+    }
+
+    void nop_join_mt::build(std::atomic<uint64_t>* cursor, uint64_t morsel, helpers::numa_hash_table* table) {
+        for(uint64_t start = cursor->fetch_add(morsel); start < size_l; start = cursor->fetch_add(morsel)){
+            build_range(start, std::min(start + morsel, size_l), table);
+        }
+    }
+
+    void nop_join_mt::stage(std::atomic<uint64_t>* cursor, uint64_t morsel, helpers::numa_hash_table* table,
+                            std::vector<std::vector<tuple>>* staged) {
+        uint32_t nodes = table->nodes();
+        for(uint64_t start = cursor->fetch_add(morsel); start < size_l; start = cursor->fetch_add(morsel)){
+            auto first = staged->begin() + (start / morsel) * nodes;
+            for(uint64_t k = start; k < std::min(start + morsel, size_l); ++k){
+                first[table->node_of(std::get<0>(left[k]))].push_back(left[k]);
             }
-            // Look at second tuple
-            if(bucket.count > 1 && std::get<0>(bucket.t2) == std::get<0>(curr)){
-                vec.emplace_back(std::get<0>(bucket.t2), std::get<1>(bucket.t2), std::get<1>(curr));
+        }
+    }
+
+    void nop_join_mt::insert_staged(std::atomic<uint64_t>* cursor, uint32_t node, helpers::numa_hash_table* table,
+                                    std::vector<std::vector<tuple>>* staged) {
+        uint32_t nodes = table->nodes();
+        uint64_t morsels = staged->size() / nodes;
+        for(uint64_t m = cursor->fetch_add(1); m < morsels; m = cursor->fetch_add(1)){
+            for(auto& curr: (*staged)[m * nodes + node]){
+                table->insert(curr);
             }
-            // Look at first tuple
-            if(bucket.count > 0 && std::get<0>(bucket.t1) == std::get<0>(curr)){
-                vec.emplace_back(std::get<0>(bucket.t1), std::get<1>(bucket.t1), std::get<1>(curr));
+        }
+    }
+
+    void nop_join_mt::replicate(std::atomic<uint64_t>* cursor, uint64_t morsel, helpers::numa_hash_table* replica,
+                                helpers::numa_hash_table* table) {
+        uint64_t size = table->size();
+        for(uint64_t start = cursor->fetch_add(morsel); start < size; start = cursor->fetch_add(morsel)){
+            replica->copy_from(*table, start, std::min(start + morsel, size));
+        }
+    }
+
+    void nop_join_mt::probe(std::atomic<uint64_t>* cursor, uint64_t morsel, helpers::numa_hash_table* table,
+                            std::vector<std::unique_ptr<helpers::numa_hash_table>>* replicas) {
+        // Replicas are chosen by the node of the running worker, a stolen task probes its thief's copy
+        if(!replicas->empty()){
+            long worker = exec->pool().current_worker();
+            table = (*replicas)[worker >= 0 ? exec->topology().node_of_worker(worker) : 0].get();
+        }
+        for(uint64_t start = cursor->fetch_add(morsel); start < size_r; start = cursor->fetch_add(morsel)){
+            probe_range(start, std::min(start + morsel, size_r), table, result[start / morsel]);
+        }
+    }
+
+    void nop_join_mt::scan(std::atomic<uint64_t>* cursor, uint64_t morsel, helpers::numa_hash_table* table,
+                           uint64_t first) {
+        uint64_t size = table->size();
+        for(uint64_t start = cursor->fetch_add(morsel); start < size; start = cursor->fetch_add(morsel)){
+            scan_range(start, std::min(start + morsel, size), table, result[first + start / morsel]);
+        }
+    }
+
+    void nop_join_mt::build_range(uint64_t start, uint64_t end, helpers::numa_hash_table* table) {
+        for(uint64_t k = start; k < end; ++k) {
+            table->insert(left[k]);
+        }
+    }
+
+    void nop_join_mt::probe_range(uint64_t start, uint64_t end, helpers::numa_hash_table* table,
+                                  std::vector<triple>& vec) {
+        bool outer_l = helpers::preserves_left(type);
+        bool outer_r = helpers::preserves_right(type);
+        for(uint64_t k = start; k < end; ++k){
+            tuple& curr = right[k];
+            bool found = table->probe(curr, outer_l, vec);
+            // Probe tuple without partner in a right or full outer join
+            if(outer_r && !found){
+                vec.emplace_back(std::get<0>(curr), helpers::null_rid, std::get<1>(curr));
             }
         }
     }
 
+    void nop_join_mt::scan_range(uint64_t start, uint64_t end, helpers::numa_hash_table* table,
+                                 std::vector<triple>& vec) {
+        table->scan(start, end, vec);
+    }
+
     std::vector<std::vector<nop_join_mt::triple>>& nop_join_mt::get(){
         if(!built){
             throw std::logic_error("Join must be performed before querying results.");
@@ -130,4 +243,21 @@ namespace algorithms{
         built = false;
     }
 
+    void nop_join_mt::set_plan(const join_plan& plan) {
+        morsel_size = plan.morsel_size;
+        table_size = plan.table_size;
+    }
+
+    uint32_t nop_join_mt::unbound_chunks() const {
+        return unbound;
+    }
+
+    void nop_join_mt::set_placement(table_placement placement) {
+        this->placement = placement;
+    }
+
+    void nop_join_mt::set_executor(helpers::executor& exec) {
+        this->exec = &exec;
+    }
+
 } // namespace algorithms
@@ -0,0 +1,149 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "algorithms/numa.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace helpers {
+
+    namespace {
+
+        /// Preferred instead of strict binding, a full node spills over instead of failing the allocation
+        constexpr int mpol_preferred = 1;
+        /// Moves pages of the range which are already placed elsewhere
+        constexpr unsigned mpol_mf_move = 1 << 1;
+
+        uint32_t hardware_threads() {
+            return std::max<uint32_t>(std::thread::hardware_concurrency(), 1);
+        }
+
+    }  // namespace
+
+    numa_topology::numa_topology(): ids{0}, cpus(1), fake_nodes(false) {
+        for(uint32_t cpu = 0; cpu < hardware_threads(); ++cpu){
+            cpus[0].push_back(cpu);
+        }
+    }
+
+    numa_topology numa_topology::detect() {
+        numa_topology topology;
+        std::vector<uint32_t> online;
+        std::ifstream online_in("/sys/devices/system/node/online");
+        std::string list;
+        if(!(online_in >> list)){
+            return topology;
+        }
+        online = parse_cpulist(list);
+        std::vector<uint32_t> ids;
+        std::vector<std::vector<uint32_t>> cpus;
+        for(uint32_t node: online){
+            std::ifstream cpus_in("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+            std::string node_list;
+            // Memory only nodes have an empty list and cannot run workers
+            if(cpus_in >> node_list){
+                ids.push_back(node);
+                cpus.push_back(parse_cpulist(node_list));
+            }
+        }
+        if(!ids.empty()){
+            topology.ids = std::move(ids);
+            topology.cpus = std::move(cpus);
+        }
+        return topology;
+    }
+
+    numa_topology numa_topology::fake(uint32_t nodes, uint32_t cpus_per_node) {
+        numa_topology topology;
+        nodes = std::max<uint32_t>(nodes, 1);
+        cpus_per_node = std::max<uint32_t>(cpus_per_node, 1);
+        topology.ids.clear();
+        topology.cpus.assign(nodes, {});
+        topology.fake_nodes = true;
+        for(uint32_t node = 0; node < nodes; ++node){
+            topology.ids.push_back(node);
+            for(uint32_t k = 0; k < cpus_per_node; ++k){
+                // Simulated CPUs wrap around the existing ones so pinning still succeeds
+                topology.cpus[node].push_back((node * cpus_per_node + k) % hardware_threads());
+            }
+        }
+        return topology;
+    }
+
+    std::vector<uint32_t> numa_topology::parse_cpulist(const std::string& list) {
+        std::vector<uint32_t> result;
+        std::istringstream in(list);
+        std::string range;
+        while(std::getline(in, range, ',')){
+            if(range.empty()){
+                continue;
+            }
+            auto dash = range.find('-');
+            try {
+                uint32_t first = std::stoul(range.substr(0, dash));
+                uint32_t last = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+                for(uint32_t cpu = first; cpu <= last; ++cpu){
+                    result.push_back(cpu);
+                }
+            } catch(const std::logic_error&){
+                throw std::runtime_error("Malformed CPU list: " + list);
+            }
+        }
+        return result;
+    }
+
+    uint32_t numa_topology::nodes() const {
+        return static_cast<uint32_t>(ids.size());
+    }
+
+    bool numa_topology::simulated() const {
+        return fake_nodes;
+    }
+
+    uint32_t numa_topology::node_of_worker(size_t worker) const {
+        return static_cast<uint32_t>(worker % ids.size());
+    }
+
+    uint32_t numa_topology::cpu_of_worker(size_t worker) const {
+        auto& node = cpus[node_of_worker(worker)];
+        return node[(worker / ids.size()) % node.size()];
+    }
+
+    bool numa_topology::pin_current(uint32_t cpu) const {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu % CPU_SETSIZE, &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+    }
+
+    bool numa_topology::bind(void* addr, size_t bytes, uint32_t node, bool migrate) const {
+        return bind(addr, bytes, node, static_cast<size_t>(sysconf(_SC_PAGESIZE)), migrate);
+    }
+
+    bool numa_topology::bind(void* addr, size_t bytes, uint32_t node, size_t page, bool migrate) const {
+        if(fake_nodes || ids.size() < 2 || bytes == 0){
+            return true;
+        }
+        // Only whole pages can be placed, the partial ones at the borders are left to first touch
+        auto start = (reinterpret_cast<uintptr_t>(addr) + page - 1) / page * page;
+        auto end = (reinterpret_cast<uintptr_t>(addr) + bytes) / page * page;
+        if(end <= start){
+            return true;
+        }
+        uint32_t id = ids[node];
+        std::vector<unsigned long> mask(id / (8 * sizeof(unsigned long)) + 1, 0);
+        mask[id / (8 * sizeof(unsigned long))] |= 1UL << (id % (8 * sizeof(unsigned long)));
+        long status = syscall(SYS_mbind, start, end - start, mpol_preferred, mask.data(),
+                              mask.size() * 8 * sizeof(unsigned long), migrate ? mpol_mf_move : 0);
+        return status == 0;
+    }
+
+}  // namespace helpers
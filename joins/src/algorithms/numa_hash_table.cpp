@@ -0,0 +1,96 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "algorithms/numa_hash_table.h"
+#include <algorithm>
+
+namespace helpers {
+
+    numa_hash_table::numa_hash_table(uint64_t size, uint32_t nodes):
+        buckets(std::max<uint64_t>(size, 1)), starts(std::max<uint32_t>(nodes, 1) + 1), chunks(starts.size() - 1),
+        unbound(0)
+    {
+        uint64_t count = chunks.size();
+        // Chunk n starts at the first bucket b with b * count / buckets == n
+        for(uint64_t n = 0; n <= count; ++n){
+            starts[n] = (n * buckets + count - 1) / count;
+        }
+    }
+
+    void numa_hash_table::allocate(uint32_t chunk, uint32_t node, const numa_topology& topology) {
+        uint64_t length = starts[chunk + 1] - starts[chunk];
+        chunks[chunk] = std::make_unique<latched_hash_table>(length);
+        // Constructing the buckets touched the pages, they are moved if a foreign node ran the allocation
+        auto& arr = chunks[chunk]->arr;
+        if(!topology.bind(arr.get(), length * sizeof(latched_hash_table::bucket), node, page_bytes(arr.pages()), true)){
+            ++unbound;
+        }
+    }
+
+    uint32_t numa_hash_table::unbound_chunks() const {
+        return unbound;
+    }
+
+    uint32_t numa_hash_table::nodes() const {
+        return static_cast<uint32_t>(chunks.size());
+    }
+
+    uint64_t numa_hash_table::size() const {
+        return buckets;
+    }
+
+    std::pair<uint32_t, uint64_t> numa_hash_table::locate(uint64_t key) const {
+        uint64_t bucket = murmur3(key) % buckets;
+        if(chunks.size() == 1){
+            return {0, bucket};
+        }
+        auto node = static_cast<uint32_t>(static_cast<unsigned __int128>(bucket) * chunks.size() / buckets);
+        return {node, bucket - starts[node]};
+    }
+
+    uint32_t numa_hash_table::node_of(uint64_t key) const {
+        return locate(key).first;
+    }
+
+    void numa_hash_table::insert(const tuple& curr) {
+        auto slot = locate(std::get<0>(curr));
+        chunks[slot.first]->insert_at(slot.second, curr);
+    }
+
+    bool numa_hash_table::probe(const tuple& curr, bool mark, std::vector<triple>& out) {
+        auto slot = locate(std::get<0>(curr));
+        return chunks[slot.first]->probe_at(slot.second, curr, mark, out);
+    }
+
+    void numa_hash_table::scan(uint64_t start, uint64_t end, std::vector<triple>& out) {
+        for(uint32_t node = 0; node < chunks.size(); ++node){
+            // Intersection of the range with the chunk
+            uint64_t first = std::max(start, starts[node]);
+            uint64_t last = std::min(end, starts[node + 1]);
+            if(first < last){
+                chunks[node]->scan(first - starts[node], last - starts[node], out);
+            }
+        }
+    }
+
+    void numa_hash_table::copy_from(numa_hash_table& other, uint64_t start, uint64_t end) {
+        for(uint32_t node = 0; node < other.chunks.size(); ++node){
+            uint64_t first = std::max(start, other.starts[node]);
+            uint64_t last = std::min(end, other.starts[node + 1]);
+            for(uint64_t k = first; k < last; ++k){
+                auto& b = other.chunks[node]->arr[k - other.starts[node]];
+                if(b.count > 0){
+                    insert(b.t1);
+                }
+                if(b.count > 1){
+                    insert(b.t2);
+                }
+                for(overflow* curr = b.next.get(); curr != nullptr; curr = curr->next.get()){
+                    insert(curr->t);
+                }
+            }
+        }
+    }
+
+}  // namespace helpers
@@ -0,0 +1,156 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "algorithms/page_allocator.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace helpers {
+
+    namespace {
+
+        /// Default page mode, initialized from the environment on first use
+        std::atomic<page_mode>& default_mode() {
+            static std::atomic<page_mode> mode([]{
+                const char* name = std::getenv("HASHJOINS_PAGES");
+                return name != nullptr ? parse_pages(name) : page_mode::automatic;
+            }());
+            return mode;
+        }
+
+        size_t round_up(size_t bytes, size_t alignment) {
+            return (bytes + alignment - 1) / alignment * alignment;
+        }
+
+    }  // namespace
+
+    page_mode default_pages() {
+        return default_mode().load();
+    }
+
+    void set_default_pages(page_mode mode) {
+        default_mode() = mode;
+    }
+
+    page_mode parse_pages(const std::string& name) {
+        if(name == "small"){
+            return page_mode::small;
+        }
+        if(name == "transparent"){
+            return page_mode::transparent;
+        }
+        if(name == "huge"){
+            return page_mode::huge;
+        }
+        if(name == "auto"){
+            return page_mode::automatic;
+        }
+        throw std::invalid_argument("Unknown page mode '" + name + "'.");
+    }
+
+    std::string page_name(page_mode mode) {
+        switch(mode){
+            case page_mode::small:
+                return "small";
+            case page_mode::transparent:
+                return "transparent";
+            case page_mode::huge:
+                return "huge";
+            default:
+                return "auto";
+        }
+    }
+
+    page_buffer::page_buffer(size_t bytes): page_buffer(bytes, default_pages()) {}
+
+    page_buffer::page_buffer(size_t bytes, page_mode mode):
+            memory(nullptr), bytes(bytes), mapped(0), obtained(page_mode::small) {
+        if(bytes == 0){
+            return;
+        }
+        if(mode == page_mode::automatic){
+            // Less than one huge page gains nothing from larger pages
+            mode = bytes >= huge_page_bytes ? page_mode::huge : page_mode::small;
+        }
+        // Every kind of page falls back to the next smaller one
+        if(mode == page_mode::huge && map(page_mode::huge)){
+            return;
+        }
+        if(mode != page_mode::small && map(page_mode::transparent)){
+            return;
+        }
+        if(!map(page_mode::small)){
+            throw std::bad_alloc();
+        }
+    }
+
+    bool page_buffer::map(page_mode mode) {
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+        size_t length = bytes;
+        if(mode == page_mode::huge){
+            // Fails right away if the hugetlb pool has not enough pages reserved
+            length = round_up(bytes, huge_page_bytes);
+            flags |= MAP_HUGETLB;
+        } else if(mode == page_mode::transparent){
+            // Over allocate to align the start, the kernel only backs aligned 2 MiB ranges with huge pages
+            length = round_up(bytes, huge_page_bytes) + huge_page_bytes;
+        }
+        void* raw = mmap(nullptr, length, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if(raw == MAP_FAILED){
+            return false;
+        }
+        if(mode == page_mode::transparent){
+            auto start = reinterpret_cast<uintptr_t>(raw);
+            uintptr_t aligned = round_up(start, huge_page_bytes);
+            size_t used = round_up(bytes, huge_page_bytes);
+            // Give back the unaligned head and the tail behind the buffer
+            if(aligned > start){
+                munmap(raw, aligned - start);
+            }
+            if(start + length > aligned + used){
+                munmap(reinterpret_cast<void*>(aligned + used), start + length - aligned - used);
+            }
+            raw = reinterpret_cast<void*>(aligned);
+            length = used;
+            if(madvise(raw, length, MADV_HUGEPAGE) != 0){
+                // Transparent huge pages are disabled, the mapping is still usable with small pages
+                mode = page_mode::small;
+            }
+        }
+        memory = raw;
+        mapped = length;
+        obtained = mode;
+        return true;
+    }
+
+    page_buffer::~page_buffer() {
+        if(memory != nullptr){
+            munmap(memory, mapped);
+        }
+    }
+
+    size_t page_bytes(page_mode obtained) {
+        if(obtained == page_mode::huge){
+            return huge_page_bytes;
+        }
+        return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    }
+
+    void* page_buffer::data() {
+        return memory;
+    }
+
+    size_t page_buffer::size() const {
+        return bytes;
+    }
+
+    page_mode page_buffer::pages() const {
+        return obtained;
+    }
+
+}  // namespace helpers
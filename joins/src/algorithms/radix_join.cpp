@@ -19,13 +19,8 @@ namespace algorithms{
 
 
     void radix_join::partition(tuple* data_s, tuple* data_t, uint64_t* hist, uint64_t count) {
-        // Pattern filtering the bits we are looking at
-        uint64_t pattern = part_count - 1;
         // Create histogram of the hash values
-        for(uint64_t i = 0; i < count; ++i){
-            uint64_t index = (helpers::murmur3(std::get<0>(data_s[i])) & pattern);
-            hist[index]++;
-        }
+        helpers::radix_histogram(data_s, count, 0, part_bits, hist);
         // Build prefix sum
         uint64_t sum = hist[0];
         hist[0] = 0;
@@ -35,11 +30,7 @@ namespace algorithms{
             sum += temp;
         }
         // Scatter tuples into destination
-        for(uint64_t i = 0; i < count; ++i){
-            uint64_t index = (helpers::murmur3(std::get<0>(data_s[i])) & pattern);
-            uint64_t write_to = hist[index]++;
-            data_t[write_to] = data_s[i];
-        }
+        helpers::radix_scatter(data_s, count, 0, part_bits, hist, data_t);
     }
 
     void radix_join::execute() {
@@ -0,0 +1,96 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "algorithms/radix_partitioner.h"
+#include "algorithms/hash_helpers.h"
+#include <stdexcept>
+
+namespace algorithms {
+
+    radix_partitioner::radix_partitioner(tuple* data, uint64_t size, uint8_t shift, uint8_t bits, uint8_t threads):
+            radix_partitioner(data, size, shift, bits, threads, nullptr) {
+        owned = std::make_unique<helpers::page_buffer>(size * sizeof(tuple));
+        target = owned->as<tuple>();
+    }
+
+    radix_partitioner::radix_partitioner(tuple* data, uint64_t size, uint8_t shift, uint8_t bits, uint8_t threads,
+                                         tuple* target):
+            data(data), size(size), shift(shift), bits(bits), threads(threads > 0 ? threads : 1), built(false),
+            exec(&helpers::executor::global()), owned(nullptr), target(target), bounds() {
+        if(bits >= 32 || shift + bits > 64){
+            throw std::invalid_argument("Partition bits have to lie within the 64 bit hash and create < 2^32 partitions.");
+        }
+    }
+
+    void radix_partitioner::execute() {
+        helpers::executor::ticket admission(*exec, threads);
+        helpers::executor::task_group tasks(*exec);
+        // Operators running concurrently may leave fewer workers than requested
+        partition(tasks, static_cast<uint8_t>(admission.granted()));
+    }
+
+    void radix_partitioner::execute(helpers::executor::task_group& tasks) {
+        partition(tasks, threads);
+    }
+
+    void radix_partitioner::partition(helpers::executor::task_group& tasks, uint8_t chunks) {
+        uint64_t parts = part_count();
+        uint64_t range = size / chunks;
+        // Every task builds the histogram of its own chunk
+        std::vector<std::vector<uint64_t>> hist(chunks, std::vector<uint64_t>(parts));
+        auto run = [&](uint8_t t, bool scatter){
+            uint64_t start = t * range;
+            uint64_t count = (t == chunks - 1) ? size - start : range;
+            if(scatter){
+                helpers::radix_scatter(data + start, count, shift, bits, hist[t].data(), target);
+            } else {
+                helpers::radix_histogram(data + start, count, shift, bits, hist[t].data());
+            }
+        };
+        auto parallel = [&](bool scatter){
+            for(uint8_t t = 0; t < chunks; ++t){
+                tasks.post(run, t, scatter);
+            }
+            tasks.wait();
+        };
+        parallel(false);
+        // Turn the histograms into the write offsets of every chunk, partition by partition
+        bounds.assign(parts + 1, 0);
+        uint64_t sum = 0;
+        for(uint64_t p = 0; p < parts; ++p){
+            bounds[p] = sum;
+            for(uint8_t t = 0; t < chunks; ++t){
+                uint64_t temp = hist[t][p];
+                hist[t][p] = sum;
+                sum += temp;
+            }
+        }
+        bounds[parts] = sum;
+        parallel(true);
+        built = true;
+    }
+
+    radix_partitioner::tuple* radix_partitioner::get() {
+        if(!built){
+            throw std::logic_error("Partitioning must be performed before querying results.");
+        }
+        return target;
+    }
+
+    std::vector<uint64_t>& radix_partitioner::get_bounds() {
+        if(!built){
+            throw std::logic_error("Partitioning must be performed before querying results.");
+        }
+        return bounds;
+    }
+
+    void radix_partitioner::set_executor(helpers::executor& exec) {
+        this->exec = &exec;
+    }
+
+    uint64_t radix_partitioner::part_count() const {
+        return static_cast<uint64_t>(1) << bits;
+    }
+
+}  // namespace algorithms
@@ -0,0 +1,218 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "algorithms/relation_file.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace helpers {
+
+    namespace {
+
+        constexpr char relation_magic[8] = "HJREL01";
+        /// Records start on their own page, so mappings of them are page aligned
+        constexpr uint64_t record_offset = 4096;
+
+        static_assert(sizeof(relation_writer::tuple) == 2 * sizeof(uint64_t), "Tuples have to be packed");
+        static_assert(sizeof(relation_writer::triple) == 3 * sizeof(uint64_t), "Triples have to be packed");
+
+        std::string io_error(const std::string& what, const std::string& path) {
+            return what + " " + path + ": " + std::strerror(errno);
+        }
+
+        void write_all(int fd, const void* data, uint64_t bytes, uint64_t offset, const std::string& path) {
+            auto curr = static_cast<const char*>(data);
+            while(bytes > 0){
+                ssize_t done = pwrite(fd, curr, bytes, static_cast<off_t>(offset));
+                if(done < 0 && errno == EINTR){
+                    continue;
+                }
+                if(done <= 0){
+                    throw std::runtime_error(io_error("Could not write", path));
+                }
+                curr += done;
+                bytes -= done;
+                offset += done;
+            }
+        }
+
+        /// Reads and validates the header, 'length' receives the size of the file
+        bool load_header(int fd, relation_header& head, uint64_t& length) {
+            struct stat info{};
+            if(fstat(fd, &info) != 0 || static_cast<uint64_t>(info.st_size) < sizeof(head)
+               || pread(fd, &head, sizeof(head), 0) != static_cast<ssize_t>(sizeof(head))){
+                return false;
+            }
+            length = static_cast<uint64_t>(info.st_size);
+            return std::memcmp(head.magic, relation_magic, sizeof(head.magic)) == 0
+                   && head.key_width == sizeof(uint64_t) && (head.columns == 2 || head.columns == 3)
+                   && head.offset % record_offset == 0
+                   && head.offset + head.count * head.columns * sizeof(uint64_t) <= length;
+        }
+
+    }  // namespace
+
+    relation_writer::relation_writer(const std::string& path, uint32_t columns): fd(-1), path(path), header() {
+        if(columns != 2 && columns != 3){
+            throw std::invalid_argument("Relation files have two or three columns.");
+        }
+        std::memcpy(header.magic, relation_magic, sizeof(header.magic));
+        header.columns = columns;
+        header.key_width = sizeof(uint64_t);
+        header.min_key = std::numeric_limits<uint64_t>::max();
+        header.max_key = 0;
+        header.offset = record_offset;
+        fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if(fd < 0){
+            throw std::runtime_error(io_error("Could not create", path));
+        }
+    }
+
+    relation_writer::~relation_writer() {
+        if(fd >= 0){
+            try {
+                finish();
+            } catch(const std::runtime_error&) {
+                if(fd >= 0){
+                    close(fd);
+                }
+            }
+        }
+    }
+
+    void relation_writer::append(const tuple* data, uint64_t count) {
+        uint64_t min_key = std::numeric_limits<uint64_t>::max();
+        uint64_t max_key = 0;
+        for(uint64_t k = 0; k < count; ++k){
+            min_key = std::min(min_key, std::get<0>(data[k]));
+            max_key = std::max(max_key, std::get<0>(data[k]));
+        }
+        write(data, count, 2, min_key, max_key);
+    }
+
+    void relation_writer::append(const triple* data, uint64_t count) {
+        uint64_t min_key = std::numeric_limits<uint64_t>::max();
+        uint64_t max_key = 0;
+        for(uint64_t k = 0; k < count; ++k){
+            min_key = std::min(min_key, std::get<0>(data[k]));
+            max_key = std::max(max_key, std::get<0>(data[k]));
+        }
+        write(data, count, 3, min_key, max_key);
+    }
+
+    void relation_writer::write(const void* data, uint64_t count, uint32_t columns, uint64_t min_key,
+                                uint64_t max_key) {
+        if(fd < 0){
+            throw std::logic_error("Relation file was already finished.");
+        }
+        if(columns != header.columns){
+            throw std::invalid_argument("Records do not match the columns of the relation file.");
+        }
+        uint64_t record = columns * sizeof(uint64_t);
+        write_all(fd, data, count * record, header.offset + header.count * record, path);
+        header.count += count;
+        header.min_key = std::min(header.min_key, min_key);
+        header.max_key = std::max(header.max_key, max_key);
+    }
+
+    void relation_writer::finish() {
+        if(fd < 0){
+            return;
+        }
+        write_all(fd, &header, sizeof(header), 0, path);
+        // Empty files still have to reach the record offset
+        if(ftruncate(fd, static_cast<off_t>(header.offset + header.count * header.columns * sizeof(uint64_t))) != 0){
+            throw std::runtime_error(io_error("Could not resize", path));
+        }
+        if(close(fd) != 0){
+            fd = -1;
+            throw std::runtime_error(io_error("Could not close", path));
+        }
+        fd = -1;
+    }
+
+    void write_relation(const std::string& path, const std::vector<std::tuple<uint64_t, uint64_t>>& data) {
+        relation_writer writer(path, 2);
+        writer.append(data.data(), data.size());
+        writer.finish();
+    }
+
+    void write_result(const std::string& path,
+                      const std::vector<std::vector<std::tuple<uint64_t, uint64_t, uint64_t>>>& result) {
+        relation_writer writer(path, 3);
+        for(auto& vec: result){
+            writer.append(vec.data(), vec.size());
+        }
+        writer.finish();
+    }
+
+    relation_header read_relation_header(const std::string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if(fd < 0){
+            throw std::runtime_error(io_error("Could not open", path));
+        }
+        relation_header head{};
+        uint64_t length = 0;
+        bool valid = load_header(fd, head, length);
+        close(fd);
+        if(!valid){
+            throw std::runtime_error("Not a relation file: " + path);
+        }
+        return head;
+    }
+
+    mapped_relation::mapped_relation(const std::string& path): mapping(nullptr), length(0), head() {
+        int fd = open(path.c_str(), O_RDONLY);
+        if(fd < 0){
+            throw std::runtime_error(io_error("Could not open", path));
+        }
+        if(!load_header(fd, head, length)){
+            close(fd);
+            throw std::runtime_error("Not a relation file: " + path);
+        }
+        mapping = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if(mapping == MAP_FAILED){
+            mapping = nullptr;
+            std::string error = io_error("Could not map", path);
+            close(fd);
+            throw std::runtime_error(error);
+        }
+        // The mapping keeps the file alive on its own
+        close(fd);
+    }
+
+    mapped_relation::~mapped_relation() {
+        munmap(mapping, length);
+    }
+
+    const relation_header& mapped_relation::header() const {
+        return head;
+    }
+
+    uint64_t mapped_relation::size() const {
+        return head.count;
+    }
+
+    mapped_relation::tuple* mapped_relation::tuples() {
+        if(head.columns != 2){
+            throw std::logic_error("Relation file holds join results.");
+        }
+        return reinterpret_cast<tuple*>(static_cast<char*>(mapping) + head.offset);
+    }
+
+    mapped_relation::triple* mapped_relation::triples() {
+        if(head.columns != 3){
+            throw std::logic_error("Relation file holds no join results.");
+        }
+        return reinterpret_cast<triple*>(static_cast<char*>(mapping) + head.offset);
+    }
+
+}  // namespace helpers
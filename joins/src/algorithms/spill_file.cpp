@@ -0,0 +1,110 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "algorithms/spill_file.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace helpers {
+
+    namespace {
+
+        std::string io_error(const std::string& what) {
+            return what + ": " + std::strerror(errno);
+        }
+
+    }  // namespace
+
+    std::string default_spill_directory() {
+        const char* dir = std::getenv("TMPDIR");
+        return dir != nullptr && *dir != '\0' ? dir : "/tmp";
+    }
+
+    spill_file::spill_file(const std::string& directory, uint64_t buffer_bytes):
+            fd(-1), capacity(std::max<uint64_t>(buffer_bytes / sizeof(tuple), 1)), written(0) {
+        std::string path = directory + "/hashjoins_spill_XXXXXX";
+        std::vector<char> name(path.begin(), path.end());
+        name.push_back('\0');
+        fd = mkstemp(name.data());
+        if(fd < 0){
+            throw std::runtime_error(io_error("Could not create spill file in " + directory));
+        }
+        // Nobody else needs the name, the space is reclaimed as soon as the descriptor gets closed
+        unlink(name.data());
+    }
+
+    spill_file::~spill_file() {
+        close(fd);
+    }
+
+    void spill_file::append(const tuple* data, uint64_t count) {
+        if(buffer.capacity() < capacity){
+            buffer.reserve(capacity);
+        }
+        while(count > 0){
+            uint64_t step = std::min(count, capacity - buffer.size());
+            buffer.insert(buffer.end(), data, data + step);
+            data += step;
+            count -= step;
+            if(buffer.size() == capacity){
+                flush();
+            }
+        }
+    }
+
+    void spill_file::finish() {
+        flush();
+        std::vector<tuple>().swap(buffer);
+    }
+
+    uint64_t spill_file::size() const {
+        return written + buffer.size();
+    }
+
+    void spill_file::flush() {
+        auto bytes = reinterpret_cast<const char*>(buffer.data());
+        uint64_t remaining = buffer.size() * sizeof(tuple);
+        auto offset = static_cast<off_t>(written * sizeof(tuple));
+        while(remaining > 0){
+            ssize_t done = pwrite(fd, bytes, remaining, offset);
+            if(done < 0 && errno == EINTR){
+                continue;
+            }
+            if(done <= 0){
+                throw std::runtime_error(io_error("Could not write spill file"));
+            }
+            bytes += done;
+            remaining -= done;
+            offset += done;
+        }
+        written += buffer.size();
+        buffer.clear();
+    }
+
+    void spill_file::read(uint64_t start, uint64_t count, tuple* target) const {
+        if(start + count > written){
+            throw std::out_of_range("Spilled tuples have to be written out before reading them.");
+        }
+        auto bytes = reinterpret_cast<char*>(target);
+        uint64_t remaining = count * sizeof(tuple);
+        auto offset = static_cast<off_t>(start * sizeof(tuple));
+        while(remaining > 0){
+            ssize_t done = pread(fd, bytes, remaining, offset);
+            if(done < 0 && errno == EINTR){
+                continue;
+            }
+            if(done <= 0){
+                throw std::runtime_error(io_error("Could not read spill file"));
+            }
+            bytes += done;
+            remaining -= done;
+            offset += done;
+        }
+    }
+
+}  // namespace helpers
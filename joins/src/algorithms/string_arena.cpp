@@ -0,0 +1,60 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "algorithms/string_arena.h"
+#include "algorithms/hash_helpers.h"
+#include <algorithm>
+#include <cstring>
+
+namespace helpers {
+
+    uint64_t string_arena::add(const char* data, uint64_t length) {
+        entry e{chars.size(), length, 0};
+        std::memcpy(&e.prefix, data, std::min<uint64_t>(length, sizeof(e.prefix)));
+        chars.insert(chars.end(), data, data + length);
+        entries.push_back(e);
+        return entries.size() - 1;
+    }
+
+    uint64_t string_arena::add(const std::string& str) {
+        return add(str.data(), str.size());
+    }
+
+    uint64_t string_arena::size() const {
+        return entries.size();
+    }
+
+    std::string string_arena::get(uint64_t index) const {
+        const entry& e = entries[index];
+        return std::string(chars.data() + e.offset, e.length);
+    }
+
+    uint64_t string_arena::hash(uint64_t index) const {
+        const entry& e = entries[index];
+        const char* data = chars.data() + e.offset;
+        // Fold the string in eight byte words, the prefix already holds the first one
+        uint64_t hash = murmur3(e.length ^ e.prefix);
+        for(uint64_t k = sizeof(uint64_t); k < e.length; k += sizeof(uint64_t)){
+            uint64_t word = 0;
+            std::memcpy(&word, data + k, std::min<uint64_t>(e.length - k, sizeof(word)));
+            hash = murmur3(hash ^ word);
+        }
+        return hash;
+    }
+
+    bool string_arena::equal(uint64_t index, const string_arena& other, uint64_t other_index) const {
+        const entry& e = entries[index];
+        const entry& o = other.entries[other_index];
+        if(e.length != o.length || e.prefix != o.prefix){
+            return false;
+        }
+        // Prefix covers short strings completely
+        if(e.length <= sizeof(e.prefix)){
+            return true;
+        }
+        return std::memcmp(chars.data() + e.offset + sizeof(e.prefix), other.chars.data() + o.offset + sizeof(o.prefix),
+                           e.length - sizeof(e.prefix)) == 0;
+    }
+
+}  // namespace helpers
@@ -0,0 +1,58 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "algorithms/string_join_mt.h"
+#include "algorithms/fingerprint_join.h"
+#include <stdexcept>
+#include <utility>
+
+namespace algorithms {
+
+    string_join_mt::string_join_mt(const helpers::string_arena& left, const helpers::string_arena& right):
+            string_join_mt(left, right, 1.5, 4, 0, 0) {}
+
+    string_join_mt::string_join_mt(const helpers::string_arena& left, const helpers::string_arena& right,
+                                   double table_size, uint8_t threads, uint8_t bits_per_pass, uint8_t passes):
+            left(left), right(right), table_size(table_size), threads(threads), bits_per_pass(bits_per_pass),
+            passes(passes), built(false), exec(&helpers::executor::global()), result(threads) {}
+
+    void string_join_mt::execute() {
+        built = true;
+        uint64_t size_l = left.size();
+        uint64_t size_r = right.size();
+        // No results on empty datasets
+        if(size_l == 0 || size_r == 0){
+            return;
+        }
+        // Reduce the strings of both sides to (hash, index) tuples
+        std::vector<helpers::tuple> hashed_l(size_l);
+        std::vector<helpers::tuple> hashed_r(size_r);
+        fingerprint::rows(hashed_l.data(), size_l, threads, *exec, [this](uint64_t row){ return left.hash(row); });
+        fingerprint::rows(hashed_r.data(), size_r, threads, *exec, [this](uint64_t row){ return right.hash(row); });
+        // Join on the hashes, then compare prefixes and characters of all candidates
+        fingerprint::join(hashed_l.data(), hashed_r.data(), size_l, size_r, table_size, threads, bits_per_pass,
+                          passes, *exec, [this](uint64_t row_l, uint64_t row_r){
+            return left.equal(row_l, right, row_r);
+        }, result);
+    }
+
+    std::vector<std::vector<string_join_mt::pair>>& string_join_mt::get() {
+        if(!built){
+            throw std::logic_error("Join must be performed before querying results.");
+        }
+        return result;
+    }
+
+    void string_join_mt::set(std::vector<std::vector<string_join_mt::pair>> &res_vec) {
+        // The vector is moved for maximum performance. The vector cannot be used by the caller afterwards.
+        result = std::move(res_vec);
+        // Set built to false again, since data was not built into the new vector
+        built = false;
+    }
+
+    void string_join_mt::set_executor(helpers::executor& exec) {
+        this->exec = &exec;
+    }
+
+}  // namespace algorithms
@@ -0,0 +1,124 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "algorithms/symmetric_join.h"
+#include <algorithm>
+#include <utility>
+
+namespace algorithms {
+
+    symmetric_join::pane::pane(uint64_t capacity, double table_size):
+            table(std::max<uint64_t>(static_cast<uint64_t>(table_size * capacity), 1)), capacity(capacity),
+            count(0) {}
+
+    symmetric_join::symmetric_join(): symmetric_join(0, 0, 1.5, 1) {}
+
+    symmetric_join::symmetric_join(uint64_t window, uint32_t panes, double table_size, uint8_t threads):
+            pane_size(unbounded_pane), pane_count(0), table_size(table_size), threads(threads > 0 ? threads : 1),
+            exec(&helpers::executor::global()) {
+        if(window > 0){
+            // Full panes alone cover the window, the newest pane comes on top
+            pane_count = std::max<uint32_t>(panes, 1);
+            pane_size = (window + pane_count - 1) / pane_count;
+        }
+    }
+
+    void symmetric_join::push_left(const tuple* data, uint64_t count, std::vector<triple>& out) {
+        push(left, right, true, data, count, out);
+    }
+
+    void symmetric_join::push_right(const tuple* data, uint64_t count, std::vector<triple>& out) {
+        push(right, left, false, data, count, out);
+    }
+
+    void symmetric_join::push(side& own, side& other, bool left_side, const tuple* data, uint64_t count,
+                              std::vector<triple>& out) {
+        std::lock_guard<std::mutex> guard(lock);
+        uint64_t done = 0;
+        while(done < count){
+            // Open a new pane once the newest one is full, the window drops the oldest one
+            if(own.panes.empty() || own.panes.back()->count == own.panes.back()->capacity){
+                uint64_t capacity = pane_count > 0 ? pane_size : std::max(pane_size, own.resident);
+                own.panes.push_back(std::make_unique<pane>(capacity, table_size));
+                if(pane_count > 0 && own.panes.size() > pane_count + 1){
+                    own.resident -= own.panes.front()->count;
+                    own.panes.pop_front();
+                }
+            }
+            pane& target = *own.panes.back();
+            uint64_t step = std::min(count - done, target.capacity - target.count);
+            process(target, other, left_side, data + done, step, out);
+            target.count += step;
+            own.resident += step;
+            done += step;
+        }
+    }
+
+    void symmetric_join::process(pane& target, const side& other, bool left_side, const tuple* data,
+                                 uint64_t count, std::vector<triple>& out) {
+        // Inserting into one side and probing the other never touch the same table
+        auto run = [&target, &other, left_side](const tuple* morsel, uint64_t length, std::vector<triple>& res){
+            uint64_t first = res.size();
+            for(uint64_t k = 0; k < length; ++k){
+                target.table.insert(morsel[k]);
+                for(auto& curr: other.panes){
+                    curr->table.probe(morsel[k], false, res);
+                }
+            }
+            // The tables emit (key, rid of the table, rid of the probe), left tuples probe the right side
+            for(uint64_t k = first; left_side && k < res.size(); ++k){
+                std::swap(std::get<1>(res[k]), std::get<2>(res[k]));
+            }
+        };
+        if(threads == 1 || count < parallel_batch){
+            run(data, count, out);
+            return;
+        }
+        helpers::executor::ticket admission(*exec, threads);
+        // Joins running concurrently may leave fewer workers than requested, the batch gets one morsel per grant
+        auto workers = static_cast<uint8_t>(admission.granted());
+        uint64_t morsel = (count + workers - 1) / workers;
+        std::vector<std::vector<triple>> results(workers);
+        helpers::executor::task_group tasks(*exec);
+        for(uint8_t t = 0; t < workers; ++t){
+            uint64_t start = std::min(t * morsel, count);
+            uint64_t length = std::min(morsel, count - start);
+            tasks.post([&run, &results, data, start, length, t]{
+                run(data + start, length, results[t]);
+            });
+        }
+        tasks.wait();
+        for(auto& res: results){
+            out.insert(out.end(), res.begin(), res.end());
+        }
+    }
+
+    uint64_t symmetric_join::resident_left() const {
+        std::lock_guard<std::mutex> guard(lock);
+        return left.resident;
+    }
+
+    uint64_t symmetric_join::resident_right() const {
+        std::lock_guard<std::mutex> guard(lock);
+        return right.resident;
+    }
+
+    uint64_t symmetric_join::table_bytes() const {
+        std::lock_guard<std::mutex> guard(lock);
+        uint64_t buckets = 0;
+        for(auto& curr: left.panes){
+            buckets += curr->table.size;
+        }
+        for(auto& curr: right.panes){
+            buckets += curr->table.size;
+        }
+        return buckets * sizeof(helpers::latched_hash_table::bucket);
+    }
+
+    void symmetric_join::set_executor(helpers::executor& exec) {
+        std::lock_guard<std::mutex> guard(lock);
+        this->exec = &exec;
+    }
+
+}  // namespace algorithms
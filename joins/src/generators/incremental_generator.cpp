@@ -3,6 +3,7 @@
 //
 
 #include "generators/incremental_generator.h"
+#include "algorithms/relation_file.h"
 
 namespace generators {
 
@@ -25,6 +26,10 @@ namespace generators {
         return data;
     }
 
+    void incremental_generator::write(const std::string& path) {
+        helpers::write_relation(path, data);
+    }
+
     uint64_t incremental_generator::get_count() {
         return ending - start + 1;
     }
@@ -3,7 +3,9 @@
 //
 
 #include "generators/uniform_generator.h"
+#include "algorithms/relation_file.h"
 #include <random>
+#include <stdexcept>
 
 namespace generators {
 
@@ -39,6 +41,13 @@ namespace generators {
         return data;
     }
 
+    void uniform_generator::write(const std::string& path) {
+        if(!built){
+            throw std::logic_error("writing may not be called before distribution has been built.");
+        }
+        helpers::write_relation(path, data);
+    }
+
     uint64_t uniform_generator::get_count() {
         return count;
     }
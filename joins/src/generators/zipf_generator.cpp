@@ -3,8 +3,10 @@
 //
 
 #include "generators/zipf_generator.h"
+#include "algorithms/relation_file.h"
 #include <cmath>
 #include <random>
+#include <stdexcept>
 
 namespace generators{
 
@@ -82,6 +84,13 @@ namespace generators{
         return data;
     }
 
+    void zipf_generator::write(const std::string& path) {
+        if(!built){
+            throw std::logic_error("writing may not be called before distribution has been built.");
+        }
+        helpers::write_relation(path, data);
+    }
+
 }
 
 
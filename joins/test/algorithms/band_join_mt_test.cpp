@@ -0,0 +1,104 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "generators/uniform_generator.h"
+#include "generators/zipf_generator.h"
+#include "algorithms/band_join_mt.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+
+// Number of threads the program should be run on
+#define thread_count 4
+
+using namespace generators;  // NOLINT
+using namespace algorithms; // NOLINT
+
+/*
+ * Helper function. Flattens the per partition output vectors into a single sorted vector.
+ */
+std::vector<band_join_mt::triple> flatten_band(std::vector<std::vector<band_join_mt::triple>>& output){
+    std::vector<band_join_mt::triple> res;
+    for(auto& vec: output){
+        res.insert(res.end(), vec.begin(), vec.end());
+    }
+    std::sort(res.begin(), res.end());
+    return res;
+}
+
+/*
+ * Helper function. Computes the expected band join result through nested loops.
+ */
+std::vector<band_join_mt::triple> band_reference(std::vector<band_join_mt::tuple>& left,
+                                                 std::vector<band_join_mt::tuple>& right, uint64_t band){
+    std::vector<band_join_mt::triple> res;
+    for(auto& l: left){
+        for(auto& r: right){
+            uint64_t a = std::get<0>(l);
+            uint64_t b = std::get<0>(r);
+            if((a > b ? a - b : b - a) <= band){
+                res.emplace_back(a, std::get<1>(l), std::get<1>(r));
+            }
+        }
+    }
+    std::sort(res.begin(), res.end());
+    return res;
+}
+
+// Ensure proper creation of object and no return before execution
+TEST(BandJoinTestMT, CreationTester) {
+    uniform_generator uni(0, 10000, 1000);
+    uni.build();
+    auto left = uni.get_vec_copy();
+    auto right = uni.get_vec_copy();
+    band_join_mt join(left.data(), right.data(), 1000, 1000, 5);
+    ASSERT_ANY_THROW(join.get());
+}
+
+// A zero band degenerates to an equi join
+TEST(BandJoinTestMT, EquiTester) {
+    uniform_generator gen(0, 500, 2000);
+    gen.build();
+    auto left = gen.get_vec_copy();
+    gen = uniform_generator(0, 500, 3000);
+    gen.build();
+    auto right = gen.get_vec_copy();
+    band_join_mt join(left.data(), right.data(), left.size(), right.size(), 0, thread_count, 16);
+    join.execute();
+    ASSERT_EQ(flatten_band(join.get()), band_reference(left, right, 0));
+}
+
+// Bands spanning many partitions force replication of the right tuples
+TEST(BandJoinTestMT, ReplicationTester) {
+    uniform_generator gen(0, 20000, 2000);
+    gen.build();
+    auto left = gen.get_vec_copy();
+    gen = uniform_generator(0, 20000, 2000);
+    gen.build();
+    auto right = gen.get_vec_copy();
+    band_join_mt join(left.data(), right.data(), left.size(), right.size(), 300, thread_count, 128);
+    join.execute();
+    ASSERT_EQ(flatten_band(join.get()), band_reference(left, right, 300));
+}
+
+// Skewed keys lead to duplicate splitters and empty partitions
+TEST(BandJoinTestMT, SkewTester) {
+    zipf_generator gen(200, 1.5, 2000);
+    gen.build();
+    auto left = gen.get_vec_copy();
+    gen = zipf_generator(200, 1.0, 2000);
+    gen.build();
+    auto right = gen.get_vec_copy();
+    band_join_mt join(left.data(), right.data(), left.size(), right.size(), 2, thread_count, 64);
+    join.execute();
+    ASSERT_EQ(flatten_band(join.get()), band_reference(left, right, 2));
+}
+
+// Windows reaching over the ends of the value domain have to be clamped
+TEST(BandJoinTestMT, DomainTester) {
+    std::vector<band_join_mt::tuple> left{{0, 0}, {UINT64_MAX, 1}, {UINT64_MAX - 3, 2}};
+    std::vector<band_join_mt::tuple> right{{2, 0}, {UINT64_MAX - 1, 1}};
+    band_join_mt join(left.data(), right.data(), left.size(), right.size(), 5, 1, 2);
+    join.execute();
+    ASSERT_EQ(flatten_band(join.get()), band_reference(left, right, 5));
+}
@@ -0,0 +1,103 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "generators/uniform_generator.h"
+#include "algorithms/calibration.h"
+#include "algorithms/nop_join_mt.h"
+#include "algorithms/mt_radix/radix_join_mt.h"
+#include "gtest/gtest.h"
+#include <cstdio>
+#include <fstream>
+#include <limits>
+
+using namespace generators;  // NOLINT
+using namespace algorithms; // NOLINT
+
+/*
+ * Helper function. Takes the vector of output vectors and calculates the total length
+ * of the output.
+ */
+uint64_t get_size_calibration(std::vector<std::vector<radix_join_mt::triple>> &output){
+    uint64_t size = 0;
+    for(auto& vec: output){
+        size += vec.size();
+    }
+    return size;
+}
+
+// Lookups pick the smallest covering bracket and fall back to the largest one
+TEST(CalibrationTest, LookupTester) {
+    calibration empty;
+    ASSERT_EQ(empty.lookup(100), nullptr);
+    calibration tuned({{1 << 20, 7, 2, 1.0}, {1 << 10, 3, 1, 2.0}});
+    ASSERT_EQ(tuned.entries().front().max_build, 1 << 10);
+    ASSERT_EQ(tuned.lookup(10)->bits_per_pass, 3);
+    ASSERT_EQ(tuned.lookup(1 << 10)->bits_per_pass, 3);
+    ASSERT_EQ(tuned.lookup((1 << 10) + 1)->bits_per_pass, 7);
+    ASSERT_EQ(tuned.lookup(1 << 30)->passes, 2);
+}
+
+// Saved calibrations load back unchanged, missing files are empty and broken ones are rejected
+TEST(CalibrationTest, PersistTester) {
+    std::string path = ::testing::TempDir() + "calibration_test.calibration";
+    calibration tuned({{1 << 12, 4, 1, 1.5}, {1 << 16, 5, 2, 0.5}});
+    tuned.save(path);
+    calibration loaded = calibration::load(path);
+    ASSERT_EQ(loaded.entries().size(), 2);
+    ASSERT_EQ(loaded.entries()[1].max_build, 1 << 16);
+    ASSERT_EQ(loaded.entries()[1].bits_per_pass, 5);
+    ASSERT_EQ(loaded.entries()[1].passes, 2);
+    ASSERT_DOUBLE_EQ(loaded.entries()[1].table_size, 0.5);
+    std::remove(path.c_str());
+    ASSERT_TRUE(calibration::load(path).entries().empty());
+    std::ofstream(path) << "1024 four 1 1.5\n";
+    ASSERT_THROW(calibration::load(path), std::runtime_error);
+    std::remove(path.c_str());
+}
+
+// Measured parameters stay within the candidate range and join correctly
+TEST(CalibrationTest, MeasureTester) {
+    calibration tuned = calibration::measure({1 << 10, 1 << 13}, 2, 1);
+    ASSERT_EQ(tuned.entries().size(), 2);
+    for(auto& entry: tuned.entries()){
+        ASSERT_GE(entry.passes, 1);
+        ASSERT_LE(entry.passes, 2);
+        ASSERT_GE(entry.bits_per_pass, 1);
+        ASSERT_GT(entry.table_size, 0);
+    }
+    // 2^13 tuples allow at most 7 bits in total
+    ASSERT_LE(tuned.entries()[1].bits_per_pass * tuned.entries()[1].passes, 7);
+    uint64_t count = 1 << 13;
+    uniform_generator gen(1, 1 << 12, count);
+    gen.build();
+    auto left = gen.get_vec_copy();
+    gen.build();
+    auto right = gen.get_vec_copy();
+    nop_join_mt reference(left.data(), right.data(), count, count, 1.5, 1);
+    reference.execute();
+    radix_join_mt join(left.data(), right.data(), count, count, 2, helpers::join_type::inner);
+    join.set_calibration(tuned);
+    join.execute();
+    ASSERT_EQ(get_size_calibration(join.get()), get_size_calibration(reference.get()));
+}
+
+// The calibrated table size sizes the leaf tables, so the measured sweep over it is not just noise
+TEST(CalibrationTest, TableSizeTester) {
+    uint64_t count = 1 << 13;
+    uniform_generator gen(1, 1 << 12, count);
+    gen.build();
+    auto left = gen.get_vec_copy();
+    gen.build();
+    auto right = gen.get_vec_copy();
+    for(double table_size: {0.5, 2.0}){
+        calibration tuned({{1 << 20, 3, 1, table_size}});
+        radix_join_mt join(left.data(), right.data(), count, count, 2, helpers::join_type::inner);
+        join.set_calibration(tuned);
+        join.set_skew_threshold(std::numeric_limits<uint64_t>::max());
+        join.execute();
+        // Every one of the 8 leaves rounds its table down
+        ASSERT_LE(join.leaf_buckets(), static_cast<uint64_t>(table_size * count));
+        ASSERT_GE(join.leaf_buckets() + 8, static_cast<uint64_t>(table_size * count));
+    }
+}
@@ -0,0 +1,120 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "algorithms/composite_join_mt.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <map>
+#include <random>
+
+// Number of threads the program should be run on
+#define thread_count 4
+
+using namespace algorithms; // NOLINT
+
+/*
+ * Helper function. Flattens the per thread output vectors into a single sorted vector.
+ */
+std::vector<composite_join_mt::pair> flatten_pairs(std::vector<std::vector<composite_join_mt::pair>>& output){
+    std::vector<composite_join_mt::pair> res;
+    for(auto& vec: output){
+        res.insert(res.end(), vec.begin(), vec.end());
+    }
+    std::sort(res.begin(), res.end());
+    return res;
+}
+
+/*
+ * Helper function. Creates 'columns' key columns with small domains so that
+ * many rows agree on some but not all columns.
+ */
+std::vector<std::vector<uint64_t>> composite_data(uint64_t columns, uint64_t rows, uint64_t seed){
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<uint64_t> dis(0, 15);
+    std::vector<std::vector<uint64_t>> data(columns, std::vector<uint64_t>(rows));
+    for(auto& col: data){
+        for(auto& val: col){
+            val = dis(gen);
+        }
+    }
+    return data;
+}
+
+/*
+ * Helper function. Computes the expected matches through an ordered map on the full keys.
+ */
+std::vector<composite_join_mt::pair> composite_reference(std::vector<std::vector<uint64_t>>& left,
+                                                          std::vector<std::vector<uint64_t>>& right){
+    std::multimap<std::vector<uint64_t>, uint64_t> table;
+    for(uint64_t k = 0; k < left[0].size(); ++k){
+        std::vector<uint64_t> key;
+        for(auto& col: left){
+            key.push_back(col[k]);
+        }
+        table.emplace(key, k);
+    }
+    std::vector<composite_join_mt::pair> res;
+    for(uint64_t k = 0; k < right[0].size(); ++k){
+        std::vector<uint64_t> key;
+        for(auto& col: right){
+            key.push_back(col[k]);
+        }
+        auto range = table.equal_range(key);
+        for(auto it = range.first; it != range.second; ++it){
+            res.emplace_back(it->second, k);
+        }
+    }
+    std::sort(res.begin(), res.end());
+    return res;
+}
+
+/*
+ * Helper function. Returns the raw column pointers of a relation.
+ */
+std::vector<const uint64_t*> column_ptrs(std::vector<std::vector<uint64_t>>& data){
+    std::vector<const uint64_t*> res;
+    for(auto& col: data){
+        res.push_back(col.data());
+    }
+    return res;
+}
+
+// Ensure proper creation of object and no return before execution
+TEST(CompositeJoinTestMT, CreationTester) {
+    auto left = composite_data(2, 100, 1);
+    auto right = composite_data(3, 100, 2);
+    ASSERT_ANY_THROW(composite_join_mt(column_ptrs(left), column_ptrs(right), 100, 100));
+    right = composite_data(2, 100, 2);
+    composite_join_mt join(column_ptrs(left), column_ptrs(right), 100, 100);
+    ASSERT_ANY_THROW(join.get());
+}
+
+// Permuted column values may not match each other
+TEST(CompositeJoinTestMT, PermutationTester) {
+    std::vector<std::vector<uint64_t>> left{{1, 2}, {2, 1}};
+    std::vector<std::vector<uint64_t>> right{{2}, {1}};
+    composite_join_mt join(column_ptrs(left), column_ptrs(right), 2, 1, 1.5, thread_count, 0, 0);
+    join.execute();
+    auto res = flatten_pairs(join.get());
+    ASSERT_EQ(res.size(), 1);
+    ASSERT_EQ(res[0], composite_join_mt::pair(1, 0));
+}
+
+// Two key columns joined through the no partitioning join
+TEST(CompositeJoinTestMT, ReferenceTesterNOP) {
+    auto left = composite_data(2, 2000, 3);
+    auto right = composite_data(2, 3000, 4);
+    composite_join_mt join(column_ptrs(left), column_ptrs(right), 2000, 3000, 1.5, thread_count, 0, 0);
+    join.execute();
+    ASSERT_EQ(flatten_pairs(join.get()), composite_reference(left, right));
+}
+
+// Four key columns joined through the multi pass radix join
+TEST(CompositeJoinTestMT, ReferenceTesterRadix) {
+    auto left = composite_data(4, 20000, 5);
+    auto right = composite_data(4, 20000, 6);
+    composite_join_mt join(column_ptrs(left), column_ptrs(right), 20000, 20000, 1.5, thread_count, 4, 2);
+    join.execute();
+    ASSERT_EQ(flatten_pairs(join.get()), composite_reference(left, right));
+}
@@ -0,0 +1,173 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "generators/uniform_generator.h"
+#include "generators/incremental_generator.h"
+#include "algorithms/dynamic_hash_table.h"
+#include "algorithms/hash_index.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+using namespace generators;  // NOLINT
+using namespace algorithms; // NOLINT
+
+/*
+ * Helper function. Probes the table with the whole batch and returns the sorted result.
+ */
+std::vector<dynamic_hash_table::triple> get_sorted_dynamic(const dynamic_hash_table& table,
+                                                           std::vector<dynamic_hash_table::tuple>& probe){
+    std::vector<dynamic_hash_table::triple> out;
+    table.probe(probe.data(), probe.size(), helpers::join_type::inner, out);
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+// Growing keeps every tuple, also while the old table is still being moved over
+TEST(DynamicHashTableTest, GrowTester) {
+    uniform_generator gen_l(1, 1 << 12, 1 << 15);
+    gen_l.build();
+    auto left = gen_l.get_vec_copy();
+    uniform_generator gen_r(1, 1 << 12, 1 << 13);
+    gen_r.build();
+    auto right = gen_r.get_vec_copy();
+    hash_index reference(left.data(), left.size());
+    std::vector<hash_index::triple> expected;
+    reference.probe(right.data(), right.size(), helpers::join_type::right_outer, expected);
+    std::sort(expected.begin(), expected.end());
+    dynamic_hash_table table;
+    bool resized = false;
+    for(auto& curr: left){
+        table.insert(curr);
+        resized |= table.resizing();
+    }
+    ASSERT_TRUE(resized);
+    ASSERT_EQ(table.size(), left.size());
+    ASSERT_GE(table.capacity(), 2 * left.size());
+    std::vector<dynamic_hash_table::triple> out;
+    table.probe(right.data(), right.size(), helpers::join_type::right_outer, out);
+    std::sort(out.begin(), out.end());
+    ASSERT_EQ(out, expected);
+    ASSERT_THROW(table.insert(dynamic_hash_table::tuple(1, helpers::null_rid)), std::invalid_argument);
+    ASSERT_THROW(table.probe(right.data(), right.size(), helpers::join_type::full_outer, out),
+                 std::invalid_argument);
+}
+
+// The larger table is cleared before the update opening it, so probes barely repeat keys across a grow
+TEST(DynamicHashTableTest, GrowRetryTester) {
+    uint64_t count = 1 << 20;
+    incremental_generator gen(1, count + 1);
+    gen.build();
+    auto data = gen.get_vec_copy();
+    // Exactly half full after 'count' inserts, the last insert opens a table of 2^22 slots
+    dynamic_hash_table table(count);
+    table.insert(data.data(), count);
+    ASSERT_EQ(table.capacity(), 2 * count);
+    std::atomic<bool> done(false);
+    std::atomic<uint64_t> started(0);
+    std::vector<std::thread> probes;
+    for(int t = 0; t < 2; ++t){
+        probes.emplace_back([&table, &data, &done, &started, count, t]{
+            std::vector<dynamic_hash_table::triple> out;
+            table.probe(data[t], out);
+            ++started;
+            for(uint64_t k = t; !done.load(); k = (k + 7) % count){
+                table.probe(data[k], out);
+                out.clear();
+            }
+        });
+    }
+    while(started.load() < probes.size()){
+        std::this_thread::yield();
+    }
+    uint64_t before = table.probe_retries();
+    table.insert(data[count]);
+    uint64_t after = table.probe_retries();
+    done = true;
+    for(auto& thread: probes){
+        thread.join();
+    }
+    ASSERT_TRUE(table.resizing());
+    ASSERT_EQ(table.capacity(), 4 * count);
+    // Waiting while the whole table gets cleared takes dozens of retries even on a single core
+    ASSERT_LT(after - before, 16);
+}
+
+// Deletes remove exactly the given tuples, before, during and after growing
+TEST(DynamicHashTableTest, EraseTester) {
+    uint64_t count = 1 << 14;
+    uniform_generator gen(1, 1 << 10, count);
+    gen.build();
+    auto data = gen.get_vec_copy();
+    dynamic_hash_table table(count / 4);
+    // Deletes of every third tuple interleave with the inserts, so some hit the old table while growing
+    std::vector<dynamic_hash_table::tuple> kept;
+    for(uint64_t k = 0; k < count; ++k){
+        table.insert(data[k]);
+        if(k % 3 == 2){
+            ASSERT_TRUE(table.erase(data[k - 1]));
+            kept.push_back(data[k - 2]);
+            kept.push_back(data[k]);
+        } else if(k + 1 == count){
+            kept.insert(kept.end(), data.begin() + (k - k % 3), data.end());
+        }
+    }
+    ASSERT_FALSE(table.erase(dynamic_hash_table::tuple(1 << 20, 0)));
+    ASSERT_EQ(table.size(), kept.size());
+    dynamic_hash_table rebuilt(kept.data(), kept.size());
+    ASSERT_EQ(get_sorted_dynamic(table, data), get_sorted_dynamic(rebuilt, data));
+    ASSERT_EQ(table.erase(kept.data(), kept.size()), kept.size());
+    ASSERT_EQ(table.size(), 0);
+    ASSERT_TRUE(get_sorted_dynamic(table, data).empty());
+}
+
+// Probes running next to inserts, deletes and growing always find the tuples which are never touched
+TEST(DynamicHashTableTest, ConcurrentTester) {
+    uint64_t count = 1 << 12;
+    incremental_generator gen(1, count);
+    gen.build();
+    auto stable = gen.get_vec_copy();
+    dynamic_hash_table table(stable.data(), stable.size());
+    auto expected = get_sorted_dynamic(table, stable);
+    ASSERT_EQ(expected.size(), count);
+    std::atomic<bool> done(false);
+    std::vector<std::thread> probes;
+    std::vector<uint64_t> mismatches(3, 0);
+    for(auto& failed: mismatches){
+        probes.emplace_back([&table, &stable, &expected, &done, &failed]{
+            while(!done.load()){
+                failed += get_sorted_dynamic(table, stable) != expected;
+            }
+        });
+    }
+    // Updated tuples have keys no probe asks for, but share clusters with the probed ones
+    std::vector<dynamic_hash_table::tuple> updates;
+    for(uint64_t k = 0; k < 4 * count; ++k){
+        updates.emplace_back(count + k, k);
+    }
+    std::vector<uint64_t> erased;
+    for(int round = 0; round < 4; ++round){
+        table.insert(updates.data(), updates.size());
+        erased.push_back(table.erase(updates.data(), updates.size()));
+    }
+    // Old tables are freed although probes overlap all the time, at most the last one is still held
+    dynamic_hash_table fresh(table.capacity() / 2);
+    uint64_t held = table.memory_bytes();
+    done = true;
+    for(auto& thread: probes){
+        thread.join();
+    }
+    for(auto failed: mismatches){
+        ASSERT_EQ(failed, 0);
+    }
+    for(auto curr: erased){
+        ASSERT_EQ(curr, updates.size());
+    }
+    ASSERT_EQ(table.size(), count);
+    ASSERT_LE(2 * held, 3 * fresh.memory_bytes());
+    // Without probes the next update frees it
+    ASSERT_EQ(table.erase(updates.data(), updates.size()), 0);
+    ASSERT_EQ(table.memory_bytes(), fresh.memory_bytes());
+}
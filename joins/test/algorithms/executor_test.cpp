@@ -0,0 +1,159 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "generators/uniform_generator.h"
+#include "algorithms/executor.h"
+#include "algorithms/nop_join_mt.h"
+#include "algorithms/mt_radix/radix_join_mt.h"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+using namespace generators;  // NOLINT
+using namespace algorithms; // NOLINT
+
+/*
+ * Helper function. Posts a binary tree of tasks into the group, every leaf increments the counter.
+ */
+void post_tree_exec(helpers::executor::task_group* tasks, std::atomic<uint64_t>* counter, uint32_t depth){
+    if(depth == 0){
+        ++(*counter);
+        return;
+    }
+    tasks->post(post_tree_exec, tasks, counter, depth - 1);
+    tasks->post(post_tree_exec, tasks, counter, depth - 1);
+}
+
+/*
+ * Helper function. Takes the vector of output vectors and calculates the total length
+ * of the output.
+ */
+uint64_t get_size_exec(std::vector<std::vector<radix_join_mt::triple>> &output){
+    uint64_t size = 0;
+    for(auto& vec: output){
+        size += vec.size();
+    }
+    return size;
+}
+
+// Waiting on a group covers tasks which were spawned by other tasks of the group
+TEST(ExecutorTest, GroupWaitTester) {
+    helpers::executor exec(4);
+    std::atomic<uint64_t> counter(0);
+    helpers::executor::task_group tasks(exec);
+    tasks.post(post_tree_exec, &tasks, &counter, 10);
+    tasks.wait();
+    ASSERT_EQ(counter, 1024);
+    // Groups can be reused after waiting
+    tasks.post(post_tree_exec, &tasks, &counter, 4);
+    tasks.wait();
+    ASSERT_EQ(counter, 1040);
+}
+
+// Admission never grants more than the worker count and blocks until enough workers are free
+TEST(ExecutorTest, AdmissionTester) {
+    helpers::executor exec(4);
+    ASSERT_EQ(exec.size(), 4);
+    std::atomic<bool> admitted(false);
+    std::unique_ptr<helpers::executor::ticket> first(new helpers::executor::ticket(exec, 16));
+    ASSERT_EQ(first->granted(), 4);
+    std::thread waiter([&]{
+        helpers::executor::ticket second(exec, 1);
+        admitted = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_FALSE(admitted);
+    // Releasing the first ticket lets the waiting one in
+    first.reset();
+    waiter.join();
+    ASSERT_TRUE(admitted);
+}
+
+// Several joins running concurrently on one shared executor still produce complete results
+TEST(ExecutorTest, ConcurrentJoinTester) {
+    helpers::executor exec(4);
+    uint64_t count = 1 << 14;
+    uniform_generator gen(1, 1 << 10, count);
+    gen.build();
+    auto left = gen.get_vec_copy();
+    gen.build();
+    auto right = gen.get_vec_copy();
+    // Reference result on a private executor
+    nop_join_mt reference(left.data(), right.data(), count, count, 1.5, 2);
+    reference.execute();
+    uint64_t expected = get_size_exec(reference.get());
+    std::vector<uint64_t> sizes(4);
+    std::vector<std::thread> queries;
+    for(uint64_t q = 0; q < sizes.size(); ++q){
+        queries.emplace_back([&, q]{
+            // Private copies, multi pass radix joins use their input as scratch space
+            auto l = left;
+            auto r = right;
+            if(q % 2 == 0){
+                radix_join_mt join(l.data(), r.data(), count, count, 1.5, 2, 4, 2);
+                join.set_executor(exec);
+                join.execute();
+                sizes[q] = get_size_exec(join.get());
+            } else {
+                nop_join_mt join(l.data(), r.data(), count, count, 1.5, 3);
+                join.set_executor(exec);
+                join.execute();
+                sizes[q] = get_size_exec(join.get());
+            }
+        });
+    }
+    for(auto& query: queries){
+        query.join();
+    }
+    for(auto size: sizes){
+        ASSERT_EQ(size, expected);
+    }
+}
+
+// The first in line takes the free workers instead of waiting, so joins asking for more run side by side
+TEST(ExecutorTest, PartialGrantTester) {
+    helpers::executor exec(4);
+    uint64_t count = 1 << 14;
+    uniform_generator gen(1, 1 << 10, count);
+    gen.build();
+    auto left = gen.get_vec_copy();
+    gen.build();
+    auto right = gen.get_vec_copy();
+    nop_join_mt reference(left.data(), right.data(), count, count, 1.5, 2);
+    reference.execute();
+    uint64_t expected = get_size_exec(reference.get());
+    {
+        helpers::executor::ticket first(exec, 3);
+        helpers::executor::ticket second(exec, 4);
+        ASSERT_EQ(first.granted(), 3);
+        ASSERT_EQ(second.granted(), 1);
+    }
+    {
+        // A join asking for all workers runs on the one left while another join holds the others
+        helpers::executor::ticket running(exec, 3);
+        nop_join_mt join(left.data(), right.data(), count, count, 1.5, 4);
+        join.set_executor(exec);
+        join.execute();
+        ASSERT_EQ(get_size_exec(join.get()), expected);
+    }
+    // Two joins of three threads each on four workers
+    std::vector<uint64_t> sizes(2);
+    std::vector<std::thread> queries;
+    for(uint64_t q = 0; q < sizes.size(); ++q){
+        queries.emplace_back([&, q]{
+            nop_join_mt join(left.data(), right.data(), count, count, 1.5, 3);
+            join.set_executor(exec);
+            join.execute();
+            sizes[q] = get_size_exec(join.get());
+        });
+    }
+    for(auto& query: queries){
+        query.join();
+    }
+    for(auto size: sizes){
+        ASSERT_EQ(size, expected);
+    }
+}
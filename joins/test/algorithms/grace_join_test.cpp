@@ -0,0 +1,141 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "generators/uniform_generator.h"
+#include "algorithms/grace_join.h"
+#include "algorithms/nop_join_mt.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+
+using namespace generators;  // NOLINT
+using namespace algorithms; // NOLINT
+
+/*
+ * Helper function. Flattens the vector of output vectors into one sorted vector.
+ */
+std::vector<grace_join::triple> get_sorted_grace(std::vector<std::vector<grace_join::triple>> &output){
+    std::vector<grace_join::triple> flat;
+    for(auto& vec: output){
+        flat.insert(flat.end(), vec.begin(), vec.end());
+    }
+    std::sort(flat.begin(), flat.end());
+    return flat;
+}
+
+// Ensure proper creation of object and no return before execution
+TEST(GraceTest, CreationTester) {
+    std::vector<grace_join::tuple> left(10), right(10);
+    grace_join join(left.data(), right.data(), 10, 10);
+    ASSERT_THROW(join.get(), std::logic_error);
+}
+
+// Spilled tuples come back in order, unwritten ones cannot be read
+TEST(GraceTest, SpillFileTester) {
+    helpers::spill_file file(helpers::default_spill_directory(), 10 * sizeof(grace_join::tuple));
+    std::vector<grace_join::tuple> data;
+    for(uint64_t k = 0; k < 1000; ++k){
+        data.emplace_back(k, 2 * k);
+    }
+    file.append(data.data(), 995);
+    ASSERT_EQ(file.size(), 995);
+    ASSERT_THROW(file.read(990, 5, data.data()), std::out_of_range);
+    file.finish();
+    file.append(data.data() + 995, 5);
+    file.finish();
+    std::vector<grace_join::tuple> back(1000);
+    file.read(0, 1000, back.data());
+    ASSERT_EQ(back, data);
+    ASSERT_THROW(helpers::spill_file("/nonexistent/spill", 4096), std::runtime_error);
+}
+
+// Small budgets spill partitions, the results match an in-memory join for every join type
+TEST(GraceTest, SpillTester) {
+    uint64_t count = 1 << 16;
+    uniform_generator gen(1, 1 << 15, count);
+    gen.build();
+    auto left = gen.get_vec_copy();
+    gen.build();
+    auto right = gen.get_vec_copy();
+    for(auto type: {helpers::join_type::inner, helpers::join_type::left_outer, helpers::join_type::right_outer,
+                    helpers::join_type::full_outer}){
+        nop_join_mt reference(left.data(), right.data(), count - 1000, count, 1.5, 2, type);
+        reference.execute();
+        grace_join join(left.data(), right.data(), count - 1000, count, 1.5, 2, 1 << 20, 1 << 16, type);
+        join.execute();
+        ASSERT_GT(join.partitions(), 1);
+        ASSERT_GT(join.spilled_partitions(), 0);
+        // Spill buffers of 64 KiB must not take more than half of the memory left next to the chunk
+        ASSERT_LE(join.partitions() << 16, ((1 << 20) - (1 << 17)) / 2);
+        ASSERT_EQ(join.get().size(), join.partitions());
+        ASSERT_EQ(get_sorted_grace(join.get()), get_sorted_grace(reference.get()));
+    }
+}
+
+// Spilled partitions joined by several workers at once give the same result as a single one
+TEST(GraceTest, ParallelSpillTester) {
+    uint64_t count = 1 << 17;
+    uniform_generator gen(1, 1 << 16, count);
+    gen.build();
+    auto left = gen.get_vec_copy();
+    gen.build();
+    auto right = gen.get_vec_copy();
+    helpers::executor exec(4);
+    grace_join single(left.data(), right.data(), count, count, 1.5, 1, 1 << 22, 1 << 16,
+                      helpers::join_type::full_outer);
+    single.set_executor(exec);
+    single.execute();
+    // Every spilled partition takes a fraction of the memory, so several get joined at once
+    grace_join parallel(left.data(), right.data(), count, count, 1.5, 4, 1 << 22, 1 << 16,
+                        helpers::join_type::full_outer);
+    parallel.set_executor(exec);
+    parallel.execute();
+    ASSERT_GT(parallel.spilled_partitions(), 1);
+    ASSERT_EQ(get_sorted_grace(parallel.get()), get_sorted_grace(single.get()));
+}
+
+// Large budgets keep everything resident
+TEST(GraceTest, ResidentTester) {
+    uint64_t count = 1 << 14;
+    uniform_generator gen(1, 1 << 12, count);
+    gen.build();
+    auto left = gen.get_vec_copy();
+    gen.build();
+    auto right = gen.get_vec_copy();
+    nop_join_mt reference(left.data(), right.data(), count, count, 1.5, 2);
+    reference.execute();
+    grace_join join(left.data(), right.data(), count, count);
+    join.execute();
+    ASSERT_EQ(join.partitions(), 1);
+    ASSERT_EQ(join.spilled_partitions(), 0);
+    ASSERT_EQ(get_sorted_grace(join.get()), get_sorted_grace(reference.get()));
+}
+
+// Empty relations only emit the preserved side
+TEST(GraceTest, EmptyTester) {
+    std::vector<grace_join::tuple> left(100, grace_join::tuple(1, 1));
+    grace_join join(left.data(), nullptr, 100, 0, 1.5, 2, 1 << 20, 1 << 16, helpers::join_type::left_outer);
+    join.execute();
+    ASSERT_EQ(get_sorted_grace(join.get()).size(), 100);
+}
+
+// Result vectors passed through set() are appended to
+TEST(GraceTest, SetTester) {
+    uint64_t count = 1 << 12;
+    uniform_generator gen(1, 1 << 10, count);
+    gen.build();
+    auto left = gen.get_vec_copy();
+    gen.build();
+    auto right = gen.get_vec_copy();
+    grace_join reference(left.data(), right.data(), count, count);
+    reference.execute();
+    auto expected = get_sorted_grace(reference.get());
+    std::vector<std::vector<grace_join::triple>> res(1);
+    res[0].emplace_back(0, 0, 0);
+    grace_join join(left.data(), right.data(), count, count);
+    join.set(res);
+    join.execute();
+    expected.emplace_back(0, 0, 0);
+    std::sort(expected.begin(), expected.end());
+    ASSERT_EQ(get_sorted_grace(join.get()), expected);
+}
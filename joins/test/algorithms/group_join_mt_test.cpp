@@ -0,0 +1,85 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "generators/uniform_generator.h"
+#include "algorithms/group_join.h"
+#include "algorithms/mt_radix/group_join_mt.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+
+// Number of threads the program should be run on
+#define thread_count 4
+
+using namespace generators;  // NOLINT
+using namespace algorithms; // NOLINT
+
+/*
+ * Helper function. Flattens the per thread output vectors into a single sorted vector.
+ */
+std::vector<group_join_mt::group> flatten_groups(std::vector<std::vector<group_join_mt::group>>& output){
+    std::vector<group_join_mt::group> res;
+    for(auto& vec: output){
+        res.insert(res.end(), vec.begin(), vec.end());
+    }
+    std::sort(res.begin(), res.end());
+    return res;
+}
+
+// Ensure proper creation of object and no return before execution
+TEST(GroupJoinTestMT, CreationTester) {
+    uniform_generator uni(0, 10000, 1000);
+    uni.build();
+    auto left = uni.get_vec_copy();
+    uni.build();
+    auto right = uni.get_vec_copy();
+    group_join_mt join(left.data(), right.data(), 1000, 1000, 1.5, thread_count, 4, 1);
+    ASSERT_ANY_THROW(join.get());
+}
+
+// A cross product collapses into a single group
+TEST(GroupJoinTestMT, CrossTesterMP) {
+    uint64_t count = 1000;
+    uniform_generator uni(1, 1, count);
+    uni.build();
+    auto left = uni.get_vec_copy();
+    auto right = uni.get_vec_copy();
+    group_join_mt join(left.data(), right.data(), count, count, 1.5, thread_count, 3, 2);
+    join.execute();
+    auto res = flatten_groups(join.get());
+    ASSERT_EQ(res.size(), 1);
+    ASSERT_EQ(std::get<1>(res[0]), count * count);
+}
+
+// The partitioned group join has to produce the same groups as the single threaded one
+TEST(GroupJoinTestMT, ReferenceTesterSP) {
+    uniform_generator gen(1, 2000, 5000);
+    gen.build();
+    auto left = gen.get_vec_copy();
+    gen = uniform_generator(1, 4000, 20000);
+    gen.build();
+    auto right = gen.get_vec_copy();
+    group_join expected(left.data(), right.data(), left.size(), right.size());
+    expected.execute();
+    std::sort(expected.get().begin(), expected.get().end());
+    group_join_mt join(left.data(), right.data(), left.size(), right.size(), 1.5, thread_count, 6, 1);
+    join.execute();
+    ASSERT_EQ(flatten_groups(join.get()), expected.get());
+}
+
+// Same as before but with multiple partitioning passes
+TEST(GroupJoinTestMT, ReferenceTesterMP) {
+    uniform_generator gen(1, 2000, 5000);
+    gen.build();
+    auto left = gen.get_vec_copy();
+    gen = uniform_generator(1, 4000, 20000);
+    gen.build();
+    auto right = gen.get_vec_copy();
+    group_join expected(left.data(), right.data(), left.size(), right.size());
+    expected.execute();
+    std::sort(expected.get().begin(), expected.get().end());
+    // Multi pass partitioning uses the inputs as scratch space
+    group_join_mt join(left.data(), right.data(), left.size(), right.size(), 1.5, thread_count, 3, 3);
+    join.execute();
+    ASSERT_EQ(flatten_groups(join.get()), expected.get());
+}
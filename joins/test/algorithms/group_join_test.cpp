@@ -0,0 +1,95 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "generators/uniform_generator.h"
+#include "algorithms/group_join.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <map>
+
+using namespace generators;  // NOLINT
+using namespace algorithms; // NOLINT
+
+/*
+ * Helper function. Computes the expected group join result by grouping
+ * a naively computed join on the join value.
+ */
+std::vector<group_join::group> group_reference(std::vector<group_join::tuple>& left,
+                                                std::vector<group_join::tuple>& right){
+    std::map<uint64_t, uint64_t> multiplicity;
+    for(auto& t: left){
+        ++multiplicity[std::get<0>(t)];
+    }
+    std::map<uint64_t, group_join::group> groups;
+    for(auto& t: right){
+        auto it = multiplicity.find(std::get<0>(t));
+        if(it == multiplicity.end()){
+            continue;
+        }
+        auto ins = groups.emplace(it->first, group_join::group(it->first, 0, 0, UINT64_MAX, 0));
+        auto& g = ins.first->second;
+        std::get<1>(g) += it->second;
+        std::get<2>(g) += it->second * std::get<1>(t);
+        std::get<3>(g) = std::min(std::get<3>(g), std::get<1>(t));
+        std::get<4>(g) = std::max(std::get<4>(g), std::get<1>(t));
+    }
+    std::vector<group_join::group> res;
+    for(auto& g: groups){
+        res.push_back(g.second);
+    }
+    return res;
+}
+
+// Ensure proper creation of object and no return before execution
+TEST(GroupJoinTest, CreationTester) {
+    uniform_generator uni(0, 10000, 1000);
+    uni.build();
+    auto left = uni.get_vec_copy();
+    uni.build();
+    auto right = uni.get_vec_copy();
+    group_join join(left.data(), right.data(), 1000, 1000);
+    ASSERT_ANY_THROW(join.get());
+}
+
+// No result should be returned
+TEST(GroupJoinTest, NoResTester) {
+    uniform_generator gen(0, 10000, 1000);
+    gen.build();
+    auto left = gen.get_vec_copy();
+    gen = uniform_generator(20000, 30000, 1000);
+    gen.build();
+    auto right = gen.get_vec_copy();
+    group_join join(left.data(), right.data(), 1000, 1000);
+    join.execute();
+    ASSERT_EQ(join.get().size(), 0);
+}
+
+// A cross product collapses into a single group
+TEST(GroupJoinTest, CrossTester) {
+    uint64_t count = 1000;
+    uniform_generator uni(1, 1, count);
+    uni.build();
+    auto left = uni.get_vec_copy();
+    auto right = uni.get_vec_copy();
+    group_join join(left.data(), right.data(), count, count);
+    join.execute();
+    auto& res = join.get();
+    ASSERT_EQ(res.size(), 1);
+    ASSERT_EQ(res[0], group_join::group(1, count * count, count * (count * (count - 1) / 2), 0, count - 1));
+}
+
+// Compare against grouping the naive join result
+TEST(GroupJoinTest, ReferenceTester) {
+    uniform_generator gen(1, 2000, 5000);
+    gen.build();
+    auto left = gen.get_vec_copy();
+    gen = uniform_generator(1, 4000, 20000);
+    gen.build();
+    auto right = gen.get_vec_copy();
+    group_join join(left.data(), right.data(), left.size(), right.size(), 0.5);
+    join.execute();
+    auto res = join.get();
+    std::sort(res.begin(), res.end());
+    ASSERT_EQ(res, group_reference(left, right));
+}
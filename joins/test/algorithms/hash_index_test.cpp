@@ -0,0 +1,123 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "generators/uniform_generator.h"
+#include "generators/zipf_generator.h"
+#include "algorithms/hash_index.h"
+#include "algorithms/spill_file.h"
+#include "algorithms/nop_join_mt.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <unistd.h>
+
+using namespace generators;  // NOLINT
+using namespace algorithms; // NOLINT
+
+/*
+ * Helper function. Flattens the vector of output vectors into one sorted vector.
+ */
+std::vector<hash_index::triple> get_sorted_index(std::vector<std::vector<hash_index::triple>> &output){
+    std::vector<hash_index::triple> flat;
+    for(auto& vec: output){
+        flat.insert(flat.end(), vec.begin(), vec.end());
+    }
+    std::sort(flat.begin(), flat.end());
+    return flat;
+}
+
+/*
+ * Helper function. Returns a file name in the spill directory which is unique to the process.
+ */
+std::string get_path_index(const std::string& name){
+    return helpers::default_spill_directory() + "/hashjoins_" + std::to_string(getpid()) + "_" + name;
+}
+
+// Single and multi threaded builds answer probes like a join building a fresh table
+TEST(HashIndexTest, ProbeTester) {
+    uniform_generator gen_l(1, 1 << 14, 1 << 17);
+    gen_l.build();
+    auto left = gen_l.get_vec_copy();
+    zipf_generator gen_r(1 << 14, 0.8, 1 << 16);
+    gen_r.build();
+    auto right = gen_r.get_vec_copy();
+    for(auto type: {helpers::join_type::inner, helpers::join_type::right_outer}){
+        nop_join_mt reference(left.data(), right.data(), left.size(), right.size(), 1.5, 2, type);
+        reference.execute();
+        auto expected = get_sorted_index(reference.get());
+        helpers::executor exec(4);
+        hash_index single(left.data(), left.size());
+        hash_index parallel(left.data(), left.size(), 1.5, 4, exec);
+        ASSERT_EQ(single.size(), left.size());
+        ASSERT_EQ(parallel.buckets(), single.buckets());
+        ASSERT_EQ(parallel.memory_bytes(), hash_index::estimate_bytes(left.size(), 1.5));
+        std::vector<std::vector<hash_index::triple>> out(1);
+        single.probe(right.data(), right.size(), type, out[0]);
+        ASSERT_EQ(get_sorted_index(out), expected);
+        out.clear();
+        parallel.probe(right.data(), right.size(), type, 4, out);
+        ASSERT_EQ(get_sorted_index(out), expected);
+    }
+    hash_index index(left.data(), left.size());
+    std::vector<hash_index::triple> out;
+    ASSERT_THROW(index.probe(right.data(), right.size(), helpers::join_type::left_outer, out), std::invalid_argument);
+}
+
+// Any number of threads probe one index at the same time
+TEST(HashIndexTest, ConcurrentTester) {
+    uniform_generator gen_l(1, 1 << 12, 1 << 15);
+    gen_l.build();
+    auto left = gen_l.get_vec_copy();
+    uniform_generator gen_r(1, 1 << 12, 1 << 14);
+    gen_r.build();
+    auto right = gen_r.get_vec_copy();
+    hash_index index(left.data(), left.size(), 1.5, 2);
+    std::vector<hash_index::triple> expected;
+    index.probe(right.data(), right.size(), helpers::join_type::inner, expected);
+    std::sort(expected.begin(), expected.end());
+    std::vector<std::vector<hash_index::triple>> results(4);
+    std::vector<std::thread> threads;
+    for(auto& res: results){
+        threads.emplace_back([&index, &right, &res]{
+            index.probe(right.data(), right.size(), helpers::join_type::inner, res);
+            std::sort(res.begin(), res.end());
+        });
+    }
+    for(auto& thread: threads){
+        thread.join();
+    }
+    for(auto& res: results){
+        ASSERT_EQ(res, expected);
+    }
+}
+
+// Saved indexes load without a rebuild, files of something else get rejected
+TEST(HashIndexTest, SaveTester) {
+    uniform_generator gen_l(1, 1 << 12, 1 << 15);
+    gen_l.build();
+    auto left = gen_l.get_vec_copy();
+    uniform_generator gen_r(1, 1 << 12, 1 << 14);
+    gen_r.build();
+    auto right = gen_r.get_vec_copy();
+    hash_index index(left.data(), left.size(), 2.0, 2);
+    std::string path = get_path_index("index");
+    index.save(path);
+    hash_index loaded(path);
+    ASSERT_EQ(loaded.size(), index.size());
+    ASSERT_EQ(loaded.buckets(), index.buckets());
+    std::vector<hash_index::triple> expected;
+    index.probe(right.data(), right.size(), helpers::join_type::inner, expected);
+    std::vector<hash_index::triple> actual;
+    loaded.probe(right.data(), right.size(), helpers::join_type::inner, actual);
+    ASSERT_EQ(actual, expected);
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << "not an index";
+    }
+    ASSERT_THROW(hash_index broken(path), std::runtime_error);
+    std::remove(path.c_str());
+    ASSERT_THROW(hash_index missing(path), std::runtime_error);
+}
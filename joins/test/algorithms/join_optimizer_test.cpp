@@ -0,0 +1,86 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "generators/incremental_generator.h"
+#include "generators/uniform_generator.h"
+#include "generators/zipf_generator.h"
+#include "algorithms/join_optimizer.h"
+#include "algorithms/nop_join_mt.h"
+#include "gtest/gtest.h"
+
+using namespace generators;  // NOLINT
+using namespace algorithms; // NOLINT
+
+/*
+ * Helper function. Takes the vector of output vectors and calculates the total length
+ * of the output.
+ */
+uint64_t get_size_optimizer(std::vector<std::vector<join_optimizer::triple>> &output){
+    uint64_t size = 0;
+    for(auto& vec: output){
+        size += vec.size();
+    }
+    return size;
+}
+
+// Detection always yields a usable memory hierarchy
+TEST(JoinOptimizerTest, DetectTester) {
+    cache_info caches = join_optimizer::detect_caches();
+    ASSERT_GT(caches.l2_bytes, 0);
+    ASSERT_GE(caches.llc_bytes, caches.l2_bytes);
+    ASSERT_GE(caches.tlb_entries, 2);
+    ASSERT_EQ(join_optimizer::machine().l2_bytes, caches.l2_bytes);
+}
+
+// Results can only be queried after execution
+TEST(JoinOptimizerTest, NotBuiltTester) {
+    incremental_generator gen(1, 100);
+    gen.build();
+    auto data = gen.get_vec_copy();
+    join_optimizer join(data.data(), data.data(), 100, 100);
+    ASSERT_THROW(join.get(), std::logic_error);
+}
+
+// Build sides fitting into the private cache are joined without partitioning
+TEST(JoinOptimizerTest, NopChoiceTester) {
+    uint64_t count = 1 << 10;
+    incremental_generator gen_l(1, count);
+    gen_l.build();
+    auto left = gen_l.get_vec_copy();
+    uniform_generator gen_r(1, count, 1 << 14);
+    gen_r.build();
+    auto right = gen_r.get_vec_copy();
+    nop_join_mt reference(left.data(), right.data(), left.size(), right.size(), 1.5, 1);
+    reference.execute();
+    join_optimizer join(left.data(), right.data(), left.size(), right.size(), 4, helpers::join_type::inner,
+                        cache_info());
+    join.execute();
+    ASSERT_FALSE(join.plan().partition);
+    ASSERT_EQ(join.report().find("nop_join_mt"), 0);
+    ASSERT_EQ(get_size_optimizer(join.get()), get_size_optimizer(reference.get()));
+}
+
+// Build sides exceeding the private cache get partitioned, outer semantics are kept
+TEST(JoinOptimizerTest, RadixChoiceTester) {
+    uint64_t count = 1 << 15;
+    uniform_generator gen_l(1, 1 << 16, count);
+    gen_l.build();
+    auto left = gen_l.get_vec_copy();
+    zipf_generator gen_r(1 << 16, 1.0, count);
+    gen_r.build();
+    auto right = gen_r.get_vec_copy();
+    auto l = left;
+    auto r = right;
+    nop_join_mt reference(l.data(), r.data(), count, count, 1.5, 2, helpers::join_type::full_outer);
+    reference.execute();
+    cache_info caches;
+    caches.l2_bytes = 1 << 15;
+    caches.llc_bytes = 1 << 17;
+    join_optimizer join(left.data(), right.data(), count, count, 4, helpers::join_type::full_outer, caches);
+    join.execute();
+    ASSERT_TRUE(join.plan().partition);
+    ASSERT_EQ(join.report().find("radix_join_mt"), 0);
+    ASSERT_NE(join.report().find("l2=32768"), std::string::npos);
+    ASSERT_EQ(get_size_optimizer(join.get()), get_size_optimizer(reference.get()));
+}
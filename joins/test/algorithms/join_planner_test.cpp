@@ -0,0 +1,112 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "generators/incremental_generator.h"
+#include "generators/uniform_generator.h"
+#include "generators/zipf_generator.h"
+#include "algorithms/join_planner.h"
+#include "algorithms/nop_join_mt.h"
+#include "algorithms/mt_radix/radix_join_mt.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+
+using namespace generators;  // NOLINT
+using namespace algorithms; // NOLINT
+
+/*
+ * Helper function. Takes the vector of output vectors and calculates the total length
+ * of the output.
+ */
+uint64_t get_size_planner(std::vector<std::vector<radix_join_mt::triple>> &output){
+    uint64_t size = 0;
+    for(auto& vec: output){
+        size += vec.size();
+    }
+    return size;
+}
+
+// Build sides whose table fits into the private cache are not partitioned, small inputs are counted exactly
+TEST(JoinPlannerTest, SmallBuildTester) {
+    incremental_generator gen(1, 1000);
+    gen.build();
+    auto left = gen.get_vec_copy();
+    auto right = gen.get_vec_copy();
+    join_planner planner(left.data(), right.data(), left.size(), right.size());
+    join_plan plan = planner.plan();
+    ASSERT_FALSE(plan.partition);
+    ASSERT_EQ(plan.distinct_l, 1000);
+    ASSERT_EQ(plan.distinct_r, 1000);
+    ASSERT_TRUE(plan.heavy_hitters.empty());
+    ASSERT_EQ(plan.split_threshold, 0);
+}
+
+// Large build sides get a fanout bringing the partitions into the cache without exceeding the TLB per pass
+TEST(JoinPlannerTest, LargeBuildTester) {
+    uint64_t count = 1 << 20;
+    incremental_generator gen(1, count);
+    gen.build();
+    auto left = gen.get_vec_copy();
+    auto right = gen.get_vec_copy();
+    cache_info caches;
+    caches.tlb_entries = 32;
+    join_planner planner(left.data(), right.data(), count, count, 1 << 14, caches, 7);
+    join_plan plan = planner.plan();
+    ASSERT_TRUE(plan.partition);
+    ASSERT_LE(plan.bits_per_pass, 5);
+    // 1.5 * 2^20 buckets of 48 bytes need a fanout of 2^9 to fit into 256KiB
+    ASSERT_GE(plan.bits_per_pass * plan.passes, 9);
+    ASSERT_LT(plan.skew_l, 0.01);
+    // The estimator may be off by at most the square root of the sampling ratio
+    ASSERT_GE(plan.distinct_l, count / 8);
+    ASSERT_LE(plan.distinct_l, count);
+}
+
+// A zipf distributed probe side reports its most frequent key and lowers the split threshold
+TEST(JoinPlannerTest, HeavyHitterTester) {
+    uint64_t count = 1 << 16;
+    uniform_generator gen_l(1, 10000, count);
+    gen_l.build();
+    auto left = gen_l.get_vec_copy();
+    zipf_generator gen_r(10000, 1.5, count);
+    gen_r.build();
+    auto right = gen_r.get_vec_copy();
+    join_planner planner(left.data(), right.data(), count, count);
+    join_plan plan = planner.plan();
+    ASSERT_GT(plan.skew_r, 0.25);
+    ASSERT_LT(plan.skew_l, 0.01);
+    ASSERT_TRUE(std::binary_search(plan.heavy_hitters.begin(), plan.heavy_hitters.end(), 1));
+    ASSERT_GT(plan.split_threshold, 0);
+    ASSERT_LT(plan.morsel_size, nop_join_mt::default_morsel);
+    ASSERT_LT(plan.distinct_r, 10000);
+}
+
+// Both joins produce the same result when configured through a plan
+TEST(JoinPlannerTest, PlannedJoinTester) {
+    uint64_t count = 1 << 15;
+    uniform_generator gen_l(1, 1 << 12, count);
+    gen_l.build();
+    auto left = gen_l.get_vec_copy();
+    zipf_generator gen_r(1 << 12, 1.2, count);
+    gen_r.build();
+    auto right = gen_r.get_vec_copy();
+    cache_info caches;
+    caches.l2_bytes = 1 << 14;
+    join_planner planner(left.data(), right.data(), count, count, 1 << 12, caches, 3);
+    join_plan plan = planner.plan();
+    ASSERT_TRUE(plan.partition);
+    ASSERT_FALSE(plan.heavy_hitters.empty());
+    auto l = left;
+    auto r = right;
+    nop_join_mt reference(l.data(), r.data(), count, count, 1.5, 1);
+    reference.execute();
+    uint64_t expected = get_size_planner(reference.get());
+    nop_join_mt nop(left.data(), right.data(), count, count, 1.5, 4);
+    nop.set_plan(plan);
+    nop.execute();
+    ASSERT_EQ(get_size_planner(nop.get()), expected);
+    radix_join_mt radix(left.data(), right.data(), count, count, 1.5, 4, 4, 1);
+    radix.set_plan(plan);
+    radix.execute();
+    ASSERT_EQ(get_size_planner(radix.get()), expected);
+}
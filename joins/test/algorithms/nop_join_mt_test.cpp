@@ -182,4 +182,120 @@ TEST(NopTestMT, StatisticalTesterMT){
     auto expected = static_cast<uint64_t>(max * (static_cast<double>(count)/max) * static_cast<double>((count))/max);
     ASSERT_LE(0.95 * expected, get_size_nop(join.get()));
     ASSERT_GE(1.05 * expected, get_size_nop(join.get()));
-}
\ No newline at end of file
+}
+/*
+ * Helper function. Counts the output triples in which the left (or right) rid is missing,
+ * i.e. the tuples emitted because of outer join semantics.
+ */
+uint64_t get_null_nop(std::vector<std::vector<nop_join_mt::triple>> &output, bool left_missing){
+    uint64_t size = 0;
+    for(auto& vec: output){
+        for(auto& t: vec){
+            size += (left_missing ? std::get<1>(t) : std::get<2>(t)) == helpers::null_rid;
+        }
+    }
+    return size;
+}
+
+/*
+ * Helper function. Creates overlapping relations, the left side contains the keys [0, 1000)
+ * each one twice while the right side contains the keys [500, 1500).
+ */
+void outer_data_nop(std::vector<nop_join_mt::tuple>& left, std::vector<nop_join_mt::tuple>& right){
+    for(uint64_t k = 0; k < 1000; ++k){
+        left.emplace_back(k, 2 * k);
+        left.emplace_back(k, 2 * k + 1);
+        right.emplace_back(k + 500, k);
+    }
+}
+
+// Left outer join has to emit every unmatched build tuple exactly once
+TEST(NopTestMT, LeftOuterTesterMT) {
+    std::vector<nop_join_mt::tuple> left, right;
+    outer_data_nop(left, right);
+    nop_join_mt join(left.data(), right.data(), left.size(), right.size(), 1.5, thread_count,
+                     helpers::join_type::left_outer);
+    join.execute();
+    ASSERT_EQ(get_size_nop(join.get()), 2000);
+    ASSERT_EQ(get_null_nop(join.get(), false), 1000);
+    ASSERT_EQ(get_null_nop(join.get(), true), 0);
+}
+
+// Right outer join has to emit every unmatched probe tuple exactly once
+TEST(NopTestMT, RightOuterTesterMT) {
+    std::vector<nop_join_mt::tuple> left, right;
+    outer_data_nop(left, right);
+    nop_join_mt join(left.data(), right.data(), left.size(), right.size(), 1.5, thread_count,
+                     helpers::join_type::right_outer);
+    join.execute();
+    ASSERT_EQ(get_size_nop(join.get()), 1500);
+    ASSERT_EQ(get_null_nop(join.get(), true), 500);
+    ASSERT_EQ(get_null_nop(join.get(), false), 0);
+}
+
+// Full outer join on a small table forcing long overflow chains
+TEST(NopTestMT, FullOuterTesterMT) {
+    std::vector<nop_join_mt::tuple> left, right;
+    outer_data_nop(left, right);
+    nop_join_mt join(left.data(), right.data(), left.size(), right.size(), 0.01, thread_count,
+                     helpers::join_type::full_outer);
+    join.execute();
+    ASSERT_EQ(get_size_nop(join.get()), 2500);
+    ASSERT_EQ(get_null_nop(join.get(), true), 500);
+    ASSERT_EQ(get_null_nop(join.get(), false), 1000);
+}
+
+// Outer joins on an empty probe side emit the whole build side
+TEST(NopTestMT, EmptyOuterTesterMT) {
+    std::vector<nop_join_mt::tuple> left, right;
+    outer_data_nop(left, right);
+    nop_join_mt join(left.data(), right.data(), left.size(), 0, 1.5, thread_count,
+                     helpers::join_type::full_outer);
+    join.execute();
+    ASSERT_EQ(get_size_nop(join.get()), 2000);
+    ASSERT_EQ(get_null_nop(join.get(), false), 2000);
+}
+
+// Tiny morsels on a private executor, every probe and scan morsel writes its own output vector
+TEST(NopTestMT, MorselTesterMT) {
+    std::vector<nop_join_mt::tuple> left, right;
+    outer_data_nop(left, right);
+    helpers::executor exec(thread_count);
+    nop_join_mt join(left.data(), right.data(), left.size(), right.size(), 1.5, thread_count,
+                     helpers::join_type::full_outer, 7);
+    join.set_executor(exec);
+    join.execute();
+    uint64_t table = static_cast<uint64_t>(1.5 * left.size());
+    ASSERT_EQ(join.get().size(), (right.size() + 6) / 7 + (table + 6) / 7);
+    ASSERT_EQ(get_size_nop(join.get()), 2500);
+    ASSERT_EQ(get_null_nop(join.get(), true), 500);
+    ASSERT_EQ(get_null_nop(join.get(), false), 1000);
+}
+
+// Morsel size zero falls back to one static range per thread
+TEST(NopTestMT, StaticRangeTesterMT) {
+    uint64_t count = 1000;
+    uniform_generator uni(1, 1, count);
+    uni.build();
+    auto left = uni.get_vec_copy();
+    uni.build();
+    auto right = uni.get_vec_copy();
+    nop_join_mt join(left.data(), right.data(), count, count, 1.5, thread_count, helpers::join_type::inner, 0);
+    join.execute();
+    ASSERT_EQ(join.get().size(), thread_count);
+    ASSERT_EQ(get_size_nop(join.get()), count*count);
+}
+
+// Vectors passed through set() keep their contents, the results get appended
+TEST(NopTestMT, SetTesterMT) {
+    std::vector<nop_join_mt::tuple> left, right;
+    outer_data_nop(left, right);
+    nop_join_mt join(left.data(), right.data(), left.size(), right.size(), 1.5, thread_count,
+                     helpers::join_type::inner, 7);
+    std::vector<std::vector<nop_join_mt::triple>> res(2);
+    res[1].emplace_back(1, 2, 3);
+    join.set(res);
+    join.execute();
+    ASSERT_EQ(join.get()[1].front(), nop_join_mt::triple(1, 2, 3));
+    ASSERT_EQ(get_size_nop(join.get()), 1001);
+}
@@ -91,5 +91,20 @@ TEST(NopTest, StatisticalTester){
     ASSERT_GE(1.05 * expected, join.get().size());
 }
 
-
-
+// The hash table follows the requested table size, the result does not depend on it
+TEST(NopTest, TableSizeTester){
+    uint64_t count = 1000;
+    uniform_generator gen(1, 100, count);
+    gen.build();
+    auto left = gen.get_vec_copy();
+    gen.build();
+    auto right = gen.get_vec_copy();
+    nop_join small(left.data(), right.data(), count, count, 0.5);
+    ASSERT_EQ(small.buckets(), 0);
+    small.execute();
+    ASSERT_EQ(small.buckets(), count / 2);
+    nop_join large(left.data(), right.data(), count, count, 2.0);
+    large.execute();
+    ASSERT_EQ(large.buckets(), 2 * count);
+    ASSERT_EQ(small.get().size(), large.get().size());
+}
@@ -0,0 +1,188 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "generators/uniform_generator.h"
+#include "algorithms/numa.h"
+#include "algorithms/numa_hash_table.h"
+#include "algorithms/executor.h"
+#include "algorithms/nop_join_mt.h"
+#include "algorithms/mt_radix/radix_join_mt.h"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <cstring>
+#include <sched.h>
+#include <unistd.h>
+
+using namespace generators;  // NOLINT
+using namespace algorithms; // NOLINT
+
+/*
+ * Helper function. Takes the vector of output vectors and calculates the total length
+ * of the output.
+ */
+uint64_t get_size_numa(std::vector<std::vector<radix_join_mt::triple>> &output){
+    uint64_t size = 0;
+    for(auto& vec: output){
+        size += vec.size();
+    }
+    return size;
+}
+
+/*
+ * Helper function. Records the number of CPUs the calling worker may run on.
+ */
+void record_affinity_numa(std::atomic<uint64_t>* max_cpus){
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    sched_getaffinity(0, sizeof(set), &set);
+    auto count = static_cast<uint64_t>(CPU_COUNT(&set));
+    uint64_t seen = max_cpus->load();
+    while(count > seen && !max_cpus->compare_exchange_weak(seen, count)){}
+}
+
+// Sysfs CPU lists get expanded, broken ones are rejected
+TEST(NumaTest, CpuListTester) {
+    auto cpus = helpers::numa_topology::parse_cpulist("0-3,8,10-11");
+    std::vector<uint32_t> expected{0, 1, 2, 3, 8, 10, 11};
+    ASSERT_EQ(cpus, expected);
+    ASSERT_TRUE(helpers::numa_topology::parse_cpulist("").empty());
+    ASSERT_THROW(helpers::numa_topology::parse_cpulist("0-a"), std::runtime_error);
+}
+
+// Workers are spread round robin over the nodes of a simulated topology
+TEST(NumaTest, FakeTopologyTester) {
+    auto topology = helpers::numa_topology::fake(2, 4);
+    ASSERT_TRUE(topology.simulated());
+    ASSERT_EQ(topology.nodes(), 2);
+    ASSERT_EQ(topology.node_of_worker(0), 0);
+    ASSERT_EQ(topology.node_of_worker(1), 1);
+    ASSERT_EQ(topology.node_of_worker(2), 0);
+    // The machine always has at least one node
+    ASSERT_GE(helpers::numa_topology::detect().nodes(), 1);
+    helpers::executor exec(6, topology, false);
+    ASSERT_EQ(exec.workers_on(0).size(), 3);
+    ASSERT_EQ(exec.workers_on(1).size(), 3);
+    ASSERT_EQ(exec.workers_on(1)[0], 1);
+}
+
+// Pinned workers may only run on a single CPU, node local posts all get executed
+TEST(NumaTest, PinTester) {
+    helpers::executor exec(4, helpers::numa_topology::fake(2, 2), true);
+    ASSERT_TRUE(exec.pinned());
+    std::atomic<uint64_t> max_cpus(0);
+    helpers::executor::task_group tasks(exec);
+    for(uint32_t k = 0; k < 32; ++k){
+        tasks.post_on(k % 2, record_affinity_numa, &max_cpus);
+    }
+    tasks.wait();
+    ASSERT_EQ(max_cpus, 1);
+}
+
+// Buffers are page aligned and usable, binding on simulated nodes is a no-op
+TEST(NumaTest, BufferTester) {
+    helpers::page_buffer empty(0);
+    ASSERT_EQ(empty.data(), nullptr);
+    helpers::page_buffer buffer(1 << 20);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(buffer.data()) % 4096, 0);
+    ASSERT_EQ(buffer.size(), 1 << 20);
+    auto topology = helpers::numa_topology::fake(2, 1);
+    ASSERT_TRUE(topology.bind(buffer.data(), buffer.size() / 2, 0));
+    ASSERT_TRUE(topology.bind(buffer.as<char>() + buffer.size() / 2, buffer.size() / 2, 1));
+    ASSERT_TRUE(topology.bind(buffer.data(), buffer.size(), 0, helpers::huge_page_bytes, false));
+    // Huge page buffers have to be bound in whole huge pages
+    ASSERT_EQ(helpers::page_bytes(helpers::page_mode::huge), helpers::huge_page_bytes);
+    ASSERT_EQ(helpers::page_bytes(helpers::page_mode::small), static_cast<size_t>(sysconf(_SC_PAGESIZE)));
+    std::memset(buffer.data(), 7, buffer.size());
+    ASSERT_EQ(buffer.as<char>()[buffer.size() - 1], 7);
+}
+
+// NUMA placement on a simulated two node machine does not change the result
+TEST(NumaTest, RadixPlacementTester) {
+    helpers::executor exec(4, helpers::numa_topology::fake(2, 2), true);
+    uint64_t count = 1 << 15;
+    uniform_generator gen(1, 1 << 12, count);
+    gen.build();
+    auto left = gen.get_vec_copy();
+    gen.build();
+    auto right = gen.get_vec_copy();
+    for(auto type: {helpers::join_type::inner, helpers::join_type::full_outer}){
+        auto l = left;
+        auto r = right;
+        nop_join_mt reference(l.data(), r.data(), count, count, 1.5, 2, type);
+        reference.execute();
+        uint64_t expected = get_size_numa(reference.get());
+        for(uint8_t passes = 1; passes <= 2; ++passes){
+            l = left;
+            r = right;
+            radix_join_mt join(l.data(), r.data(), count, count, 1.5, 4, 4, passes, type);
+            join.set_executor(exec);
+            join.set_numa(true);
+            join.execute();
+            ASSERT_EQ(get_size_numa(join.get()), expected);
+            ASSERT_EQ(join.unbound_ranges(), 0);
+        }
+    }
+}
+
+// Chunks cover the whole table, every key is found on the node owning its bucket
+TEST(NumaTest, HashTableChunkTester) {
+    auto topology = helpers::numa_topology::fake(3, 1);
+    helpers::numa_hash_table table(1000, 3);
+    ASSERT_EQ(table.nodes(), 3);
+    ASSERT_EQ(table.size(), 1000);
+    for(uint32_t node = 0; node < 3; ++node){
+        table.allocate(node, node, topology);
+    }
+    ASSERT_EQ(table.unbound_chunks(), 0);
+    std::vector<uint64_t> per_node(3, 0);
+    for(uint64_t k = 0; k < 3000; ++k){
+        table.insert(helpers::numa_hash_table::tuple(k, k));
+        ++per_node[table.node_of(k)];
+    }
+    for(uint64_t count: per_node){
+        ASSERT_GT(count, 0);
+    }
+    std::vector<helpers::numa_hash_table::triple> out;
+    for(uint64_t k = 0; k < 3000; ++k){
+        ASSERT_TRUE(table.probe(helpers::numa_hash_table::tuple(k, k), k % 2 == 0, out));
+    }
+    ASSERT_EQ(out.size(), 3000);
+    // Only the unmarked half is emitted, ranges crossing chunk borders included
+    out.clear();
+    table.scan(0, 500, out);
+    table.scan(500, 1000, out);
+    ASSERT_EQ(out.size(), 1500);
+    // A replica with a single chunk holds the same tuples
+    helpers::numa_hash_table replica(1000, 1);
+    replica.allocate(0, 1, topology);
+    replica.copy_from(table, 0, 333);
+    replica.copy_from(table, 333, 1000);
+    out.clear();
+    replica.scan(0, 1000, out);
+    ASSERT_EQ(out.size(), 3000);
+}
+
+// Interleaved and replicated tables on a simulated two node machine do not change the result
+TEST(NumaTest, NopPlacementTester) {
+    helpers::executor exec(4, helpers::numa_topology::fake(2, 2), true);
+    uint64_t count = 1 << 15;
+    uniform_generator gen(1, 1 << 12, count);
+    gen.build();
+    auto left = gen.get_vec_copy();
+    gen.build();
+    auto right = gen.get_vec_copy();
+    for(auto type: {helpers::join_type::inner, helpers::join_type::right_outer, helpers::join_type::full_outer}){
+        nop_join_mt reference(left.data(), right.data(), count, count, 1.5, 2, type);
+        reference.execute();
+        uint64_t expected = get_size_numa(reference.get());
+        for(auto placement: {nop_join_mt::table_placement::interleaved, nop_join_mt::table_placement::replicated}){
+            nop_join_mt join(left.data(), right.data(), count, count, 1.5, 4, type, 1000);
+            join.set_executor(exec);
+            join.set_placement(placement);
+            join.execute();
+            ASSERT_EQ(get_size_numa(join.get()), expected);
+            ASSERT_EQ(join.unbound_chunks(), 0);
+        }
+    }
+}
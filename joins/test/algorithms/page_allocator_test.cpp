@@ -0,0 +1,110 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "generators/uniform_generator.h"
+#include "algorithms/page_allocator.h"
+#include "algorithms/nop_join_mt.h"
+#include "algorithms/mt_radix/radix_join_mt.h"
+#include "gtest/gtest.h"
+#include <cstring>
+
+using namespace generators;  // NOLINT
+using namespace algorithms; // NOLINT
+
+/*
+ * Helper function. Takes the vector of output vectors and calculates the total length
+ * of the output.
+ */
+uint64_t get_size_pages(std::vector<std::vector<radix_join_mt::triple>> &output){
+    uint64_t size = 0;
+    for(auto& vec: output){
+        size += vec.size();
+    }
+    return size;
+}
+
+/*
+ * Helper type. Counts its living instances to check construction and destruction of page arrays.
+ */
+struct counted_pages {
+    static int64_t alive;
+    uint64_t value;
+    counted_pages(): value(42) { ++alive; }
+    ~counted_pages() { --alive; }
+};
+int64_t counted_pages::alive = 0;
+
+// Mode names round trip, unknown ones are rejected
+TEST(PageAllocatorTest, ParseTester) {
+    for(auto mode: {helpers::page_mode::small, helpers::page_mode::transparent, helpers::page_mode::huge,
+                    helpers::page_mode::automatic}){
+        ASSERT_EQ(helpers::parse_pages(helpers::page_name(mode)), mode);
+    }
+    ASSERT_THROW(helpers::parse_pages("giant"), std::invalid_argument);
+}
+
+// Every mode yields usable memory, unavailable pages fall back instead of failing
+TEST(PageAllocatorTest, FallbackTester) {
+    size_t bytes = 3 * helpers::huge_page_bytes + 123;
+    for(auto mode: {helpers::page_mode::small, helpers::page_mode::transparent, helpers::page_mode::huge,
+                    helpers::page_mode::automatic}){
+        helpers::page_buffer buffer(bytes, mode);
+        ASSERT_NE(buffer.data(), nullptr);
+        ASSERT_EQ(buffer.size(), bytes);
+        ASSERT_NE(buffer.pages(), helpers::page_mode::automatic);
+        if(buffer.pages() != helpers::page_mode::small){
+            ASSERT_EQ(reinterpret_cast<uintptr_t>(buffer.data()) % helpers::huge_page_bytes, 0);
+        }
+        std::memset(buffer.data(), 3, bytes);
+        ASSERT_EQ(buffer.as<char>()[bytes - 1], 3);
+    }
+    // Small pages are never upgraded, small automatic buffers stay on small pages
+    ASSERT_EQ(helpers::page_buffer(bytes, helpers::page_mode::small).pages(), helpers::page_mode::small);
+    ASSERT_EQ(helpers::page_buffer(4096, helpers::page_mode::automatic).pages(), helpers::page_mode::small);
+    helpers::page_buffer empty(0, helpers::page_mode::huge);
+    ASSERT_EQ(empty.data(), nullptr);
+}
+
+// Elements of page arrays get constructed and destroyed on the heap and in mapped buffers
+TEST(PageAllocatorTest, ArrayTester) {
+    size_t large = 2 * helpers::huge_page_bytes / sizeof(counted_pages);
+    for(size_t count: {static_cast<size_t>(16), large}){
+        {
+            helpers::page_array<counted_pages> arr(count);
+            ASSERT_EQ(counted_pages::alive, static_cast<int64_t>(count));
+            ASSERT_EQ(arr[count - 1].value, 42);
+            arr[0].value = 7;
+            ASSERT_EQ(arr.get()->value, 7);
+        }
+        ASSERT_EQ(counted_pages::alive, 0);
+    }
+    ASSERT_EQ(helpers::page_array<counted_pages>(16).pages(), helpers::page_mode::small);
+}
+
+// The page mode of hash tables and scatter buffers does not change join results
+TEST(PageAllocatorTest, JoinTester) {
+    uint64_t count = 1 << 18;
+    uniform_generator gen(1, 1 << 16, count);
+    gen.build();
+    auto left = gen.get_vec_copy();
+    gen.build();
+    auto right = gen.get_vec_copy();
+    helpers::page_mode previous = helpers::default_pages();
+    nop_join_mt reference(left.data(), right.data(), count, count, 1.5, 2);
+    reference.execute();
+    uint64_t expected = get_size_pages(reference.get());
+    for(auto mode: {helpers::page_mode::small, helpers::page_mode::transparent, helpers::page_mode::huge}){
+        helpers::set_default_pages(mode);
+        ASSERT_EQ(helpers::default_pages(), mode);
+        nop_join_mt nop(left.data(), right.data(), count, count, 1.5, 2);
+        nop.execute();
+        ASSERT_EQ(get_size_pages(nop.get()), expected);
+        auto l = left;
+        auto r = right;
+        radix_join_mt radix(l.data(), r.data(), count, count, 1.5, 4, 2, 2);
+        radix.execute();
+        ASSERT_EQ(get_size_pages(radix.get()), expected);
+    }
+    helpers::set_default_pages(previous);
+}
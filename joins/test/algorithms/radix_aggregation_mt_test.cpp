@@ -0,0 +1,91 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "generators/uniform_generator.h"
+#include "generators/zipf_generator.h"
+#include "algorithms/mt_radix/radix_aggregation_mt.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <map>
+
+// Number of threads the program should be run on
+#define thread_count 4
+
+using namespace generators;  // NOLINT
+using namespace algorithms; // NOLINT
+
+/*
+ * Helper function. Computes the expected aggregation result with an ordered map.
+ */
+std::vector<radix_aggregation_mt::group> aggregate_reference(std::vector<radix_aggregation_mt::tuple>& data){
+    std::map<uint64_t, radix_aggregation_mt::group> groups;
+    for(auto& t: data){
+        auto ins = groups.emplace(std::get<0>(t), radix_aggregation_mt::group(std::get<0>(t), 0, 0, UINT64_MAX, 0));
+        auto& g = ins.first->second;
+        std::get<1>(g) += 1;
+        std::get<2>(g) += std::get<1>(t);
+        std::get<3>(g) = std::min(std::get<3>(g), std::get<1>(t));
+        std::get<4>(g) = std::max(std::get<4>(g), std::get<1>(t));
+    }
+    std::vector<radix_aggregation_mt::group> res;
+    for(auto& g: groups){
+        res.push_back(g.second);
+    }
+    return res;
+}
+
+/*
+ * Helper function. Flattens the per thread output vectors into a single sorted vector.
+ */
+std::vector<radix_aggregation_mt::group> flatten_aggregates(std::vector<std::vector<radix_aggregation_mt::group>>& out){
+    std::vector<radix_aggregation_mt::group> res;
+    for(auto& vec: out){
+        res.insert(res.end(), vec.begin(), vec.end());
+    }
+    std::sort(res.begin(), res.end());
+    return res;
+}
+
+// Ensure proper creation of object and no return before execution
+TEST(RadixAggregationTestMT, CreationTester) {
+    uniform_generator uni(0, 10000, 1000);
+    uni.build();
+    auto data = uni.get_vec_copy();
+    radix_aggregation_mt agg(data.data(), data.size(), 1.5, thread_count, 4, 1);
+    ASSERT_ANY_THROW(agg.get());
+}
+
+// A single key collapses into a single group
+TEST(RadixAggregationTestMT, SingleGroupTester) {
+    uniform_generator uni(7, 7, 1000);
+    uni.build();
+    auto data = uni.get_vec_copy();
+    radix_aggregation_mt agg(data.data(), data.size(), 1.5, thread_count, 4, 2);
+    agg.execute();
+    auto res = flatten_aggregates(agg.get());
+    ASSERT_EQ(res.size(), 1);
+    ASSERT_EQ(res[0], radix_aggregation_mt::group(7, 1000, 999 * 1000 / 2, 0, 999));
+}
+
+// Compare against the ordered map on a single pass
+TEST(RadixAggregationTestMT, ReferenceTesterSP) {
+    uniform_generator gen(1, 5000, 50000);
+    gen.build();
+    auto data = gen.get_vec_copy();
+    auto expected = aggregate_reference(data);
+    radix_aggregation_mt agg(data.data(), data.size(), 1.5, thread_count, 6, 1);
+    agg.execute();
+    ASSERT_EQ(flatten_aggregates(agg.get()), expected);
+}
+
+// Compare against the ordered map on skewed data with multiple passes
+TEST(RadixAggregationTestMT, ReferenceTesterMP) {
+    zipf_generator gen(1000, 1.25, 50000);
+    gen.build();
+    auto data = gen.get_vec_copy();
+    auto expected = aggregate_reference(data);
+    radix_aggregation_mt agg(data.data(), data.size(), 0.5, thread_count, 3, 3);
+    agg.execute();
+    ASSERT_EQ(flatten_aggregates(agg.get()), expected);
+}
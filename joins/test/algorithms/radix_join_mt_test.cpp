@@ -5,9 +5,14 @@
 
 #include "generators/uniform_generator.h"
 #include "algorithms/mt_radix/radix_join_mt.h"
+#include "algorithms/relation_file.h"
+#include "algorithms/spill_file.h"
 #include "gtest/gtest.h"
+#include <cstdio>
 #include <iostream>
+#include <algorithm>
 #include <chrono>
+#include <unistd.h>
 
 // Number of threads the program should be run on
 #define thread_count 4
@@ -248,3 +253,291 @@ TEST(RadixTestMT, StatisticalTesterMTMP){
     ASSERT_LE(0.95 * expected, get_size_radix(join.get()));
     ASSERT_GE(1.05 * expected, get_size_radix(join.get()));
 }
+
+
+/// Outer join tests, unmatched tuples get emitted per partition
+/*
+ * Helper function. Counts the output triples in which the left (or right) rid is missing,
+ * i.e. the tuples emitted because of outer join semantics.
+ */
+uint64_t get_null_radix(std::vector<std::vector<radix_join_mt::triple>> &output, bool left_missing){
+    uint64_t size = 0;
+    for(auto& vec: output){
+        for(auto& t: vec){
+            size += (left_missing ? std::get<1>(t) : std::get<2>(t)) == helpers::null_rid;
+        }
+    }
+    return size;
+}
+
+/*
+ * Helper function. Creates overlapping relations, the left side contains the keys [0, 1000)
+ * each one twice while the right side contains the keys [500, 1500).
+ */
+void outer_data_radix(std::vector<radix_join_mt::tuple>& left, std::vector<radix_join_mt::tuple>& right){
+    for(uint64_t k = 0; k < 1000; ++k){
+        left.emplace_back(k, 2 * k);
+        left.emplace_back(k, 2 * k + 1);
+        right.emplace_back(k + 500, k);
+    }
+}
+
+// Left outer join has to emit every unmatched build tuple exactly once
+TEST(RadixTestMT, LeftOuterTesterMTMP) {
+    std::vector<radix_join_mt::tuple> left, right;
+    outer_data_radix(left, right);
+    radix_join_mt join(left.data(), right.data(), left.size(), right.size(), 1.5, thread_count, part_bits,
+                       part_runs, helpers::join_type::left_outer);
+    join.execute();
+    ASSERT_EQ(get_size_radix(join.get()), 2000);
+    ASSERT_EQ(get_null_radix(join.get(), false), 1000);
+    ASSERT_EQ(get_null_radix(join.get(), true), 0);
+}
+
+// Right outer join has to emit every unmatched probe tuple exactly once
+TEST(RadixTestMT, RightOuterTesterMTSP) {
+    std::vector<radix_join_mt::tuple> left, right;
+    outer_data_radix(left, right);
+    radix_join_mt join(left.data(), right.data(), left.size(), right.size(), 1.5, thread_count, 8, 1,
+                       helpers::join_type::right_outer);
+    join.execute();
+    ASSERT_EQ(get_size_radix(join.get()), 1500);
+    ASSERT_EQ(get_null_radix(join.get(), true), 500);
+    ASSERT_EQ(get_null_radix(join.get(), false), 0);
+}
+
+// Full outer join, many partitions only contain data of one side
+TEST(RadixTestMT, FullOuterTesterMTMP) {
+    std::vector<radix_join_mt::tuple> left, right;
+    outer_data_radix(left, right);
+    radix_join_mt join(left.data(), right.data(), left.size(), right.size(), 1.5, thread_count, part_bits,
+                       part_runs, helpers::join_type::full_outer);
+    join.execute();
+    ASSERT_EQ(get_size_radix(join.get()), 2500);
+    ASSERT_EQ(get_null_radix(join.get(), true), 500);
+    ASSERT_EQ(get_null_radix(join.get(), false), 1000);
+}
+
+/*
+ * Helper function. Creates a heavily skewed probe side, the left side contains the keys [0, 100)
+ * with key 0 occurring three times while half of the 40000 right tuples carry key 0.
+ */
+void skew_data_radix(std::vector<radix_join_mt::tuple>& left, std::vector<radix_join_mt::tuple>& right){
+    for(uint64_t k = 0; k < 100; ++k){
+        left.emplace_back(k, k);
+    }
+    left.emplace_back(0, 100);
+    left.emplace_back(0, 101);
+    for(uint64_t k = 0; k < 40000; ++k){
+        right.emplace_back(k % 2 == 0 ? 0 : k, k);
+    }
+}
+
+// The oversized partition of key 0 gets probed by several tasks sharing one build table
+TEST(RadixTestMT, SkewSplitTesterMTMP) {
+    std::vector<radix_join_mt::tuple> left, right;
+    skew_data_radix(left, right);
+    helpers::executor exec(thread_count);
+    radix_join_mt join(left.data(), right.data(), left.size(), right.size(), 1.5, thread_count, 3, 2);
+    join.set_executor(exec);
+    join.set_skew_threshold(1000);
+    join.execute();
+    // Three partners per key 0 probe, one for every odd key below 100
+    ASSERT_EQ(get_size_radix(join.get()), 3 * 20000 + 50);
+}
+
+// The table size of a plan reaches the hash tables of the leaves
+TEST(RadixTestMT, PlanTableSizeTesterMTMP) {
+    uint64_t count = 1 << 16;
+    uniform_generator gen_l(1, 1 << 14, count);
+    gen_l.build();
+    auto left = gen_l.get_vec_copy();
+    uniform_generator gen_r(1, 1 << 14, count);
+    gen_r.build();
+    auto right = gen_r.get_vec_copy();
+    join_plan plan;
+    plan.bits_per_pass = 4;
+    plan.passes = 2;
+    std::vector<uint64_t> sizes;
+    for(double table_size: {0.5, 2.0}){
+        plan.table_size = table_size;
+        radix_join_mt join(left.data(), right.data(), count, count, 1.5, thread_count, 1, 1);
+        join.set_plan(plan);
+        join.execute();
+        // Every leaf rounds its table down, there are 256 of them
+        ASSERT_LE(join.leaf_buckets(), static_cast<uint64_t>(table_size * count));
+        ASSERT_GE(join.leaf_buckets() + 256, static_cast<uint64_t>(table_size * count));
+        sizes.push_back(get_size_radix(join.get()));
+    }
+    ASSERT_EQ(sizes[0], sizes[1]);
+}
+
+// Outer semantics are kept on split partitions, the last probe chunk emits the unmatched build tuples
+TEST(RadixTestMT, SkewSplitOuterTesterMTSP) {
+    std::vector<radix_join_mt::tuple> left, right;
+    skew_data_radix(left, right);
+    radix_join_mt join(left.data(), right.data(), left.size(), right.size(), 1.5, thread_count, 2, 1,
+                       helpers::join_type::full_outer);
+    join.set_skew_threshold(1000);
+    join.execute();
+    // Unmatched: all even keys except 0 on the left, all odd keys from 101 on the right
+    ASSERT_EQ(get_null_radix(join.get(), false), 49);
+    ASSERT_EQ(get_null_radix(join.get(), true), 20000 - 50);
+    ASSERT_EQ(get_size_radix(join.get()), 3 * 20000 + 50 + 49 + 20000 - 50);
+}
+
+// Every partitioning mode yields the same result, copying leaves the inputs untouched
+TEST(RadixTestMT, PartitionModeTesterMTMP) {
+    uint64_t count = 1 << 16;
+    uniform_generator uni(1, 1 << 13, count);
+    uni.build();
+    auto left = uni.get_vec_copy();
+    uni.build();
+    auto right = uni.get_vec_copy();
+    for(auto type: {helpers::join_type::inner, helpers::join_type::full_outer}){
+        for(uint8_t passes = 1; passes <= part_runs; ++passes){
+            auto l = left;
+            auto r = right;
+            radix_join_mt reference(l.data(), r.data(), count, count, 1.5, thread_count, part_bits, passes, type);
+            reference.execute();
+            uint64_t expected = get_size_radix(reference.get());
+            for(auto mode: {radix_join_mt::partition_mode::copy, radix_join_mt::partition_mode::in_place}){
+                l = left;
+                r = right;
+                radix_join_mt join(l.data(), r.data(), count, count, 1.5, thread_count, part_bits, passes, type);
+                join.set_partition_mode(mode);
+                join.execute();
+                ASSERT_EQ(join.used_partition_mode(), mode);
+                ASSERT_EQ(get_size_radix(join.get()), expected);
+                if(mode == radix_join_mt::partition_mode::copy){
+                    ASSERT_EQ(l, left);
+                    ASSERT_EQ(r, right);
+                } else {
+                    // In place partitioning only reorders the inputs
+                    std::sort(l.begin(), l.end());
+                    auto sorted = left;
+                    std::sort(sorted.begin(), sorted.end());
+                    ASSERT_EQ(l, sorted);
+                }
+            }
+        }
+    }
+}
+
+// Multi pass scratch partitioning over the budget falls back to in place, modes not touching the inputs throw
+TEST(RadixTestMT, MemoryBudgetTesterMTMP) {
+    uint64_t count = 1 << 14;
+    uniform_generator uni(1, 1 << 12, count);
+    uni.build();
+    auto left = uni.get_vec_copy();
+    uni.build();
+    auto right = uni.get_vec_copy();
+    uint64_t relations = 2 * count * sizeof(radix_join_mt::tuple);
+    auto l = left;
+    auto r = right;
+    radix_join_mt reference(l.data(), r.data(), count, count, 1.5, thread_count, part_bits, 2);
+    reference.execute();
+    uint64_t expected = get_size_radix(reference.get());
+    l = left;
+    r = right;
+    radix_join_mt fallback(l.data(), r.data(), count, count, 1.5, thread_count, part_bits, 2);
+    fallback.set_memory_budget(relations - 1);
+    fallback.execute();
+    ASSERT_EQ(fallback.used_partition_mode(), radix_join_mt::partition_mode::in_place);
+    ASSERT_EQ(get_size_radix(fallback.get()), expected);
+    // A single scratch pass never writes to the inputs, so it must not fall back to reordering them
+    l = left;
+    r = right;
+    radix_join_mt scratch(l.data(), r.data(), count, count, 1.5, thread_count, part_bits, 1);
+    scratch.set_memory_budget(relations - 1);
+    ASSERT_THROW(scratch.execute(), std::length_error);
+    scratch.set_memory_budget(relations);
+    scratch.execute();
+    ASSERT_EQ(scratch.used_partition_mode(), radix_join_mt::partition_mode::scratch);
+    ASSERT_EQ(get_size_radix(scratch.get()), expected);
+    ASSERT_EQ(l, left);
+    ASSERT_EQ(r, right);
+    // Two passes ping pong between two buffers per side, a single pass needs only one
+    radix_join_mt copy(left.data(), right.data(), count, count, 1.5, thread_count, part_bits, 2);
+    copy.set_partition_mode(radix_join_mt::partition_mode::copy);
+    copy.set_memory_budget(relations);
+    ASSERT_THROW(copy.execute(), std::length_error);
+    radix_join_mt single(left.data(), right.data(), count, count, 1.5, thread_count, part_bits, 1);
+    single.set_partition_mode(radix_join_mt::partition_mode::copy);
+    single.set_memory_budget(relations);
+    single.execute();
+    ASSERT_EQ(single.used_partition_mode(), radix_join_mt::partition_mode::copy);
+    ASSERT_EQ(get_size_radix(single.get()), expected);
+}
+
+// The first in place pass gets permuted by all threads, also if some partitions are larger than others
+TEST(RadixTestMT, InPlaceParallelTesterMTMP) {
+    uint64_t count = 1 << 18;
+    uniform_generator uni(1, 1 << 15, count);
+    uni.build();
+    auto left = uni.get_vec_copy();
+    uni.build();
+    auto right = uni.get_vec_copy();
+    // Every 64th tuple gets the same key, its partition holds half again as many tuples as the others
+    for(uint64_t k = 0; k < count; k += 64){
+        std::get<0>(left[k]) = 7;
+    }
+    helpers::executor exec(thread_count);
+    for(uint8_t passes = 1; passes <= 2; ++passes){
+        auto l = left;
+        auto r = right;
+        radix_join_mt reference(l.data(), r.data(), count, count, 1.5, thread_count, part_bits, passes);
+        reference.set_executor(exec);
+        reference.execute();
+        uint64_t expected = get_size_radix(reference.get());
+        l = left;
+        r = right;
+        radix_join_mt join(l.data(), r.data(), count, count, 1.5, thread_count, part_bits, passes);
+        join.set_executor(exec);
+        join.set_partition_mode(radix_join_mt::partition_mode::in_place);
+        join.execute();
+        ASSERT_EQ(get_size_radix(join.get()), expected);
+        std::sort(l.begin(), l.end());
+        std::sort(r.begin(), r.end());
+        auto sorted_l = left;
+        auto sorted_r = right;
+        std::sort(sorted_l.begin(), sorted_l.end());
+        std::sort(sorted_r.begin(), sorted_r.end());
+        ASSERT_EQ(l, sorted_l);
+        ASSERT_EQ(r, sorted_r);
+    }
+}
+
+// File inputs get read while the first pass runs, every mode and odd request sizes yield the same result
+TEST(RadixTestMT, FileInputTesterMTMP) {
+    uint64_t count = 1 << 15;
+    std::string path_l = helpers::default_spill_directory() + "/hashjoins_" + std::to_string(getpid()) + "_left";
+    std::string path_r = helpers::default_spill_directory() + "/hashjoins_" + std::to_string(getpid()) + "_right";
+    uniform_generator gen_l(1, 1 << 13, count);
+    gen_l.build();
+    auto left = gen_l.get_vec_copy();
+    gen_l.write(path_l);
+    uniform_generator gen_r(1, 1 << 13, count);
+    gen_r.build();
+    auto right = gen_r.get_vec_copy();
+    gen_r.write(path_r);
+    for(auto type: {helpers::join_type::inner, helpers::join_type::full_outer}){
+        auto l = left;
+        auto r = right;
+        radix_join_mt reference(l.data(), r.data(), count, count, 1.5, thread_count, part_bits, 2, type);
+        reference.execute();
+        uint64_t expected = get_size_radix(reference.get());
+        for(auto mode: {radix_join_mt::partition_mode::scratch, radix_join_mt::partition_mode::copy,
+                        radix_join_mt::partition_mode::in_place}){
+            radix_join_mt join(path_l, path_r, 1.5, thread_count, part_bits, 2, type);
+            join.set_partition_mode(mode);
+            join.set_io(10000, 3);
+            join.execute();
+            ASSERT_EQ(get_size_radix(join.get()), expected);
+        }
+    }
+    std::remove(path_l.c_str());
+    ASSERT_THROW(radix_join_mt(path_l, path_r, 1.5, thread_count, part_bits, 2, helpers::join_type::inner),
+                 std::runtime_error);
+    std::remove(path_r.c_str());
+}
@@ -0,0 +1,92 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "generators/uniform_generator.h"
+#include "algorithms/radix_partitioner.h"
+#include "algorithms/hash_helpers.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+
+using namespace generators;  // NOLINT
+using namespace algorithms; // NOLINT
+
+/*
+ * Helper function. Checks that the partitioned buffer is a permutation of the input
+ * and that every tuple lies within the partition its hash bits point to.
+ */
+void check_partitions(std::vector<radix_partitioner::tuple> input, radix_partitioner& part, uint8_t shift,
+                      uint8_t bits){
+    auto& bounds = part.get_bounds();
+    ASSERT_EQ(bounds.size(), part.part_count() + 1);
+    ASSERT_EQ(bounds.front(), 0);
+    ASSERT_EQ(bounds.back(), input.size());
+    uint64_t mask = (static_cast<uint64_t>(1) << bits) - 1;
+    for(uint64_t p = 0; p < part.part_count(); ++p){
+        ASSERT_LE(bounds[p], bounds[p + 1]);
+        for(uint64_t k = bounds[p]; k < bounds[p + 1]; ++k){
+            ASSERT_EQ(helpers::radix(helpers::murmur3(std::get<0>(part.get()[k])), shift, mask), p);
+        }
+    }
+    std::vector<radix_partitioner::tuple> output(part.get(), part.get() + input.size());
+    std::sort(input.begin(), input.end());
+    std::sort(output.begin(), output.end());
+    ASSERT_EQ(input, output);
+}
+
+// Ensure proper creation of object and no return before execution
+TEST(RadixPartitionerTest, CreationTester) {
+    uniform_generator uni(0, 10000, 1000);
+    uni.build();
+    auto data = uni.get_vec_copy();
+    radix_partitioner part(data.data(), data.size(), 0, 4, 1);
+    ASSERT_ANY_THROW(part.get());
+    ASSERT_ANY_THROW(part.get_bounds());
+    ASSERT_ANY_THROW(radix_partitioner(data.data(), data.size(), 60, 8, 1));
+}
+
+// Partitioning an empty relation still yields valid boundaries
+TEST(RadixPartitionerTest, EmptyTester) {
+    radix_partitioner part(nullptr, 0, 0, 4, 4);
+    part.execute();
+    ASSERT_EQ(part.get_bounds(), std::vector<uint64_t>(17, 0));
+}
+
+// Single threaded partitioning on the lowest bits
+TEST(RadixPartitionerTest, SingleThreadTester) {
+    uniform_generator uni(0, 100000, 20000);
+    uni.build();
+    auto data = uni.get_vec_copy();
+    radix_partitioner part(data.data(), data.size(), 0, 6, 1);
+    part.execute();
+    check_partitions(data, part, 0, 6);
+}
+
+// Multi threaded partitioning on a higher bit range into a caller provided buffer
+TEST(RadixPartitionerTest, MultiThreadTester) {
+    uniform_generator uni(0, 100000, 20001);
+    uni.build();
+    auto data = uni.get_vec_copy();
+    std::vector<radix_partitioner::tuple> target(data.size());
+    radix_partitioner part(data.data(), data.size(), 7, 5, 4, target.data());
+    part.execute();
+    ASSERT_EQ(part.get(), target.data());
+    check_partitions(data, part, 7, 5);
+}
+
+// Partitioning runs as tasks on an executor, standalone or within the task group of an admitted operator
+TEST(RadixPartitionerTest, ExecutorTester) {
+    uniform_generator uni(0, 100000, 30001);
+    uni.build();
+    auto data = uni.get_vec_copy();
+    helpers::executor exec(2);
+    radix_partitioner standalone(data.data(), data.size(), 3, 6, 4);
+    standalone.set_executor(exec);
+    standalone.execute();
+    check_partitions(data, standalone, 3, 6);
+    helpers::executor::ticket admission(exec, 2);
+    helpers::executor::task_group tasks(exec);
+    radix_partitioner grouped(data.data(), data.size(), 3, 6, 2);
+    grouped.execute(tasks);
+    check_partitions(data, grouped, 3, 6);
+}
@@ -0,0 +1,146 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "generators/uniform_generator.h"
+#include "generators/incremental_generator.h"
+#include "algorithms/relation_file.h"
+#include "algorithms/async_reader.h"
+#include "algorithms/spill_file.h"
+#include "algorithms/nop_join_mt.h"
+#include "algorithms/mt_radix/radix_join_mt.h"
+#include "gtest/gtest.h"
+#include <cstdio>
+#include <fstream>
+#include <unistd.h>
+
+using namespace generators;  // NOLINT
+using namespace algorithms; // NOLINT
+
+/*
+ * Helper function. Returns a file name in the spill directory which is unique to the process.
+ */
+std::string get_path_relation(const std::string& name){
+    return helpers::default_spill_directory() + "/hashjoins_" + std::to_string(getpid()) + "_" + name;
+}
+
+/*
+ * Helper function. Takes the vector of output vectors and calculates the total length
+ * of the output.
+ */
+uint64_t get_size_relation(std::vector<std::vector<nop_join_mt::triple>> &output){
+    uint64_t size = 0;
+    for(auto& vec: output){
+        size += vec.size();
+    }
+    return size;
+}
+
+// Generated relations come back unchanged together with their statistics
+TEST(RelationFileTest, RoundTripTester) {
+    std::string path = get_path_relation("round_trip");
+    uniform_generator gen(10, 1000, 5000);
+    ASSERT_THROW(gen.write(path), std::logic_error);
+    gen.build();
+    gen.write(path);
+    auto data = gen.get_vec_copy();
+    {
+        helpers::mapped_relation rel(path);
+        ASSERT_EQ(rel.size(), data.size());
+        ASSERT_EQ(rel.header().columns, 2);
+        ASSERT_EQ(rel.header().key_width, sizeof(uint64_t));
+        ASSERT_EQ(rel.header().min_key, std::get<0>(*std::min_element(data.begin(), data.end())));
+        ASSERT_EQ(rel.header().max_key, std::get<0>(*std::max_element(data.begin(), data.end())));
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(rel.tuples()) % 4096, 0);
+        ASSERT_TRUE(std::equal(data.begin(), data.end(), rel.tuples()));
+        ASSERT_THROW(rel.triples(), std::logic_error);
+    }
+    std::remove(path.c_str());
+}
+
+// Mapped relations are joined without copies, joins modifying their inputs leave the file untouched
+TEST(RelationFileTest, JoinTester) {
+    std::string path_l = get_path_relation("join_left");
+    std::string path_r = get_path_relation("join_right");
+    std::string path_res = get_path_relation("join_result");
+    uniform_generator gen(1, 1 << 12, 1 << 15);
+    gen.build();
+    gen.write(path_l);
+    incremental_generator inc(1, 1 << 14);
+    inc.build();
+    inc.write(path_r);
+    helpers::mapped_relation left(path_l);
+    helpers::mapped_relation right(path_r);
+    auto copy_l = gen.get_vec_copy();
+    auto copy_r = inc.get_vec_copy();
+    nop_join_mt reference(copy_l.data(), copy_r.data(), copy_l.size(), copy_r.size(), 1.5, 2);
+    reference.execute();
+    radix_join_mt join(left.tuples(), right.tuples(), left.size(), right.size(), 1.5, 4, 2, 2);
+    join.set_partition_mode(radix_join_mt::partition_mode::in_place);
+    join.execute();
+    ASSERT_EQ(get_size_relation(join.get()), get_size_relation(reference.get()));
+    // Join results get concatenated into one result file
+    helpers::write_result(path_res, join.get());
+    {
+        helpers::mapped_relation result(path_res);
+        ASSERT_EQ(result.size(), get_size_relation(reference.get()));
+        ASSERT_EQ(result.header().columns, 3);
+        ASSERT_THROW(result.tuples(), std::logic_error);
+        ASSERT_GE(result.header().min_key, left.header().min_key);
+        ASSERT_LE(result.header().max_key, left.header().max_key);
+        helpers::mapped_relation again(path_l);
+        ASSERT_TRUE(std::equal(copy_l.begin(), copy_l.end(), again.tuples()));
+    }
+    std::remove(path_l.c_str());
+    std::remove(path_r.c_str());
+    std::remove(path_res.c_str());
+}
+
+// Empty relations are valid, foreign and missing files are rejected
+TEST(RelationFileTest, InvalidTester) {
+    std::string path = get_path_relation("invalid");
+    helpers::write_relation(path, {});
+    {
+        helpers::mapped_relation rel(path);
+        ASSERT_EQ(rel.size(), 0);
+        ASSERT_GT(rel.header().min_key, rel.header().max_key);
+    }
+    {
+        std::ofstream out(path, std::ios::trunc);
+        out << "key,rid\n1,2\n";
+    }
+    ASSERT_THROW(helpers::mapped_relation rel(path), std::runtime_error);
+    std::remove(path.c_str());
+    ASSERT_THROW(helpers::mapped_relation rel(path), std::runtime_error);
+    ASSERT_THROW(helpers::relation_writer("/nonexistent/relation", 2), std::runtime_error);
+    helpers::relation_writer writer(path, 3);
+    std::vector<helpers::relation_writer::tuple> tuples(3);
+    ASSERT_THROW(writer.append(tuples.data(), tuples.size()), std::invalid_argument);
+    writer.finish();
+    std::remove(path.c_str());
+}
+
+// Asynchronous reads deliver the whole range no matter how it is split into requests
+TEST(RelationFileTest, AsyncReaderTester) {
+    std::string path = get_path_relation("async");
+    incremental_generator inc(1, 100000);
+    inc.build();
+    inc.write(path);
+    auto data = inc.get_vec_copy();
+    helpers::relation_header head = helpers::read_relation_header(path);
+    uint64_t bytes = data.size() * sizeof(helpers::relation_writer::tuple);
+    for(uint64_t chunk: {static_cast<uint64_t>(1) << 16, static_cast<uint64_t>(4099), bytes + 1}){
+        std::vector<helpers::relation_writer::tuple> target(data.size());
+        helpers::async_reader reader(path, head.offset, bytes, target.data(), chunk, 4);
+        reader.wait(bytes / 2, bytes / 2 + 100);
+        ASSERT_EQ(target[(bytes / 2) / sizeof(helpers::relation_writer::tuple)],
+                  data[(bytes / 2) / sizeof(helpers::relation_writer::tuple)]);
+        reader.wait_all();
+        ASSERT_EQ(target, data);
+    }
+    // Reading past the end of the file fails on wait
+    std::vector<char> target(bytes + 100);
+    helpers::async_reader reader(path, head.offset, bytes + 100, target.data(), 4096, 2);
+    ASSERT_THROW(reader.wait_all(), std::runtime_error);
+    std::remove(path.c_str());
+}
@@ -0,0 +1,104 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "algorithms/string_join_mt.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <map>
+#include <random>
+
+// Number of threads the program should be run on
+#define thread_count 4
+
+using namespace algorithms; // NOLINT
+
+/*
+ * Helper function. Flattens the per thread output vectors into a single sorted vector.
+ */
+std::vector<string_join_mt::pair> flatten_strings(std::vector<std::vector<string_join_mt::pair>>& output){
+    std::vector<string_join_mt::pair> res;
+    for(auto& vec: output){
+        res.insert(res.end(), vec.begin(), vec.end());
+    }
+    std::sort(res.begin(), res.end());
+    return res;
+}
+
+/*
+ * Helper function. Creates SKU like strings sharing a long common prefix, so that
+ * the inline prefix alone never decides equality.
+ */
+helpers::string_arena sku_arena(uint64_t count, uint64_t max, uint64_t seed){
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<uint64_t> dis(0, max);
+    helpers::string_arena arena;
+    for(uint64_t k = 0; k < count; ++k){
+        arena.add("SKU-WAREHOUSE-" + std::to_string(dis(gen)));
+    }
+    return arena;
+}
+
+/*
+ * Helper function. Computes the expected matches through an ordered map on the strings.
+ */
+std::vector<string_join_mt::pair> string_reference(helpers::string_arena& left, helpers::string_arena& right){
+    std::multimap<std::string, uint64_t> table;
+    for(uint64_t k = 0; k < left.size(); ++k){
+        table.emplace(left.get(k), k);
+    }
+    std::vector<string_join_mt::pair> res;
+    for(uint64_t k = 0; k < right.size(); ++k){
+        auto range = table.equal_range(right.get(k));
+        for(auto it = range.first; it != range.second; ++it){
+            res.emplace_back(it->second, k);
+        }
+    }
+    std::sort(res.begin(), res.end());
+    return res;
+}
+
+// Arena has to return the stored strings and compare them correctly
+TEST(StringJoinTestMT, ArenaTester) {
+    helpers::string_arena a, b;
+    a.add("");
+    a.add("short");
+    a.add("a string longer than the prefix");
+    b.add("a string longer than the prefix!");
+    b.add("a string longer than the prefix");
+    b.add("short");
+    ASSERT_EQ(a.size(), 3);
+    ASSERT_EQ(a.get(2), "a string longer than the prefix");
+    ASSERT_FALSE(a.equal(2, b, 0));
+    ASSERT_TRUE(a.equal(2, b, 1));
+    ASSERT_TRUE(a.equal(1, b, 2));
+    ASSERT_FALSE(a.equal(0, b, 2));
+    ASSERT_EQ(a.hash(2), b.hash(1));
+    ASSERT_NE(a.hash(2), b.hash(0));
+}
+
+// Ensure proper creation of object and no return before execution
+TEST(StringJoinTestMT, CreationTester) {
+    auto left = sku_arena(100, 100, 1);
+    auto right = sku_arena(100, 100, 2);
+    string_join_mt join(left, right);
+    ASSERT_ANY_THROW(join.get());
+}
+
+// String keys joined through the no partitioning join
+TEST(StringJoinTestMT, ReferenceTesterNOP) {
+    auto left = sku_arena(5000, 3000, 3);
+    auto right = sku_arena(5000, 6000, 4);
+    string_join_mt join(left, right, 1.5, thread_count, 0, 0);
+    join.execute();
+    ASSERT_EQ(flatten_strings(join.get()), string_reference(left, right));
+}
+
+// String keys joined through the multi pass radix join
+TEST(StringJoinTestMT, ReferenceTesterRadix) {
+    auto left = sku_arena(20000, 10000, 5);
+    auto right = sku_arena(20000, 20000, 6);
+    string_join_mt join(left, right, 1.5, thread_count, 4, 2);
+    join.execute();
+    ASSERT_EQ(flatten_strings(join.get()), string_reference(left, right));
+}
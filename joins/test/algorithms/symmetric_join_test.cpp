@@ -0,0 +1,107 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "generators/uniform_generator.h"
+#include "generators/incremental_generator.h"
+#include "algorithms/symmetric_join.h"
+#include "algorithms/nop_join_mt.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+
+using namespace generators;  // NOLINT
+using namespace algorithms; // NOLINT
+
+/*
+ * Helper function. Flattens the vector of output vectors into one sorted vector.
+ */
+std::vector<symmetric_join::triple> get_sorted_symmetric(std::vector<std::vector<symmetric_join::triple>> &output){
+    std::vector<symmetric_join::triple> flat;
+    for(auto& vec: output){
+        flat.insert(flat.end(), vec.begin(), vec.end());
+    }
+    std::sort(flat.begin(), flat.end());
+    return flat;
+}
+
+/*
+ * Helper function. Pushes both relations in alternating batches of the given size.
+ */
+std::vector<symmetric_join::triple> stream_symmetric(symmetric_join& join, std::vector<symmetric_join::tuple>& left,
+                                                     std::vector<symmetric_join::tuple>& right, uint64_t batch){
+    std::vector<symmetric_join::triple> out;
+    for(uint64_t start = 0; start < std::max(left.size(), right.size()); start += batch){
+        if(start < left.size()){
+            join.push_left(left.data() + start, std::min<uint64_t>(batch, left.size() - start), out);
+        }
+        if(start < right.size()){
+            join.push_right(right.data() + start, std::min<uint64_t>(batch, right.size() - start), out);
+        }
+    }
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+// Without a window every pair gets emitted exactly once, no matter how the batches interleave
+TEST(SymmetricTest, UnboundedTester) {
+    uint64_t count = 1 << 16;
+    uniform_generator gen_l(1, 1 << 12, count);
+    gen_l.build();
+    auto left = gen_l.get_vec_copy();
+    uniform_generator gen_r(1, 1 << 12, count / 2);
+    gen_r.build();
+    auto right = gen_r.get_vec_copy();
+    nop_join_mt reference(left.data(), right.data(), left.size(), right.size(), 1.5, 2);
+    reference.execute();
+    auto expected = get_sorted_symmetric(reference.get());
+    for(uint64_t batch: {static_cast<uint64_t>(1), static_cast<uint64_t>(777), static_cast<uint64_t>(1) << 15}){
+        symmetric_join join;
+        ASSERT_EQ(stream_symmetric(join, left, right, batch), expected);
+        ASSERT_EQ(join.resident_left(), left.size());
+        ASSERT_EQ(join.resident_right(), right.size());
+    }
+}
+
+// Large batches get processed in parallel with the same result
+TEST(SymmetricTest, ParallelTester) {
+    uint64_t count = 1 << 15;
+    uniform_generator gen_l(1, 1 << 14, count);
+    gen_l.build();
+    auto left = gen_l.get_vec_copy();
+    uniform_generator gen_r(1, 1 << 14, count);
+    gen_r.build();
+    auto right = gen_r.get_vec_copy();
+    symmetric_join single;
+    helpers::executor exec(4);
+    symmetric_join parallel(0, 0, 1.5, 4);
+    parallel.set_executor(exec);
+    ASSERT_EQ(stream_symmetric(parallel, left, right, 1 << 14), stream_symmetric(single, left, right, 1 << 14));
+}
+
+// Windows evict whole panes, a tuple still meets at least the last 'window' tuples of the other side
+TEST(SymmetricTest, WindowTester) {
+    uint64_t count = 10000;
+    uint64_t window = 1000;
+    incremental_generator gen(1, count);
+    gen.build();
+    auto left = gen.get_vec_copy();
+    auto right = gen.get_vec_copy();
+    // Both sides in lockstep, every key meets its partner
+    symmetric_join lockstep(window, 4, 1.5, 1);
+    ASSERT_EQ(stream_symmetric(lockstep, left, right, 100).size(), count);
+    ASSERT_LE(lockstep.resident_left(), window + window / 4);
+    ASSERT_GE(lockstep.resident_left(), window);
+    // The right side arrives after the whole left side, only the last left tuples are still there
+    symmetric_join lagging(window, 4, 1.5, 1);
+    std::vector<symmetric_join::triple> out;
+    lagging.push_left(left.data(), left.size(), out);
+    uint64_t bytes = lagging.table_bytes();
+    lagging.push_right(right.data(), right.size(), out);
+    ASSERT_GE(out.size(), window);
+    ASSERT_LE(out.size(), window + window / 4);
+    for(auto& curr: out){
+        ASSERT_GE(std::get<0>(curr), count - window - window / 4);
+        ASSERT_EQ(std::get<1>(curr), std::get<2>(curr));
+    }
+    ASSERT_EQ(lagging.table_bytes(), 2 * bytes);
+}
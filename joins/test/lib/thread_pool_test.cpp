@@ -0,0 +1,89 @@
+//
+// Benjamin Wagner 2018
+//
+
+#include "ThreadPool.h"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <memory>
+
+/*
+ * Helper function. Recursively posts a binary tree of tasks with the given depth,
+ * every leaf increments the counter.
+ */
+void post_tree_pool(ThreadPool* pool, std::atomic<uint64_t>* counter, uint32_t depth){
+    if(depth == 0){
+        ++(*counter);
+        return;
+    }
+    pool->post(post_tree_pool, pool, counter, depth - 1);
+    pool->post(post_tree_pool, pool, counter, depth - 1);
+}
+
+// Fire-and-forget tasks spawned from within workers all have to run before finish returns
+TEST(ThreadPoolTest, PostTreeTester) {
+    std::atomic<uint64_t> counter(0);
+    ThreadPool pool(4);
+    pool.post(post_tree_pool, &pool, &counter, 12);
+    // Wait for the leaves, finish alone would race with the spawning of subtasks
+    while(counter < (static_cast<uint64_t>(1) << 12)){
+        std::this_thread::yield();
+    }
+    pool.finish();
+    ASSERT_EQ(counter, static_cast<uint64_t>(1) << 12);
+}
+
+// Futures and posted tasks can be mixed on the same pool
+TEST(ThreadPoolTest, EnqueueTester) {
+    ThreadPool pool(2);
+    std::atomic<uint64_t> counter(0);
+    for(uint32_t k = 0; k < 100; ++k){
+        pool.post([&counter]{ ++counter; });
+    }
+    auto res = pool.enqueue([](uint64_t a, uint64_t b){ return a + b; }, 20, 22);
+    ASSERT_EQ(res.get(), 42);
+    pool.finish();
+    ASSERT_EQ(counter, 100);
+}
+
+// Captured state has to be moved and destroyed exactly once
+TEST(ThreadPoolTest, TaskLifetimeTester) {
+    auto state = std::make_shared<uint64_t>(0);
+    {
+        PoolTask first([state]{ ++(*state); });
+        ASSERT_EQ(state.use_count(), 2);
+        PoolTask second(std::move(first));
+        second();
+        PoolTask third;
+        third = std::move(second);
+        third();
+        ASSERT_EQ(state.use_count(), 2);
+    }
+    ASSERT_EQ(*state, 2);
+    ASSERT_EQ(state.use_count(), 1);
+}
+
+// Accessors report the pool size and only workers know their index
+TEST(ThreadPoolTest, WorkerIndexTester) {
+    ThreadPool pool(3);
+    ASSERT_EQ(pool.size(), 3);
+    ASSERT_EQ(pool.current_worker(), -1);
+    auto index = pool.enqueue([&pool]{ return pool.current_worker(); });
+    long worker = index.get();
+    ASSERT_GE(worker, 0);
+    ASSERT_LT(worker, 3);
+    pool.finish();
+}
+
+// The start hook runs once per worker before any task, posted tasks land on the chosen worker's deque
+TEST(ThreadPoolTest, StartHookTester) {
+    std::atomic<uint64_t> started(0);
+    ThreadPool pool(4, [&started](size_t){ ++started; });
+    std::atomic<uint64_t> counter(0);
+    for(size_t k = 0; k < 64; ++k){
+        pool.post_to(k, [&counter]{ ++counter; });
+    }
+    pool.finish();
+    ASSERT_EQ(started, 4);
+    ASSERT_EQ(counter, 64);
+}